@@ -0,0 +1,212 @@
+#include "attitude.h"
+#include "fastmath.h"
+#include <math.h>
+#include <string.h>
+
+#define GYRO_SCALE 131.0f     // ±250°/s范围（与mpu6050.c一致）
+#define RAD_TO_DEG 57.29578f  // 弧度转角度
+#define DEG_TO_RAD 0.01745329f
+
+// 滤波器名称（与Attitude_FilterTypeDef顺序一致，也是"set filter"命令的参数）
+static const char *const attitude_names[ATTITUDE_COUNT] = {
+    "kalman", "comp", "mahony"
+};
+
+#if USE_FAST_MATH
+#define ATTITUDE_ATAN2(y, x)  FastMath_Atan2((y), (x))
+#define ATTITUDE_INVSQRT(x)   FastMath_InvSqrt(x)
+#else
+#define ATTITUDE_ATAN2(y, x)  atan2((y), (x))
+#define ATTITUDE_INVSQRT(x)   (1.0f / sqrt(x))
+#endif
+
+// 互补滤波：陀螺仪积分，加速度计倾角与估计值之差按时间常数修正，差值的积分估计零偏
+// 等效于二阶锁相环：ωn = √COMP_KI，阻尼 1/(2·COMP_TIME_CONSTANT·ωn)
+static void Attitude_Complementary(Attitude_HandleTypeDef *hatt, const MPU6050_HandleTypeDef *hmpu, float dt) {
+    Attitude_ComplementaryTypeDef *comp = &hatt->complementary;
+    float error = hmpu->angleX - comp->angle;
+    
+    comp->bias -= (float)COMP_KI * error * dt;
+    hatt->rate = hmpu->gyroX - comp->bias;
+    comp->angle += (hatt->rate + error * (float)(1.0 / COMP_TIME_CONSTANT)) * dt;
+    hatt->angle = comp->angle;
+}
+
+// Mahony滤波：加速度计测得的重力方向与四元数预测方向的叉积作为误差，PI反馈修正三轴角速度后积分四元数
+static void Attitude_Mahony(Attitude_HandleTypeDef *hatt, const MPU6050_HandleTypeDef *hmpu, float dt) {
+    Attitude_MahonyTypeDef *m = &hatt->mahony;
+    float *q = m->q;
+    float gx = hmpu->gyroX * DEG_TO_RAD;
+    float gy = hmpu->gyroY * DEG_TO_RAD;
+    float gz = (hmpu->gyroZ_raw / GYRO_SCALE - hmpu->gyroZoffset) * DEG_TO_RAD;
+    float ax = hmpu->accel[0];
+    float ay = hmpu->accel[1];
+    float az = hmpu->accel[2];
+    float norm_sq = ax * ax + ay * ay + az * az;
+    
+    // 加速度计数据有效时才修正（自由落体时为0）
+    if (norm_sq > 0.0f) {
+        float recip = ATTITUDE_INVSQRT(norm_sq);
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+        
+        // 预测的重力方向（四元数旋转矩阵第三行的一半）
+        float halfvx = q[1] * q[3] - q[0] * q[2];
+        float halfvy = q[0] * q[1] + q[2] * q[3];
+        float halfvz = q[0] * q[0] - 0.5f + q[3] * q[3];
+        
+        // 误差：测量方向 × 预测方向
+        float halfex = ay * halfvz - az * halfvy;
+        float halfey = az * halfvx - ax * halfvz;
+        float halfez = ax * halfvy - ay * halfvx;
+        
+        m->integral[0] += 2.0f * (float)MAHONY_KI * halfex * dt;
+        m->integral[1] += 2.0f * (float)MAHONY_KI * halfey * dt;
+        m->integral[2] += 2.0f * (float)MAHONY_KI * halfez * dt;
+        gx += m->integral[0] + 2.0f * (float)MAHONY_KP * halfex;
+        gy += m->integral[1] + 2.0f * (float)MAHONY_KP * halfey;
+        gz += m->integral[2] + 2.0f * (float)MAHONY_KP * halfez;
+    }
+    
+    // 四元数积分：q̇ = q ⊗ (0, ω) / 2
+    gx *= 0.5f * dt;
+    gy *= 0.5f * dt;
+    gz *= 0.5f * dt;
+    float qa = q[0];
+    float qb = q[1];
+    float qc = q[2];
+    q[0] += -qb * gx - qc * gy - q[3] * gz;
+    q[1] += qa * gx + qc * gz - q[3] * gy;
+    q[2] += qa * gy - qb * gz + q[3] * gx;
+    q[3] += qa * gz + qb * gy - qc * gx;
+    
+    float recip = ATTITUDE_INVSQRT(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (uint8_t i = 0; i < 4; i++) {
+        q[i] *= recip;
+    }
+    
+    // 绕X轴的倾角，与 atan2(ay, az) 定义一致
+    hatt->angle = ATTITUDE_ATAN2(q[0] * q[1] + q[2] * q[3], 0.5f - q[1] * q[1] - q[2] * q[2]) * RAD_TO_DEG;
+    hatt->rate = hmpu->gyroX + m->integral[0] * RAD_TO_DEG;
+}
+
+// 按倾角设置四元数（只绕X轴），积分项保留
+static void Attitude_MahonySetAngle(Attitude_MahonyTypeDef *m, float angle) {
+    float half = 0.5f * angle * DEG_TO_RAD;
+    m->q[0] = cosf(half);
+    m->q[1] = sinf(half);
+    m->q[2] = 0.0f;
+    m->q[3] = 0.0f;
+}
+
+// 姿态估计器初始化：三个滤波器都复位，倾角从0开始
+void Attitude_Init(Attitude_HandleTypeDef *hatt, Attitude_FilterTypeDef filter) {
+    Kalman_Init(&hatt->kalman);
+    memset(&hatt->complementary, 0, sizeof(hatt->complementary));
+    memset(&hatt->mahony, 0, sizeof(hatt->mahony));
+    Attitude_MahonySetAngle(&hatt->mahony, 0.0f);
+    
+    hatt->filter = (filter < ATTITUDE_COUNT) ? filter : ATTITUDE_KALMAN;
+    hatt->angle = 0.0f;
+    hatt->rate = 0.0f;
+}
+
+// 切换滤波器，新滤波器从当前倾角开始（控制中断中会调用Attitude_Update，需由调用者互斥）
+void Attitude_SetFilter(Attitude_HandleTypeDef *hatt, Attitude_FilterTypeDef filter) {
+    if (filter >= ATTITUDE_COUNT || filter == hatt->filter) {
+        return;
+    }
+    hatt->filter = filter;
+    Attitude_SetAngle(hatt, hatt->angle);
+}
+
+// 设置当前滤波器的倾角
+void Attitude_SetAngle(Attitude_HandleTypeDef *hatt, float angle) {
+    switch (hatt->filter) {
+        case ATTITUDE_COMPLEMENTARY:
+            hatt->complementary.angle = angle;
+            break;
+        case ATTITUDE_MAHONY:
+            Attitude_MahonySetAngle(&hatt->mahony, angle);
+            break;
+        default:
+            Kalman_SetAngle(&hatt->kalman, angle);
+            break;
+    }
+    hatt->angle = angle;
+}
+
+// 姿态更新（控制中断中调用，dt为本周期时间，单位秒），返回倾角（度）
+float Attitude_Update(Attitude_HandleTypeDef *hatt, const MPU6050_HandleTypeDef *hmpu, float dt) {
+    if (dt <= 0) {
+        return hatt->angle;
+    }
+    
+    switch (hatt->filter) {
+        case ATTITUDE_COMPLEMENTARY:
+            Attitude_Complementary(hatt, hmpu, dt);
+            break;
+        case ATTITUDE_MAHONY:
+            Attitude_Mahony(hatt, hmpu, dt);
+            break;
+        default:
+            hatt->angle = Kalman_UpdateDt(&hatt->kalman, hmpu->angleX, hmpu->gyroX, dt);
+            hatt->rate = Kalman_GetRate(&hatt->kalman);
+            break;
+    }
+    return hatt->angle;
+}
+
+// 获取倾角
+float Attitude_GetAngle(Attitude_HandleTypeDef *hatt) {
+    return hatt->angle;
+}
+
+// 获取去零偏后的X轴角速度
+float Attitude_GetRate(Attitude_HandleTypeDef *hatt) {
+    return hatt->rate;
+}
+
+// 获取当前滤波器的X轴陀螺仪零偏估计（度/秒）
+float Attitude_GetBias(Attitude_HandleTypeDef *hatt) {
+    switch (hatt->filter) {
+        case ATTITUDE_COMPLEMENTARY:
+            return hatt->complementary.bias;
+        case ATTITUDE_MAHONY:
+            return -hatt->mahony.integral[0] * RAD_TO_DEG;
+        default:
+            return Kalman_GetBias(&hatt->kalman);
+    }
+}
+
+// 设置当前滤波器的X轴陀螺仪零偏估计（回放记录时作为初值）
+void Attitude_SetBias(Attitude_HandleTypeDef *hatt, float bias) {
+    switch (hatt->filter) {
+        case ATTITUDE_COMPLEMENTARY:
+            hatt->complementary.bias = bias;
+            break;
+        case ATTITUDE_MAHONY:
+            hatt->mahony.integral[0] = -bias * DEG_TO_RAD;
+            break;
+        default:
+            Kalman_SetBias(&hatt->kalman, bias);
+            break;
+    }
+}
+
+// 滤波器名称
+const char *Attitude_GetName(Attitude_FilterTypeDef filter) {
+    return (filter < ATTITUDE_COUNT) ? attitude_names[filter] : "?";
+}
+
+// 按名称查找滤波器，找到返回1
+uint8_t Attitude_ParseName(const char *name, Attitude_FilterTypeDef *filter) {
+    for (uint8_t i = 0; i < ATTITUDE_COUNT; i++) {
+        if (strcmp(name, attitude_names[i]) == 0) {
+            *filter = (Attitude_FilterTypeDef)i;
+            return 1;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
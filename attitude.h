@@ -0,0 +1,63 @@
+#ifndef ATTITUDE_H
+#define ATTITUDE_H
+
+#include "stm32f1xx_hal.h"
+#include "mpu6050.h"
+#include "kalman.h"
+#include "parameters.h"
+
+// 姿态估计器：统一接口下的三种滤波器，控制循环只调用Attitude_Update/Attitude_GetAngle
+//
+//   ATTITUDE_KALMAN        卡尔曼滤波（kalman.c），倾角+陀螺仪零偏两个状态，每次更新含2x2协方差递推
+//   ATTITUDE_COMPLEMENTARY 互补滤波，陀螺仪积分 + 加速度计倾角按时间常数修正，积分项估计零偏，无除法
+//   ATTITUDE_MAHONY        Mahony四元数滤波，使用三轴陀螺仪和三轴加速度计，积分项估计三轴零偏
+//
+// 三者输出的倾角与MPU6050_ProcessRaw的angleX定义相同（atan2(ay, az)），角速度为去零偏后的X轴角速度。
+// 上电默认由ATTITUDE_FILTER决定，运行中可用Attitude_SetFilter切换（新滤波器从当前倾角开始）。
+
+// 滤波器类型
+typedef enum {
+    ATTITUDE_KALMAN = 0,
+    ATTITUDE_COMPLEMENTARY,
+    ATTITUDE_MAHONY,
+    ATTITUDE_COUNT
+} Attitude_FilterTypeDef;
+
+// 互补滤波状态
+typedef struct {
+    float angle;                // 倾角（度）
+    float bias;                 // 陀螺仪零偏估计（度/秒）
+} Attitude_ComplementaryTypeDef;
+
+// Mahony滤波状态
+typedef struct {
+    float q[4];                 // 姿态四元数 q0（实部）, q1, q2, q3
+    float integral[3];          // 积分反馈（rad/s），即三轴零偏估计的相反数
+} Attitude_MahonyTypeDef;
+
+// 姿态估计器结构体
+typedef struct {
+    Attitude_FilterTypeDef filter;  // 当前使用的滤波器
+    
+    Kalman_HandleTypeDef kalman;
+    Attitude_ComplementaryTypeDef complementary;
+    Attitude_MahonyTypeDef mahony;
+    
+    float angle;                // 最近一次输出的倾角（度）
+    float rate;                 // 最近一次输出的角速度（度/秒）
+    
+} Attitude_HandleTypeDef;
+
+// 函数声明
+void Attitude_Init(Attitude_HandleTypeDef *hatt, Attitude_FilterTypeDef filter);
+void Attitude_SetFilter(Attitude_HandleTypeDef *hatt, Attitude_FilterTypeDef filter);
+void Attitude_SetAngle(Attitude_HandleTypeDef *hatt, float angle);
+float Attitude_Update(Attitude_HandleTypeDef *hatt, const MPU6050_HandleTypeDef *hmpu, float dt);
+float Attitude_GetAngle(Attitude_HandleTypeDef *hatt);
+float Attitude_GetRate(Attitude_HandleTypeDef *hatt);
+float Attitude_GetBias(Attitude_HandleTypeDef *hatt);
+void Attitude_SetBias(Attitude_HandleTypeDef *hatt, float bias);
+const char *Attitude_GetName(Attitude_FilterTypeDef filter);
+uint8_t Attitude_ParseName(const char *name, Attitude_FilterTypeDef *filter);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "battery.h"
+
+#define BATTERY_ADC_FULL_SCALE 4095.0f
+#define BATTERY_ADC_VREF 3.3f
+
+// ADC原始值之和 → 电池电压
+#define BATTERY_SUM_TO_VOLTS (BATTERY_ADC_VREF * (float)BATTERY_DIVIDER / (BATTERY_ADC_FULL_SCALE * BATTERY_ADC_SAMPLES))
+
+// DMA循环写入的转换结果
+static volatile uint16_t battery_samples[BATTERY_ADC_SAMPLES];
+
+// 以下只在控制中断中写入
+static float battery_voltage = 0.0f;            // 滤波后的电池电压（V），0为尚未采样
+static float battery_compensation = 1.0f;       // 电机输出补偿系数
+static float battery_low_time = 0.0f;           // 连续低于MIN_VOLTAGE的时间（秒）
+static volatile uint8_t battery_low = 0;
+
+// 启动ADC连续转换和循环DMA（MX_ADC1_Init之后调用）
+void Battery_Init(ADC_HandleTypeDef *hadc) {
+    battery_voltage = 0.0f;
+    battery_compensation = 1.0f;
+    battery_low_time = 0.0f;
+    battery_low = 0;
+    
+    HAL_ADCEx_Calibration_Start(hadc);
+    HAL_ADC_Start_DMA(hadc, (uint32_t *)battery_samples, BATTERY_ADC_SAMPLES);
+}
+
+// 更新电压、补偿系数和欠压状态（控制中断中调用，dt为本周期时间，单位秒）
+// 缓冲区各元素由DMA按半字整体写入，求和期间被覆盖只是混入更新的采样
+void Battery_Update(float dt) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < BATTERY_ADC_SAMPLES; i++) {
+        sum += battery_samples[i];
+    }
+    float voltage = sum * BATTERY_SUM_TO_VOLTS;
+    
+    // 第一次从当前值开始，不必等待滤波器收敛
+    if (battery_voltage <= 0.0f) {
+        battery_voltage = voltage;
+    } else {
+        battery_voltage += dt / ((float)BATTERY_FILTER_TIME + dt) * (voltage - battery_voltage);
+    }
+    
+#if BATTERY_COMPENSATION
+    float compensation = (float)BATTERY_COMP_MAX;
+    if (battery_voltage * (float)BATTERY_COMP_MAX > (float)BATTERY_NOMINAL_VOLTAGE) {
+        compensation = (float)BATTERY_NOMINAL_VOLTAGE / battery_voltage;
+    }
+    if (compensation < (float)BATTERY_COMP_MIN) {
+        compensation = (float)BATTERY_COMP_MIN;
+    }
+    battery_compensation = compensation;
+#endif
+    
+    // 欠压判定带时间滤波和回差：加速时的短暂压降不停机，停机后电压回升也不重新开始
+    if (battery_low) {
+        if (battery_voltage >= (float)BATTERY_RESUME_VOLTAGE) {
+            battery_low = 0;
+            battery_low_time = 0.0f;
+        }
+    } else if (battery_voltage < (float)MIN_VOLTAGE) {
+        battery_low_time += dt;
+        if (battery_low_time >= BATTERY_CUTOFF_MS * 0.001f) {
+            battery_low = 1;
+        }
+    } else {
+        battery_low_time = 0.0f;
+    }
+}
+
+// 滤波后的电池电压（V）
+float Battery_GetVoltage(void) {
+    return battery_voltage;
+}
+
+// 电机输出补偿系数（标称电压 / 电池电压，BATTERY_COMPENSATION为0时恒为1）
+float Battery_GetCompensation(void) {
+    return battery_compensation;
+}
+
+// 欠压停机中
+uint8_t Battery_IsLow(void) {
+    return battery_low;
+}
\ No newline at end of file
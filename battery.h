@@ -0,0 +1,24 @@
+#ifndef BATTERY_H
+#define BATTERY_H
+
+#include "stm32f1xx_hal.h"
+#include "parameters.h"
+
+// 电池电压监测
+//
+// ADC1连续转换BATTERY_ADC_CHANNEL，DMA循环写入BATTERY_ADC_SAMPLES个采样的缓冲区，不开DMA中断，转换不占用CPU。
+// 控制中断每个周期调用Battery_Update：对缓冲区求平均（不启动、不等待转换），按分压比换算为电池电压，
+// 再做时间常数BATTERY_FILTER_TIME的一阶低通滤波。
+//
+//   补偿：电机输出乘以 BATTERY_NOMINAL_VOLTAGE / 电压（限制在BATTERY_COMP_MIN~BATTERY_COMP_MAX），
+//         PWM计数对应的电机电压不随电量变化，按标称电压整定的PID增益在满电和低电量时效果相同
+//   欠压：电压低于MIN_VOLTAGE持续BATTERY_CUTOFF_MS后置位，调用者停止电机；电压回到BATTERY_RESUME_VOLTAGE以上才清除
+
+// 函数声明
+void Battery_Init(ADC_HandleTypeDef *hadc);
+void Battery_Update(float dt);
+float Battery_GetVoltage(void);
+float Battery_GetCompensation(void);
+uint8_t Battery_IsLow(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "blackbox.h"
+#include "communication.h"
+#include "strconv.h"
+#include <math.h>
+#include <string.h>
+
+// 记录区（关闭时只保留一条的空间，count始终为0）
+static Telemetry_RecordTypeDef blackbox_records[BLACKBOX_ENABLE ? BLACKBOX_RECORDS : 1];
+static uint16_t blackbox_head = 0;              // 下一条写入位置
+static volatile uint16_t blackbox_count = 0;    // 有效记录数
+static volatile uint8_t blackbox_frozen = 0;    // 冻结后控制中断不再写入
+static uint32_t blackbox_last_us = 0;           // 最新一条记录的时刻
+static const MPU6050_HandleTypeDef *blackbox_mpu = NULL;    // 导出头帧中的陀螺仪零偏校准值
+static Attitude_FilterTypeDef blackbox_filter = ATTITUDE_KALMAN;    // 最新一条记录使用的姿态滤波器
+
+// 导出状态（只在主循环中访问）
+static uint8_t blackbox_notified = 0;           // 已提示冻结
+static uint8_t blackbox_dumping = 0;
+static uint8_t blackbox_dump_header = 0;        // 头帧待发送
+static uint16_t blackbox_dump_index = 0;        // 下一条导出的记录序号（0为最早）
+static uint16_t blackbox_dump_count = 0;
+static uint32_t blackbox_dump_us = 0;           // 下一条记录的时刻
+
+#if BLACKBOX_ENABLE
+static int32_t blackbox_encoder_left = 0;       // 上一周期编码器位置（求增量）
+static int32_t blackbox_encoder_right = 0;
+
+// 记录一个控制周期（控制中断中调用），角度超限时冻结
+void Blackbox_Record(MPU6050_HandleTypeDef *hmpu, Attitude_HandleTypeDef *hatt, Control_HandleTypeDef *hctrl,
+                     float dt, uint32_t timestamp_us) {
+    if (blackbox_frozen) {
+        return;
+    }
+    
+    Telemetry_RecordTypeDef *record = &blackbox_records[blackbox_head];
+    blackbox_mpu = hmpu;
+    blackbox_filter = hatt->filter;
+    float angle = Attitude_GetAngle(hatt);
+    float p00 = 0.0f, p11 = 0.0f, p_term, i_term, d_term;
+    float dt_us = dt * 1e6f;
+    
+    record->dt_us = (dt_us >= 65535.0f) ? 65535 : (uint16_t)dt_us;
+    record->accel[0] = hmpu->accelX;
+    record->accel[1] = hmpu->accelY;
+    record->accel[2] = hmpu->accelZ;
+    record->gyro[0] = hmpu->gyroX_raw;
+    record->gyro[1] = hmpu->gyroY_raw;
+    record->gyro[2] = hmpu->gyroZ_raw;
+    
+    // 协方差只有卡尔曼滤波有，其他滤波器记为0
+    if (hatt->filter == ATTITUDE_KALMAN) {
+        Kalman_GetCovariance(&hatt->kalman, &p00, &p11);
+    }
+    record->angle = Telemetry_Scale(angle, TELEMETRY_ANGLE_SCALE);
+    record->bias = Telemetry_Scale(Attitude_GetBias(hatt), TELEMETRY_BIAS_SCALE);
+    record->p00 = Telemetry_Scale(p00, TELEMETRY_COV_SCALE);
+    record->p11 = Telemetry_Scale(p11, TELEMETRY_COV_SCALE);
+    
+    PID_GetTerms(&hctrl->angle, &p_term, &i_term, &d_term);
+    record->p_term = Telemetry_Scale(p_term, TELEMETRY_PID_SCALE);
+    record->i_term = Telemetry_Scale(i_term, TELEMETRY_PID_SCALE);
+    record->d_term = Telemetry_Scale(d_term, TELEMETRY_PID_SCALE);
+    record->duty_left = hctrl->hmotor->speed_left;
+    record->duty_right = hctrl->hmotor->speed_right;
+    
+    // 清空后的第一条增量为0
+    int32_t left = Motor_GetEncoderLeft(hctrl->hmotor);
+    int32_t right = Motor_GetEncoderRight(hctrl->hmotor);
+    if (blackbox_count == 0) {
+        blackbox_encoder_left = left;
+        blackbox_encoder_right = right;
+    }
+    record->encoder_left = (int16_t)(left - blackbox_encoder_left);
+    record->encoder_right = (int16_t)(right - blackbox_encoder_right);
+    blackbox_encoder_left = left;
+    blackbox_encoder_right = right;
+    
+    blackbox_last_us = timestamp_us;
+    if (++blackbox_head >= BLACKBOX_RECORDS) {
+        blackbox_head = 0;
+    }
+    if (blackbox_count < BLACKBOX_RECORDS) {
+        blackbox_count++;
+    }
+    
+    // 倒地（与控制器相同，按相对目标角的倾斜判断）：保留包含这一条在内的记录
+    if (fabsf(angle - hctrl->target_angle) > (float)MAX_ANGLE) {
+        blackbox_frozen = 1;
+    }
+}
+#endif
+
+// 清空记录并重新开始（与控制中断互斥）
+void Blackbox_Reset(void) {
+    __disable_irq();
+    blackbox_head = 0;
+    blackbox_count = 0;
+    blackbox_frozen = 0;
+    __enable_irq();
+    
+    blackbox_notified = 0;
+    blackbox_dumping = 0;
+}
+
+uint8_t Blackbox_IsFrozen(void) {
+    return blackbox_frozen;
+}
+
+// 第index条（0为最早）在记录区中的位置
+static uint16_t Blackbox_Slot(uint16_t index) {
+    uint16_t first = (blackbox_count < BLACKBOX_RECORDS) ? 0 : blackbox_head;
+    uint16_t slot = first + index;
+    return (slot >= BLACKBOX_RECORDS) ? slot - BLACKBOX_RECORDS : slot;
+}
+
+// 冻结记录并开始导出（主循环中调用），返回将要导出的记录数
+uint16_t Blackbox_StartDump(void) {
+    __disable_irq();
+    blackbox_frozen = 1;
+    __enable_irq();
+    blackbox_notified = 1;
+    
+    // 由最新一条的时刻倒推最早一条的时刻
+    uint32_t span_us = 0;
+    for (uint16_t i = 1; i < blackbox_count; i++) {
+        span_us += blackbox_records[Blackbox_Slot(i)].dt_us;
+    }
+    blackbox_dump_us = blackbox_last_us - span_us;
+    blackbox_dump_index = 0;
+    blackbox_dump_count = blackbox_count;
+    blackbox_dump_header = 1;
+    blackbox_dumping = 1;
+    return blackbox_dump_count;
+}
+
+// 主循环中调用：冻结时提示一次；导出时按发送缓冲区空间发送记录帧
+void Blackbox_Poll(void) {
+    char message[64];
+    StrConv_BufferTypeDef out;
+    
+    if (blackbox_frozen && !blackbox_notified) {
+        blackbox_notified = 1;
+        StrConv_Init(&out, message, sizeof(message));
+        StrConv_AppendString(&out, "黑匣子已冻结: ");
+        StrConv_AppendUint(&out, blackbox_count, 0);
+        StrConv_AppendString(&out, " 条记录\r\n");
+        Communication_SendString(message);
+    }
+    if (!blackbox_dumping) {
+        return;
+    }
+    
+    // 先发送头帧：回放记录需要控制频率、陀螺仪零偏校准值和姿态滤波器
+    if (blackbox_dump_header) {
+        if (Communication_TxFree() < TELEMETRY_INFO_FRAME) {
+            return;
+        }
+        Telemetry_BlackboxInfoTypeDef info;
+        uint8_t frame[TELEMETRY_INFO_FRAME];
+        info.timestamp_us = blackbox_dump_us;
+        info.records = blackbox_dump_count;
+        info.rate_hz = CONTROL_RATE_HZ;
+        info.gyro_offset[0] = (blackbox_mpu != NULL) ? blackbox_mpu->gyroXoffset : 0.0f;
+        info.gyro_offset[1] = (blackbox_mpu != NULL) ? blackbox_mpu->gyroYoffset : 0.0f;
+        info.gyro_offset[2] = (blackbox_mpu != NULL) ? blackbox_mpu->gyroZoffset : 0.0f;
+        info.filter = (uint8_t)blackbox_filter;
+        Communication_SendFrame(frame, Telemetry_EncodeBlackboxInfo(&info, frame));
+        blackbox_dump_header = 0;
+    }
+    
+    while (blackbox_dump_index < blackbox_dump_count && Communication_TxFree() >= TELEMETRY_BLACKBOX_FRAME) {
+        uint8_t frame[TELEMETRY_BLACKBOX_FRAME];
+        const Telemetry_RecordTypeDef *record = &blackbox_records[Blackbox_Slot(blackbox_dump_index)];
+        if (blackbox_dump_index > 0) {
+            blackbox_dump_us += record->dt_us;
+        }
+        uint16_t len = Telemetry_EncodeRecord(record, blackbox_dump_index, blackbox_dump_us, frame);
+        Communication_SendFrame(frame, len);
+        blackbox_dump_index++;
+    }
+    
+    if (blackbox_dump_index >= blackbox_dump_count && Communication_TxFree() >= sizeof(message)) {
+        blackbox_dumping = 0;
+        StrConv_Init(&out, message, sizeof(message));
+        StrConv_AppendString(&out, "黑匣子导出完成: ");
+        StrConv_AppendUint(&out, blackbox_dump_count, 0);
+        StrConv_AppendString(&out, " 条记录\r\n");
+        Communication_SendString(message);
+    }
+}
\ No newline at end of file
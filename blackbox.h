@@ -0,0 +1,39 @@
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+
+#include "stm32f1xx_hal.h"
+#include "mpu6050.h"
+#include "attitude.h"
+#include "control.h"
+#include "telemetry.h"
+#include "parameters.h"
+
+// 黑匣子：RAM中的环形记录区，保存最近 BLACKBOX_RECORDS 个控制周期的完整状态
+//
+// 控制中断每个周期调用Blackbox_Record写入一条紧凑记录（Telemetry_RecordTypeDef，36字节）；
+// 角度与目标角相差超过MAX_ANGLE时记下这一条后冻结，此后不再覆盖，保留倒地前的过程。
+// "get blackbox"命令冻结并开始导出：主循环先发送头帧（控制频率、陀螺仪零偏校准值、姿态滤波器），
+// 再按发送缓冲区空间逐条编码为黑匣子记录帧（与遥测共用帧格式），
+// 发送缓冲区满时等下一轮，导出的记录帧不会被丢弃；"reset blackbox"清空并重新开始记录。
+
+#if BLACKBOX_ENABLE
+void Blackbox_Record(MPU6050_HandleTypeDef *hmpu, Attitude_HandleTypeDef *hatt, Control_HandleTypeDef *hctrl,
+                     float dt, uint32_t timestamp_us);
+#else
+static inline void Blackbox_Record(MPU6050_HandleTypeDef *hmpu, Attitude_HandleTypeDef *hatt,
+                                   Control_HandleTypeDef *hctrl, float dt, uint32_t timestamp_us) {
+    (void)hmpu;
+    (void)hatt;
+    (void)hctrl;
+    (void)dt;
+    (void)timestamp_us;
+}
+#endif
+
+// 函数声明
+void Blackbox_Reset(void);
+uint8_t Blackbox_IsFrozen(void);
+uint16_t Blackbox_StartDump(void);
+void Blackbox_Poll(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "calibration.h"
+#include "communication.h"
+#include "crc16.h"
+#include "strconv.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#define ACCEL_SCALE 16384.0f  // ±2g范围（与mpu6050.c一致）
+#define GYRO_SCALE 131.0f     // ±250°/s范围（与mpu6050.c一致）
+
+// 每次校准采集的控制周期数
+#define CALIB_SAMPLES (CALIB_TIME_MS * CONTROL_RATE_HZ / 1000)
+
+// 一次校准的结果（控制中断写入，主循环回报）
+#define CALIB_RESULT_NONE   0
+#define CALIB_RESULT_DONE   1
+#define CALIB_RESULT_MOVING 2     // 车体在动，已重新开始采集
+#define CALIB_RESULT_FACE   3     // 加速度计朝向与指定的面不符，未记录
+
+static const char *const calib_face_names[CALIB_FACES] = {"+x", "-x", "+y", "-y", "+z", "-z"};
+
+static MPU6050_HandleTypeDef *calib_mpu = NULL;
+static Calibration_DataTypeDef calib_data;      // 当前生效的校准值
+static uint8_t calib_stored = 0;                // 闪存中的数据有效且与calib_data一致
+
+// 采集状态（Calibration_Start写好后才置阶段，此后只在控制中断中访问）
+static volatile Calibration_StageTypeDef calib_stage = CALIB_IDLE;
+static uint8_t calib_face = 0;
+static uint16_t calib_count = 0;
+static float calib_gyro_sum[3];                 // 未校正的三轴角速度（°/s），所有阶段都用于判断是否静止
+static float calib_gyro_sq[3];
+static float calib_value_sum;                   // 水平：加速度计倾角；六面：该面所在轴的加速度原始值
+static float calib_face_mean[CALIB_FACES];
+static uint8_t calib_face_mask = 0;             // 已采集的面
+
+// 结果（控制中断置位，主循环清除）
+static volatile uint8_t calib_result = CALIB_RESULT_NONE;
+static Calibration_StageTypeDef calib_result_stage = CALIB_IDLE;
+static volatile uint8_t calib_dirty = 0;        // 校准值已改变，需要写入闪存（写完前电机保持停止）
+
+static uint8_t Calibration_Valid(const Calibration_DataTypeDef *data) {
+    return data->magic == CALIB_MAGIC && data->version == CALIB_VERSION && data->size == sizeof(*data) &&
+           data->crc == CRC16_Compute((const uint8_t *)data, offsetof(Calibration_DataTypeDef, crc));
+}
+
+// 未校准：零偏为0，标度为1，温度取当前值
+static void Calibration_Defaults(void) {
+    memset(&calib_data, 0, sizeof(calib_data));
+    for (uint8_t i = 0; i < 3; i++) {
+        calib_data.accel_scale[i] = 1.0f;
+    }
+    calib_data.temperature = calib_mpu->temperature;
+}
+
+// 校准值写入传感器句柄
+static void Calibration_Apply(void) {
+    calib_mpu->gyroXoffset = calib_data.gyro_offset[0];
+    calib_mpu->gyroYoffset = calib_data.gyro_offset[1];
+    calib_mpu->gyroZoffset = calib_data.gyro_offset[2];
+    for (uint8_t i = 0; i < 3; i++) {
+        calib_mpu->accelOffset[i] = calib_data.accel_offset[i];
+        calib_mpu->accelScaleError[i] = calib_data.accel_scale[i] - 1.0f;
+    }
+}
+
+// 擦除校准页后逐半字写入（主循环中调用；擦除约20ms，期间CPU取指暂停，控制中断也停顿，
+// 因此写完之前Calibration_IsActive保持为真，控制循环让电机停止）
+static HAL_StatusTypeDef Calibration_Save(void) {
+    Calibration_DataTypeDef data;
+    FLASH_EraseInitTypeDef erase;
+    uint32_t page_error;
+    
+    __disable_irq();
+    data = calib_data;
+    __enable_irq();
+    data.magic = CALIB_MAGIC;
+    data.version = CALIB_VERSION;
+    data.size = sizeof(data);
+    data.reserved = 0;
+    data.crc = CRC16_Compute((const uint8_t *)&data, offsetof(Calibration_DataTypeDef, crc));
+    
+    memset(&erase, 0, sizeof(erase));
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks = FLASH_BANK_1;
+    erase.PageAddress = CALIB_FLASH_ADDR;
+    erase.NbPages = 1;
+    
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &page_error);
+    const uint16_t *src = (const uint16_t *)&data;
+    for (uint16_t i = 0; status == HAL_OK && i < sizeof(data) / 2; i++) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, CALIB_FLASH_ADDR + 2 * i, src[i]);
+    }
+    HAL_FLASH_Lock();
+    
+    calib_stored = (status == HAL_OK) && Calibration_Valid((const Calibration_DataTypeDef *)CALIB_FLASH_ADDR);
+    return calib_stored ? HAL_OK : HAL_ERROR;
+}
+
+// 从闪存载入校准值并写入传感器句柄（温度须已由MPU6050_Init读出），返回闪存数据是否有效；
+// 无效或温度变化过大时开始陀螺仪校准
+uint8_t Calibration_Init(MPU6050_HandleTypeDef *hmpu) {
+    const Calibration_DataTypeDef *stored = (const Calibration_DataTypeDef *)CALIB_FLASH_ADDR;
+    
+    calib_mpu = hmpu;
+    calib_stored = Calibration_Valid(stored);
+    if (calib_stored) {
+        calib_data = *stored;
+    } else {
+        Calibration_Defaults();
+    }
+    Calibration_Apply();
+    
+    if (!calib_stored || fabsf(hmpu->temperature - calib_data.temperature) > CALIB_TEMP_DELTA) {
+        Calibration_Start(CALIB_GYRO, 0);
+    }
+    return calib_stored;
+}
+
+// 开始一次校准（face只用于加速度计六面），已有校准在进行时返回0
+uint8_t Calibration_Start(Calibration_StageTypeDef stage, uint8_t face) {
+    if (calib_mpu == NULL || calib_stage != CALIB_IDLE || stage == CALIB_IDLE || face >= CALIB_FACES) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        calib_gyro_sum[i] = 0.0f;
+        calib_gyro_sq[i] = 0.0f;
+    }
+    calib_value_sum = 0.0f;
+    calib_count = 0;
+    calib_face = face;
+    calib_stage = stage;
+    return 1;
+}
+
+// 采集中，或结果尚未写入闪存
+uint8_t Calibration_IsActive(void) {
+    return calib_stage != CALIB_IDLE || calib_dirty;
+}
+
+// 采集结束：检查是否静止，得出本阶段的结果
+static void Calibration_Finish(Calibration_StageTypeDef stage) {
+    float mean[3];
+    
+    for (uint8_t i = 0; i < 3; i++) {
+        mean[i] = calib_gyro_sum[i] / CALIB_SAMPLES;
+        if (calib_gyro_sq[i] / CALIB_SAMPLES - mean[i] * mean[i] > CALIB_GYRO_MAX_STD * CALIB_GYRO_MAX_STD) {
+            Calibration_Start(stage, calib_face);
+            calib_result = CALIB_RESULT_MOVING;
+            return;
+        }
+    }
+    
+    float value = calib_value_sum / CALIB_SAMPLES;
+    switch (stage) {
+        case CALIB_GYRO:
+            for (uint8_t i = 0; i < 3; i++) {
+                calib_data.gyro_offset[i] = mean[i];
+            }
+            calib_data.temperature = calib_mpu->temperature;
+            calib_dirty = 1;
+            break;
+    
+        case CALIB_LEVEL:
+            calib_data.mount_angle = value;
+            calib_dirty = 1;
+            break;
+    
+        case CALIB_ACCEL:
+            // 朝上的面读数为+1g，朝下为-1g，至少要有半个g才认为放对了
+            if (((calib_face & 1) ? -value : value) < ACCEL_SCALE * 0.5f) {
+                calib_result = CALIB_RESULT_FACE;
+                return;
+            }
+            calib_face_mean[calib_face] = value;
+            calib_face_mask |= 1U << calib_face;
+            if (calib_face_mask == (1U << CALIB_FACES) - 1) {
+                for (uint8_t i = 0; i < 3; i++) {
+                    float up = calib_face_mean[2 * i];
+                    float down = calib_face_mean[2 * i + 1];
+                    calib_data.accel_offset[i] = 0.5f * (up + down);
+                    calib_data.accel_scale[i] = 2.0f * ACCEL_SCALE / (up - down);
+                }
+                calib_face_mask = 0;
+                calib_dirty = 1;
+            }
+            break;
+    
+        default:
+            break;
+    }
+    Calibration_Apply();
+    calib_result = CALIB_RESULT_DONE;
+}
+
+// 控制中断中有新样本时调用：累加一个样本，采集完成的那一次返回完成的阶段，否则返回CALIB_IDLE
+Calibration_StageTypeDef Calibration_Feed(void) {
+    Calibration_StageTypeDef stage = calib_stage;
+    MPU6050_HandleTypeDef *hmpu = calib_mpu;
+    
+    if (stage == CALIB_IDLE) {
+        return CALIB_IDLE;
+    }
+    
+    // 加回当前零偏得到未校正的角速度（FIFO模式下gyroX/gyroY是整批样本的精确平均，原始值字段是截断值）
+    float gyro[3] = {hmpu->gyroX + hmpu->gyroXoffset, hmpu->gyroY + hmpu->gyroYoffset,
+                     hmpu->gyroZ_raw / GYRO_SCALE};
+    for (uint8_t i = 0; i < 3; i++) {
+        calib_gyro_sum[i] += gyro[i];
+        calib_gyro_sq[i] += gyro[i] * gyro[i];
+    }
+    if (stage == CALIB_LEVEL) {
+        calib_value_sum += hmpu->angleX;
+    } else if (stage == CALIB_ACCEL) {
+        int16_t accel[3] = {hmpu->accelX, hmpu->accelY, hmpu->accelZ};
+        calib_value_sum += accel[calib_face / 2];
+    }
+    
+    if (++calib_count < CALIB_SAMPLES) {
+        return CALIB_IDLE;
+    }
+    calib_result_stage = stage;
+    calib_stage = CALIB_IDLE;
+    Calibration_Finish(stage);
+    return (calib_result == CALIB_RESULT_DONE) ? stage : CALIB_IDLE;
+}
+
+// 校准值改变时写入闪存，写完后才清除标志，控制循环随后恢复平衡
+static void Calibration_SaveIfDirty(void) {
+    if (calib_dirty) {
+        Communication_SendString(Calibration_Save() == HAL_OK ? "校准数据已保存\r\n" : "校准数据保存失败\r\n");
+        calib_dirty = 0;
+    }
+}
+
+// 主循环中调用：回报校准结果，校准值改变时写入闪存；返回这次回报的已完成阶段，没有时返回CALIB_IDLE
+Calibration_StageTypeDef Calibration_Poll(void) {
+    char message[96];
+    StrConv_BufferTypeDef out;
+    const Calibration_DataTypeDef *d = &calib_data;
+    Calibration_StageTypeDef done;
+    
+    if (calib_result == CALIB_RESULT_NONE) {
+        Calibration_SaveIfDirty();
+        return CALIB_IDLE;
+    }
+    done = (calib_result == CALIB_RESULT_DONE) ? calib_result_stage : CALIB_IDLE;
+    
+    StrConv_Init(&out, message, sizeof(message));
+    if (calib_result == CALIB_RESULT_MOVING) {
+        StrConv_AppendString(&out, "校准时车体在动，重新采集\r\n");
+    } else if (calib_result == CALIB_RESULT_FACE) {
+        StrConv_AppendString(&out, "加速度计 ");
+        StrConv_AppendString(&out, calib_face_names[calib_face]);
+        StrConv_AppendString(&out, " 面朝向不对，未记录\r\n");
+    } else if (calib_result_stage == CALIB_GYRO) {
+        StrConv_AppendString(&out, "陀螺仪校准完成: ");
+        StrConv_AppendVector(&out, d->gyro_offset, 3, 3);
+        StrConv_AppendString(&out, " °/s, ");
+        StrConv_AppendFloat(&out, d->temperature, 1);
+        StrConv_AppendString(&out, "°C\r\n");
+    } else if (calib_result_stage == CALIB_LEVEL) {
+        StrConv_AppendString(&out, "水平校准完成: 安装角 ");
+        StrConv_AppendFloat(&out, d->mount_angle, 2);
+        StrConv_AppendString(&out, "°\r\n");
+    } else if (calib_face_mask != 0) {
+        uint8_t faces = 0;
+        for (uint8_t i = 0; i < CALIB_FACES; i++) {
+            faces += (calib_face_mask >> i) & 1U;
+        }
+        StrConv_AppendString(&out, "加速度计 ");
+        StrConv_AppendString(&out, calib_face_names[calib_face]);
+        StrConv_AppendString(&out, " 面完成（");
+        StrConv_AppendUint(&out, faces, 0);
+        StrConv_AppendString(&out, "/");
+        StrConv_AppendUint(&out, CALIB_FACES, 0);
+        StrConv_AppendString(&out, "）\r\n");
+    } else {
+        StrConv_AppendString(&out, "加速度计校准完成: 零偏 ");
+        StrConv_AppendVector(&out, d->accel_offset, 3, 0);
+        StrConv_AppendString(&out, ", 标度 ");
+        StrConv_AppendVector(&out, d->accel_scale, 3, 4);
+        StrConv_AppendString(&out, "\r\n");
+    }
+    Communication_SendString(message);
+    calib_result = CALIB_RESULT_NONE;
+    
+    Calibration_SaveIfDirty();
+    return done;
+}
+
+uint8_t Calibration_IsStored(void) {
+    return calib_stored;
+}
+
+const Calibration_DataTypeDef *Calibration_Get(void) {
+    return &calib_data;
+}
+
+// 解析加速度计的面（+x/-x/+y/-y/+z/-z），有效返回1
+uint8_t Calibration_ParseFace(const char *name, uint8_t *face) {
+    for (uint8_t i = 0; i < CALIB_FACES; i++) {
+        if (strcmp(name, calib_face_names[i]) == 0) {
+            *face = i;
+            return 1;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
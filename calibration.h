@@ -0,0 +1,56 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "stm32f1xx_hal.h"
+#include "mpu6050.h"
+#include "parameters.h"
+
+// 传感器校准：陀螺仪零偏、加速度计零偏/标度、安装角，带CRC保存在闪存 CALIB_FLASH_ADDR 处的一页
+//
+// 上电时Calibration_Init从闪存读出并写入MPU6050句柄，只需几微秒；数据无效或温度与校准时相差超过
+// CALIB_TEMP_DELTA 时启动陀螺仪校准。校准不阻塞：控制中断每个周期把新样本交给Calibration_Feed累加，
+// 采集 CALIB_TIME_MS 后得出结果，期间调用者停止电机、不运行控制；主循环的Calibration_Poll保存到闪存并回报，
+// 保存（擦除闪存时控制中断停顿）完成前Calibration_IsActive仍为真，电机保持停止。
+//
+//   陀螺仪：车体静止，取三轴角速度平均值（标准差超过CALIB_GYRO_MAX_STD时认为在动，重新采集）
+//   水平：  车体扶在机械平衡点，取加速度计倾角平均值作为安装角（直立环目标角）
+//   加速度计六面：每个轴分别朝上、朝下各采集一次（+x/-x/+y/-y/+z/-z），六面齐全后
+//           零偏 = (朝上 + 朝下) / 2，标度 = 2g / (朝上 - 朝下)；先做六面校准再做水平校准
+
+#define CALIB_MAGIC     0x424C4143U     // "CALB"
+#define CALIB_VERSION   1
+#define CALIB_FACES     6               // 加速度计六面：+x, -x, +y, -y, +z, -z
+
+// 校准阶段
+typedef enum {
+    CALIB_IDLE = 0,
+    CALIB_GYRO,
+    CALIB_LEVEL,
+    CALIB_ACCEL
+} Calibration_StageTypeDef;
+
+// 闪存中的校准数据（按半字写入，长度为偶数；CRC覆盖crc之前的全部字节）
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                  // sizeof(Calibration_DataTypeDef)
+    float gyro_offset[3];           // 陀螺仪零偏（°/s）
+    float accel_offset[3];          // 加速度计零偏（LSB）
+    float accel_scale[3];           // 加速度计标度（未校准为1）
+    float mount_angle;              // 安装角（度），即直立环目标角
+    float temperature;              // 校准时的芯片温度（°C）
+    uint16_t reserved;
+    uint16_t crc;                   // CRC-16/CCITT-FALSE
+} Calibration_DataTypeDef;
+
+// 函数声明
+uint8_t Calibration_Init(MPU6050_HandleTypeDef *hmpu);
+uint8_t Calibration_Start(Calibration_StageTypeDef stage, uint8_t face);
+uint8_t Calibration_IsActive(void);
+Calibration_StageTypeDef Calibration_Feed(void);
+Calibration_StageTypeDef Calibration_Poll(void);
+uint8_t Calibration_IsStored(void);
+const Calibration_DataTypeDef *Calibration_Get(void);
+uint8_t Calibration_ParseFace(const char *name, uint8_t *face);
+
+#endif
\ No newline at end of file
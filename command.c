@@ -0,0 +1,175 @@
+#include "command.h"
+#include "strconv.h"
+#include <string.h>
+
+#define COMMAND_HASH_SIZE   64      // 散列索引槽数（2的幂，至少为表项数的两倍）
+#define FNV_OFFSET          2166136261U
+#define FNV_PRIME           16777619U
+
+// 命令表：增加命令时在这里加一项
+static const Command_EntryTypeDef command_table[] = {
+    {"set",       "kp",          CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_KP},
+    {"set",       "ki",          CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_KI},
+    {"set",       "kd",          CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_KD},
+    {"set",       "angle",       CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_TARGET_ANGLE},
+    {"set",       "qangle",      CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_Q_ANGLE},
+    {"set",       "qgyro",       CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_Q_GYRO},
+    {"set",       "rangle",      CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_R_ANGLE},
+    {"set",       "deadzone",    CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_DEAD_ZONE},
+    {"set",       "maxout",      CMD_SET_PARAM,       CMD_ARG_FLOAT,  PARAM_MAX_OUTPUT},
+    {"set",       "speed",       CMD_SET_SPEED,       CMD_ARG_FLOAT,  0},
+    {"set",       "turn",        CMD_SET_TURN,        CMD_ARG_FLOAT,  0},
+    {"set",       "filter",      CMD_SET_FILTER,      CMD_ARG_FILTER, 0},
+    {"calibrate", "gyro",        CMD_CALIBRATE,       CMD_ARG_NONE,   CALIB_GYRO},
+    {"calibrate", "level",       CMD_CALIBRATE,       CMD_ARG_NONE,   CALIB_LEVEL},
+    {"calibrate", "accel",       CMD_CALIBRATE,       CMD_ARG_FACE,   CALIB_ACCEL},
+    {"get",       "status",      CMD_GET_STATUS,      CMD_ARG_NONE,   0},
+    {"get",       "calibration", CMD_GET_CALIBRATION, CMD_ARG_NONE,   0},
+    {"get",       "params",      CMD_GET_PARAMS,      CMD_ARG_NONE,   0},
+    {"reset",     "params",      CMD_RESET_PARAMS,    CMD_ARG_NONE,   0},
+    {"get",       "profile",     CMD_GET_PROFILE,     CMD_ARG_NONE,   0},
+    {"reset",     "profile",     CMD_RESET_PROFILE,   CMD_ARG_NONE,   0},
+    {"get",       "blackbox",    CMD_GET_BLACKBOX,    CMD_ARG_NONE,   0},
+    {"reset",     "blackbox",    CMD_RESET_BLACKBOX,  CMD_ARG_NONE,   0},
+    {"reset",     NULL,          CMD_RESET,           CMD_ARG_NONE,   0},
+};
+
+#define COMMAND_COUNT (sizeof(command_table) / sizeof(command_table[0]))
+
+// 散列索引：槽中为表项下标+1，0为空
+static uint8_t command_index[COMMAND_HASH_SIZE];
+static uint8_t command_ready = 0;
+
+// FNV-1a：第一个词，有第二个词时再加一个空格和第二个词
+static uint32_t Command_Hash(const char *verb, const char *object) {
+    uint32_t hash = FNV_OFFSET;
+    for (const char *p = verb; *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * FNV_PRIME;
+    }
+    if (object != NULL) {
+        hash = (hash ^ (uint8_t)' ') * FNV_PRIME;
+        for (const char *p = object; *p != '\0'; p++) {
+            hash = (hash ^ (uint8_t)*p) * FNV_PRIME;
+        }
+    }
+    return hash;
+}
+
+// 建立散列索引（线性探测）
+void Command_Init(void) {
+    memset(command_index, 0, sizeof(command_index));
+    for (uint8_t i = 0; i < COMMAND_COUNT; i++) {
+        uint32_t slot = Command_Hash(command_table[i].verb, command_table[i].object) & (COMMAND_HASH_SIZE - 1);
+        while (command_index[slot] != 0) {
+            slot = (slot + 1) & (COMMAND_HASH_SIZE - 1);
+        }
+        command_index[slot] = i + 1;
+    }
+    command_ready = 1;
+}
+
+// 查找命令名（object为NULL时查单个词的命令），没有时返回NULL
+static const Command_EntryTypeDef *Command_Find(const char *verb, const char *object) {
+    uint32_t slot = Command_Hash(verb, object) & (COMMAND_HASH_SIZE - 1);
+    while (command_index[slot] != 0) {
+        const Command_EntryTypeDef *entry = &command_table[command_index[slot] - 1];
+        if (strcmp(entry->verb, verb) == 0 &&
+            ((object == NULL) ? (entry->object == NULL) : (entry->object != NULL && strcmp(entry->object, object) == 0))) {
+            return entry;
+        }
+        slot = (slot + 1) & (COMMAND_HASH_SIZE - 1);
+    }
+    return NULL;
+}
+
+// 按空格/制表符原地切词（在词尾写入'\0'），返回词数；超过max个时返回max + 1
+static uint8_t Command_Split(char *line, char *words[], uint8_t max) {
+    uint8_t count = 0;
+    char *p = line;
+    
+    while (1) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0') {
+            return count;
+        }
+        if (count == max) {
+            return max + 1;
+        }
+        words[count++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') {
+            p++;
+        }
+        if (*p != '\0') {
+            *p++ = '\0';
+        }
+    }
+}
+
+// 解析一行命令（line会被切词修改），结果写入cmd并返回命令类型
+CommandType Command_Parse(char *line, Command_TypeDef *cmd) {
+    char *words[COMMAND_MAX_WORDS];
+    uint8_t count = Command_Split(line, words, COMMAND_MAX_WORDS);
+    const Command_EntryTypeDef *entry = NULL;
+    uint8_t argc;
+    
+    if (!command_ready) {
+        Command_Init();
+    }
+    cmd->entry = NULL;
+    
+    // 先按两个词查，再按一个词查（词数超出时argc也超出，按参数错误回报）
+    if (count >= 2) {
+        entry = Command_Find(words[0], words[1]);
+    }
+    argc = (uint8_t)(count - 2);
+    if (entry == NULL && count >= 1) {
+        entry = Command_Find(words[0], NULL);
+        argc = (uint8_t)(count - 1);
+    }
+    if (entry == NULL) {
+        cmd->type = CMD_UNKNOWN;
+        return cmd->type;
+    }
+    cmd->entry = entry;
+    
+    // 参数个数：CMD_ARG_NONE没有参数，其余恰好一个（即最后一个词）
+    uint8_t ok = (argc == ((entry->arg == CMD_ARG_NONE) ? 0 : 1));
+    if (ok) {
+        const char *arg = words[count - 1];
+        switch (entry->arg) {
+            case CMD_ARG_FLOAT:
+                ok = StrConv_ParseFloat(arg, &cmd->value);
+                break;
+            case CMD_ARG_FILTER:
+                ok = Attitude_ParseName(arg, &cmd->filter);
+                break;
+            case CMD_ARG_FACE:
+                ok = Calibration_ParseFace(arg, &cmd->face);
+                break;
+            default:
+                cmd->face = 0;
+                break;
+        }
+    }
+    
+    cmd->param = (ParamStore_IdTypeDef)entry->target;
+    cmd->calib = (Calibration_StageTypeDef)entry->target;
+    cmd->type = ok ? entry->type : CMD_BAD_ARGUMENT;
+    return cmd->type;
+}
+
+// 参数类型的用法说明（回报CMD_BAD_ARGUMENT用）
+const char *Command_ArgUsage(Command_ArgTypeDef arg) {
+    switch (arg) {
+        case CMD_ARG_FLOAT:
+            return " <数值>";
+        case CMD_ARG_FILTER:
+            return " kalman|comp|mahony";
+        case CMD_ARG_FACE:
+            return " +x|-x|+y|-y|+z|-z";
+        default:
+            return "";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "stm32f1xx_hal.h"
+#include "attitude.h"
+#include "calibration.h"
+#include "paramstore.h"
+
+// 串口命令解析：命令行按空白切成词，前一或两个词在命令表中查找，其余的词按表项的参数类型解析
+//
+// 命令表（command.c）在Command_Init时建成开放寻址散列索引（FNV-1a），每行只计算一次散列、
+// 比较一次字符串；数值由strconv.c解析，不经过sscanf。增加命令只需在表中加一项，
+// 再在Communication_ProcessCommand中处理对应的命令类型。
+
+#define COMMAND_MAX_WORDS   4       // 一行最多的词数（命令名两个词 + 参数）
+
+// 命令类型
+typedef enum {
+    CMD_NONE = 0,
+    CMD_SET_PARAM,          // set kp/ki/kd/angle/qangle/qgyro/rangle/deadzone/maxout <数值>
+    CMD_SET_SPEED,
+    CMD_SET_TURN,
+    CMD_SET_FILTER,
+    CMD_CALIBRATE,
+    CMD_GET_STATUS,
+    CMD_GET_CALIBRATION,
+    CMD_GET_PARAMS,
+    CMD_RESET_PARAMS,
+    CMD_GET_PROFILE,
+    CMD_RESET_PROFILE,
+    CMD_GET_BLACKBOX,
+    CMD_RESET_BLACKBOX,
+    CMD_RESET,
+    CMD_UNKNOWN,            // 命令名不在表中
+    CMD_BAD_ARGUMENT,       // 命令名有效，参数缺失、多余或无效
+    CMD_OVERFLOW
+} CommandType;
+
+// 参数类型
+typedef enum {
+    CMD_ARG_NONE = 0,
+    CMD_ARG_FLOAT,          // 十进制浮点数
+    CMD_ARG_FILTER,         // 姿态滤波器名称（kalman/comp/mahony）
+    CMD_ARG_FACE            // 加速度计的面（+x/-x/+y/-y/+z/-z）
+} Command_ArgTypeDef;
+
+// 命令表项
+typedef struct {
+    const char *verb;           // 第一个词
+    const char *object;         // 第二个词，单个词的命令为NULL
+    CommandType type;
+    Command_ArgTypeDef arg;
+    uint8_t target;             // CMD_SET_PARAM的参数编号，CMD_CALIBRATE的校准阶段
+} Command_EntryTypeDef;
+
+// 一条命令的解析结果
+typedef struct {
+    CommandType type;
+    const Command_EntryTypeDef *entry;  // 查到的表项（CMD_BAD_ARGUMENT时用于回报用法）
+    float value;                        // CMD_ARG_FLOAT
+    Attitude_FilterTypeDef filter;      // CMD_ARG_FILTER
+    uint8_t face;                       // CMD_ARG_FACE
+    ParamStore_IdTypeDef param;         // CMD_SET_PARAM
+    Calibration_StageTypeDef calib;     // CMD_CALIBRATE
+} Command_TypeDef;
+
+// 函数声明
+void Command_Init(void);
+CommandType Command_Parse(char *line, Command_TypeDef *cmd);
+const char *Command_ArgUsage(Command_ArgTypeDef arg);
+
+#endif
\ No newline at end of file
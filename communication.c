@@ -1,7 +1,11 @@
 #include "communication.h"
 #include "stm32f1xx_hal.h"
+#include "profiler.h"
+#include "blackbox.h"
+#include "command.h"
+#include "strconv.h"
+#include "battery.h"
 #include <string.h>
-#include <stdio.h>
 
 // 全局通信句柄
 Communication_HandleTypeDef *g_comm_handle = NULL;
@@ -10,83 +14,301 @@ Communication_HandleTypeDef *g_comm_handle = NULL;
 void Communication_Init(Communication_HandleTypeDef *hcomm, UART_HandleTypeDef *huart) {
     hcomm->huart = huart;
     hcomm->rx_index = 0;
-    hcomm->current_cmd = CMD_NONE;
-    hcomm->cmd_value = 0.0f;
+    hcomm->rx_dma_pos = 0;
+    hcomm->rx_dropped = 0;
+    hcomm->command.type = CMD_NONE;
+    hcomm->tx_busy = 0;
+    hcomm->tx_dma_len = 0;
+    hcomm->tx_seq = 0;
+    hcomm->tx_dropped = 0;
     
     // 清空缓冲区
     memset(hcomm->rx_buffer, 0, RX_BUFFER_SIZE);
-    memset(hcomm->tx_buffer, 0, TX_BUFFER_SIZE);
+    RingBuf_Init(&hcomm->rx_ring, hcomm->rx_ring_buffer, RX_RING_SIZE);
+    RingBuf_Init(&hcomm->tx_ring, hcomm->tx_buffer, TX_BUFFER_SIZE);
+    
+    // 命令表散列索引
+    Command_Init();
     
     // 保存全局句柄
     g_comm_handle = hcomm;
     
-    // 启动接收中断
-    HAL_UART_Receive_IT(huart, &hcomm->rx_buffer[0], 1);
+    // 启动循环DMA接收（空闲线检测）
+    HAL_UARTEx_ReceiveToIdle_DMA(huart, hcomm->rx_dma_buffer, RX_DMA_SIZE);
     
     // 发送欢迎信息
     Communication_SendString("STM32平衡小车通信就绪\r\n");
 }
 
-// 发送传感器数据
-void Communication_SendData(float angle, float output) {
-    char buffer[64];
-    int len = snprintf(buffer, sizeof(buffer), "Angle:%.2f, Output:%.2f\r\n", angle, output);
+// 发送缓冲区中有数据且DMA空闲时，发送从读指针开始的连续一段
+// 主循环和发送完成中断都会调用，由调用者保证互斥
+static void Communication_StartTx(void) {
+    uint8_t *data;
     
-    if (len > 0) {
-        HAL_UART_Transmit(g_comm_handle->huart, (uint8_t*)buffer, len, 100);
+    if (g_comm_handle->tx_busy) {
+        return;
+    }
+    uint16_t len = RingBuf_Peek(&g_comm_handle->tx_ring, &data);
+    if (len == 0) {
+        return;
+    }
+    if (HAL_UART_Transmit_DMA(g_comm_handle->huart, data, len) == HAL_OK) {
+        g_comm_handle->tx_busy = 1;
+        g_comm_handle->tx_dma_len = len;
     }
 }
 
+// 整条消息写入发送缓冲区并启动DMA，缓冲区满时丢弃整条消息（只能在主循环中调用）
+static void Communication_Queue(const uint8_t *data, uint16_t len) {
+    if (RingBuf_Write(&g_comm_handle->tx_ring, data, len) == 0) {
+        g_comm_handle->tx_dropped++;
+        return;
+    }
+    __disable_irq();
+    Communication_StartTx();
+    __enable_irq();
+}
+
+// 发送遥测帧
+void Communication_SendTelemetry(const Telemetry_SampleTypeDef *sample) {
+    uint8_t frame[TELEMETRY_STATE_FRAME];
+    uint16_t len = Telemetry_EncodeState(sample, g_comm_handle->tx_seq++, frame);
+    Communication_Queue(frame, len);
+}
+
 // 发送字符串
 void Communication_SendString(const char *str) {
-    HAL_UART_Transmit(g_comm_handle->huart, (uint8_t*)str, strlen(str), 100);
+    Communication_Queue((const uint8_t*)str, (uint16_t)strlen(str));
+}
+
+// 发送已编码的完整帧
+void Communication_SendFrame(const uint8_t *frame, uint16_t len) {
+    Communication_Queue(frame, len);
+}
+
+// 发送缓冲区剩余空间（主循环中调用，用于分批发送大量数据而不丢弃）
+uint16_t Communication_TxFree(void) {
+    return RingBuf_Free(&g_comm_handle->tx_ring);
 }
 
 // 检查是否有命令
 uint8_t Communication_HasCommand(void) {
-    return (g_comm_handle->current_cmd != CMD_NONE);
+    return (g_comm_handle->command.type != CMD_NONE);
 }
 
 // 处理命令
-void Communication_ProcessCommand(PID_HandleTypeDef *hpid, float *target_angle) {
-    if (g_comm_handle->current_cmd == CMD_NONE) {
+void Communication_ProcessCommand(Control_HandleTypeDef *hctrl, Attitude_HandleTypeDef *hatt) {
+    if (g_comm_handle->command.type == CMD_NONE) {
         return;
     }
     
-    switch (g_comm_handle->current_cmd) {
-        case CMD_SET_KP:
-            hpid->kp = g_comm_handle->cmd_value;
-            Communication_SendString("KP参数已更新\r\n");
+    switch (g_comm_handle->command.type) {
+        case CMD_SET_SPEED:
+            hctrl->target_speed = g_comm_handle->command.value;
+            Communication_SendString("目标速度已更新\r\n");
+            break;
+            
+        case CMD_SET_TURN:
+            hctrl->target_turn = g_comm_handle->command.value;
+            Communication_SendString("目标转向已更新\r\n");
+            break;
+            
+        case CMD_SET_FILTER:
+            // 滤波器状态在控制中断中使用，切换需与中断互斥
+            __disable_irq();
+            Attitude_SetFilter(hatt, g_comm_handle->command.filter);
+            __enable_irq();
+            Communication_SendString("姿态滤波器已切换\r\n");
+            break;
+            
+        case CMD_SET_PARAM:
+            // 增益、目标角等可调参数经参数存储修改：立即生效（与控制中断互斥在ParamStore_Set中处理），稍后写入闪存
+            {
+                ParamStore_IdTypeDef id = g_comm_handle->command.param;
+                char message[64];
+                StrConv_BufferTypeDef out;
+                float min, max;
+                StrConv_Init(&out, message, sizeof(message));
+                StrConv_AppendString(&out, ParamStore_GetName(id));
+                if (ParamStore_Set(id, g_comm_handle->command.value)) {
+                    StrConv_AppendString(&out, "已更新\r\n");
+                } else {
+                    ParamStore_GetRange(id, &min, &max);
+                    StrConv_AppendString(&out, "超出范围（");
+                    StrConv_AppendFloatCompact(&out, min);
+                    StrConv_AppendString(&out, "~");
+                    StrConv_AppendFloatCompact(&out, max);
+                    StrConv_AppendString(&out, "）\r\n");
+                }
+                Communication_SendString(message);
+            }
+            break;
+            
+        case CMD_CALIBRATE:
+            // 结果由主循环的Calibration_Poll回报
+            if (!Calibration_Start(g_comm_handle->command.calib, g_comm_handle->command.face)) {
+                Communication_SendString("校准正在进行\r\n");
+                break;
+            }
+            Communication_SendString("开始校准，电机停止输出，请保持车体静止\r\n");
             break;
             
-        case CMD_SET_KI:
-            hpid->ki = g_comm_handle->cmd_value;
-            Communication_SendString("KI参数已更新\r\n");
+        case CMD_GET_CALIBRATION:
+            {
+                const Calibration_DataTypeDef *d = Calibration_Get();
+                char line[128];
+                StrConv_BufferTypeDef out;
+                StrConv_Init(&out, line, sizeof(line));
+                StrConv_AppendString(&out, "Gyro:");
+                StrConv_AppendVector(&out, d->gyro_offset, 3, 3);
+                StrConv_AppendString(&out, ", Temp:");
+                StrConv_AppendFloat(&out, d->temperature, 1);
+                StrConv_AppendString(&out, ", Mount:");
+                StrConv_AppendFloat(&out, d->mount_angle, 2);
+                StrConv_AppendString(&out, ", Stored:");
+                StrConv_AppendUint(&out, Calibration_IsStored(), 0);
+                StrConv_AppendString(&out, "\r\n");
+                Communication_SendString(line);
+                StrConv_Init(&out, line, sizeof(line));
+                StrConv_AppendString(&out, "AccelOffset:");
+                StrConv_AppendVector(&out, d->accel_offset, 3, 1);
+                StrConv_AppendString(&out, ", AccelScale:");
+                StrConv_AppendVector(&out, d->accel_scale, 3, 4);
+                StrConv_AppendString(&out, "\r\n");
+                Communication_SendString(line);
+            }
             break;
             
-        case CMD_SET_KD:
-            hpid->kd = g_comm_handle->cmd_value;
-            Communication_SendString("KD参数已更新\r\n");
+        case CMD_GET_PARAMS:
+            {
+                // Stored为0：默认值（闪存中没有记录）或尚未写入
+                char line[64];
+                StrConv_BufferTypeDef out;
+                for (int id = 0; id < PARAM_COUNT; id++) {
+                    StrConv_Init(&out, line, sizeof(line));
+                    StrConv_AppendString(&out, ParamStore_GetName((ParamStore_IdTypeDef)id));
+                    StrConv_AppendString(&out, ":");
+                    StrConv_AppendFloatCompact(&out, ParamStore_Get((ParamStore_IdTypeDef)id));
+                    StrConv_AppendString(&out, ", Stored:");
+                    StrConv_AppendUint(&out, ParamStore_IsStored((ParamStore_IdTypeDef)id), 0);
+                    StrConv_AppendString(&out, "\r\n");
+                    Communication_SendString(line);
+                }
+                StrConv_Init(&out, line, sizeof(line));
+                StrConv_AppendString(&out, "Records:");
+                StrConv_AppendUint(&out, ParamStore_Used(), 0);
+                StrConv_AppendString(&out, ", Pending:");
+                StrConv_AppendUint(&out, ParamStore_Pending(), 0);
+                StrConv_AppendString(&out, "\r\n");
+                Communication_SendString(line);
+            }
             break;
             
-        case CMD_SET_ANGLE:
-            *target_angle = g_comm_handle->cmd_value;
-            Communication_SendString("目标角度已更新\r\n");
+        case CMD_RESET_PARAMS:
+            ParamStore_Reset();
+            Communication_SendString("参数已恢复默认值\r\n");
             break;
             
         case CMD_GET_STATUS:
             {
-                char status[128];
-                snprintf(status, sizeof(status), 
-                        "KP:%.2f, KI:%.2f, KD:%.2f, Target:%.2f\r\n", 
-                        hpid->kp, hpid->ki, hpid->kd, *target_angle);
+                char status[160];
+                StrConv_BufferTypeDef out;
+                StrConv_Init(&out, status, sizeof(status));
+                StrConv_AppendString(&out, "KP:");
+                StrConv_AppendFloat(&out, ParamStore_Get(PARAM_KP), 2);
+                StrConv_AppendString(&out, ", KI:");
+                StrConv_AppendFloat(&out, ParamStore_Get(PARAM_KI), 2);
+                StrConv_AppendString(&out, ", KD:");
+                StrConv_AppendFloat(&out, ParamStore_Get(PARAM_KD), 2);
+                StrConv_AppendString(&out, ", Target:");
+                StrConv_AppendFloat(&out, hctrl->target_angle, 2);
+                StrConv_AppendString(&out, ", Speed:");
+                StrConv_AppendFloat(&out, hctrl->speed, 2);
+                StrConv_AppendString(&out, "/");
+                StrConv_AppendFloat(&out, hctrl->target_speed, 2);
+                StrConv_AppendString(&out, ", Turn:");
+                StrConv_AppendFloat(&out, hctrl->turn, 2);
+                StrConv_AppendString(&out, "/");
+                StrConv_AppendFloat(&out, hctrl->target_turn, 2);
+                StrConv_AppendString(&out, ", Filter:");
+                StrConv_AppendString(&out, Attitude_GetName(hatt->filter));
+                StrConv_AppendString(&out, ", State:");
+                StrConv_AppendString(&out, Control_GetStateName(Control_GetState(hctrl)));
+                StrConv_AppendString(&out, ", Battery:");
+                StrConv_AppendFloat(&out, Battery_GetVoltage(), 2);
+                StrConv_AppendString(&out, "V\r\n");
                 Communication_SendString(status);
             }
             break;
             
+        case CMD_GET_PROFILE:
+            {
+                // 每行单独放入发送缓冲区，缓冲区满时该行被丢弃
+                char line[128];
+                Profiler_FormatHeader(line, sizeof(line));
+                Communication_SendString(line);
+                for (int probe = 0; probe < PROFILE_COUNT; probe++) {
+                    Profiler_FormatProbe((Profiler_ProbeTypeDef)probe, line, sizeof(line));
+                    Communication_SendString(line);
+                }
+            }
+            break;
+            
+        case CMD_RESET_PROFILE:
+            Profiler_Reset();
+            Communication_SendString("耗时统计已清空\r\n");
+            break;
+            
+        case CMD_GET_BLACKBOX:
+            {
+                // 记录帧由主循环的Blackbox_Poll按缓冲区空间陆续发送
+                char message[64];
+                StrConv_BufferTypeDef out;
+                StrConv_Init(&out, message, sizeof(message));
+                StrConv_AppendString(&out, "黑匣子导出: ");
+                StrConv_AppendUint(&out, Blackbox_StartDump(), 0);
+                StrConv_AppendString(&out, " 条记录\r\n");
+                Communication_SendString(message);
+            }
+            break;
+            
+        case CMD_RESET_BLACKBOX:
+            Blackbox_Reset();
+            Communication_SendString("黑匣子已清空\r\n");
+            break;
+            
         case CMD_RESET:
-            PID_Reset(hpid);
-            Communication_SendString("PID控制器已重置\r\n");
+            // 控制器状态在控制中断中使用，复位需与中断互斥
+            __disable_irq();
+            Control_Reset(hctrl);
+            __enable_irq();
+            Communication_SendString("控制器已重置\r\n");
+            break;
+            
+        case CMD_UNKNOWN:
+            Communication_SendString("未知命令\r\n");
+            break;
+            
+        case CMD_BAD_ARGUMENT:
+            {
+                const Command_EntryTypeDef *entry = g_comm_handle->command.entry;
+                char message[80];
+                StrConv_BufferTypeDef out;
+                StrConv_Init(&out, message, sizeof(message));
+                StrConv_AppendString(&out, "参数错误，用法: ");
+                StrConv_AppendString(&out, entry->verb);
+                if (entry->object != NULL) {
+                    StrConv_AppendString(&out, " ");
+                    StrConv_AppendString(&out, entry->object);
+                }
+                StrConv_AppendString(&out, Command_ArgUsage(entry->arg));
+                StrConv_AppendString(&out, "\r\n");
+                Communication_SendString(message);
+            }
+            break;
+            
+        case CMD_OVERFLOW:
+            Communication_SendString("缓冲区已满，已清空\r\n");
             break;
             
         default:
@@ -94,89 +316,100 @@ void Communication_ProcessCommand(PID_HandleTypeDef *hpid, float *target_angle)
     }
     
     // 清除命令
-    g_comm_handle->current_cmd = CMD_NONE;
+    g_comm_handle->command.type = CMD_NONE;
 }
 
-// 解析命令
-void ParseCommand(const char *cmd) {
-    if (g_comm_handle == NULL) return;
+// 组装命令行：从接收环形缓冲区取出字节，收到回车或换行时解析（主循环调用）
+// 解析出一条命令后即返回，剩余字节留在缓冲区中，等这条命令处理完再继续
+void Communication_Poll(void) {
+    uint8_t received_char;
     
-    char param[32];
-    float value;
-    
-    if (sscanf(cmd, "set kp %f", &value) == 1) {
-        g_comm_handle->current_cmd = CMD_SET_KP;
-        g_comm_handle->cmd_value = value;
-    }
-    else if (sscanf(cmd, "set ki %f", &value) == 1) {
-        g_comm_handle->current_cmd = CMD_SET_KI;
-        g_comm_handle->cmd_value = value;
-    }
-    else if (sscanf(cmd, "set kd %f", &value) == 1) {
-        g_comm_handle->current_cmd = CMD_SET_KD;
-        g_comm_handle->cmd_value = value;
-    }
-    else if (sscanf(cmd, "set angle %f", &value) == 1) {
-        g_comm_handle->current_cmd = CMD_SET_ANGLE;
-        g_comm_handle->cmd_value = value;
-    }
-    else if (strcmp(cmd, "get status") == 0) {
-        g_comm_handle->current_cmd = CMD_GET_STATUS;
-    }
-    else if (strcmp(cmd, "reset") == 0) {
-        g_comm_handle->current_cmd = CMD_RESET;
+    while (g_comm_handle->command.type == CMD_NONE &&
+           RingBuf_Read(&g_comm_handle->rx_ring, &received_char, 1) == 1) {
+        // 处理回车或换行符
+        if (received_char == '\r' || received_char == '\n') {
+            if (g_comm_handle->rx_index > 0) {
+                // 添加字符串结束符
+                g_comm_handle->rx_buffer[g_comm_handle->rx_index] = '\0';
+                
+                // 解析命令（原地切词）
+                Command_Parse((char*)g_comm_handle->rx_buffer, &g_comm_handle->command);
+                
+                // 清空缓冲区
+                g_comm_handle->rx_index = 0;
+                memset(g_comm_handle->rx_buffer, 0, RX_BUFFER_SIZE);
+            }
+        }
+        else if (received_char == '\b' || received_char == 127) { // 退格键
+            if (g_comm_handle->rx_index > 0) {
+                g_comm_handle->rx_index--;
+            }
+        }
+        else if (g_comm_handle->rx_index < RX_BUFFER_SIZE - 1) {
+            g_comm_handle->rx_buffer[g_comm_handle->rx_index++] = received_char;
+        }
+        else {
+            // 缓冲区满，清空
+            g_comm_handle->rx_index = 0;
+            memset(g_comm_handle->rx_buffer, 0, RX_BUFFER_SIZE);
+            g_comm_handle->command.type = CMD_OVERFLOW;
+        }
     }
-    else {
-        Communication_SendString("未知命令\r\n");
+}
+
+// 把DMA缓冲区中的一段移入接收环形缓冲区，放不下时整段丢弃
+static void Communication_RxStore(const uint8_t *data, uint16_t len) {
+    if (len > 0 && RingBuf_Write(&g_comm_handle->rx_ring, data, len) == 0) {
+        g_comm_handle->rx_dropped += len;
     }
 }
 
-// UART接收完成回调
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+// UART接收事件回调（空闲线、DMA半满、DMA全满）
+// Size为DMA在循环缓冲区中的写入位置，只搬运上次事件之后新到的字节
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
     if (g_comm_handle == NULL || huart != g_comm_handle->huart) {
         return;
     }
     
-    uint8_t received_char = g_comm_handle->rx_buffer[g_comm_handle->rx_index];
-    
-    // 处理回车或换行符
-    if (received_char == '\r' || received_char == '\n') {
-        if (g_comm_handle->rx_index > 0) {
-            // 添加字符串结束符
-            g_comm_handle->rx_buffer[g_comm_handle->rx_index] = '\0';
-            
-            // 解析命令
-            ParseCommand((char*)g_comm_handle->rx_buffer);
-            
-            // 清空缓冲区
-            g_comm_handle->rx_index = 0;
-            memset(g_comm_handle->rx_buffer, 0, RX_BUFFER_SIZE);
-        }
+    uint16_t pos = g_comm_handle->rx_dma_pos;
+    if (Size > pos) {
+        Communication_RxStore(&g_comm_handle->rx_dma_buffer[pos], Size - pos);
     }
-    else if (received_char == '\b' || received_char == 127) { // 退格键
-        if (g_comm_handle->rx_index > 0) {
-            g_comm_handle->rx_index--;
-        }
+    else if (Size < pos) {
+        // DMA已回绕
+        Communication_RxStore(&g_comm_handle->rx_dma_buffer[pos], RX_DMA_SIZE - pos);
+        Communication_RxStore(&g_comm_handle->rx_dma_buffer[0], Size);
     }
-    else if (g_comm_handle->rx_index < RX_BUFFER_SIZE - 1) {
-        g_comm_handle->rx_index++;
-    }
-    else {
-        // 缓冲区满，清空
-        g_comm_handle->rx_index = 0;
-        memset(g_comm_handle->rx_buffer, 0, RX_BUFFER_SIZE);
-        Communication_SendString("缓冲区已满，已清空\r\n");
+    g_comm_handle->rx_dma_pos = (Size >= RX_DMA_SIZE) ? 0 : Size;
+}
+
+// UART发送完成回调：释放已发送的数据，继续发送缓冲区中剩余部分
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (g_comm_handle == NULL || huart != g_comm_handle->huart) {
+        return;
     }
     
-    // 继续接收
-    HAL_UART_Receive_IT(huart, &g_comm_handle->rx_buffer[g_comm_handle->rx_index], 1);
+    RingBuf_Skip(&g_comm_handle->tx_ring, g_comm_handle->tx_dma_len);
+    g_comm_handle->tx_busy = 0;
+    Communication_StartTx();
 }
 
 // UART错误回调
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
     if (g_comm_handle != NULL && huart == g_comm_handle->huart) {
-        // 清除错误标志并重新启动接收
-        __HAL_UART_CLEAR_FLAG(huart, UART_FLAG_ORE);
-        HAL_UART_Receive_IT(huart, &g_comm_handle->rx_buffer[g_comm_handle->rx_index], 1);
+        // DMA发送出错时丢弃这一段，继续发送后面的数据
+        if (g_comm_handle->tx_busy && (huart->ErrorCode & HAL_UART_ERROR_DMA)) {
+            RingBuf_Skip(&g_comm_handle->tx_ring, g_comm_handle->tx_dma_len);
+            g_comm_handle->tx_busy = 0;
+            Communication_StartTx();
+        }
+        
+        // 接收出错时HAL已停止DMA接收：清除错误标志，从缓冲区起点重新启动
+        // （已组装的半行保留，由后续的回车或溢出处理）
+        if (huart->RxState == HAL_UART_STATE_READY) {
+            __HAL_UART_CLEAR_FLAG(huart, UART_FLAG_ORE);
+            g_comm_handle->rx_dma_pos = 0;
+            HAL_UARTEx_ReceiveToIdle_DMA(huart, g_comm_handle->rx_dma_buffer, RX_DMA_SIZE);
+        }
     }
 }
\ No newline at end of file
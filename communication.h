@@ -2,49 +2,57 @@
 #define COMMUNICATION_H
 
 #include "stm32f1xx_hal.h"
-#include "pid.h"
+#include "control.h"
+#include "attitude.h"
+#include "command.h"
+#include "ringbuf.h"
+#include "telemetry.h"
 
-// 通信缓冲区大小
-#define RX_BUFFER_SIZE 64
-#define TX_BUFFER_SIZE 128
-
-// 命令类型定义
-typedef enum {
-    CMD_NONE = 0,
-    CMD_SET_KP,
-    CMD_SET_KI,
-    CMD_SET_KD,
-    CMD_SET_ANGLE,
-    CMD_GET_STATUS,
-    CMD_RESET
-} CommandType;
+// 通信缓冲区大小（环形缓冲区必须是2的幂）
+#define RX_BUFFER_SIZE 64       // 命令行组装缓冲区
+#define RX_DMA_SIZE    64       // 循环DMA接收缓冲区
+#define RX_RING_SIZE   128      // 接收环形缓冲区
+#define TX_BUFFER_SIZE 1024     // 发送环形缓冲区（容纳遥测帧和一次完整的"get profile"输出）
 
 // 通信控制器结构体
 typedef struct {
     UART_HandleTypeDef *huart;      // UART句柄
     
-    // 接收缓冲区
+    // 接收：循环DMA写入rx_dma_buffer，接收事件中断把新数据移入环形缓冲区，主循环取出组装命令行
+    uint8_t rx_dma_buffer[RX_DMA_SIZE];
+    uint16_t rx_dma_pos;            // 上次接收事件时的DMA写入位置
+    uint8_t rx_ring_buffer[RX_RING_SIZE];
+    RingBuf_HandleTypeDef rx_ring;
+    uint32_t rx_dropped;            // 环形缓冲区满而丢弃的字节数
     uint8_t rx_buffer[RX_BUFFER_SIZE];
     uint16_t rx_index;
     
-    // 发送缓冲区
+    // 发送环形缓冲区：主循环写入，DMA从中直接发送，发送完成中断释放
     uint8_t tx_buffer[TX_BUFFER_SIZE];
+    RingBuf_HandleTypeDef tx_ring;
+    volatile uint8_t tx_busy;       // DMA发送进行中
+    uint16_t tx_dma_len;            // 本次DMA发送的字节数
+    uint16_t tx_seq;                // 遥测帧序号
+    uint32_t tx_dropped;            // 缓冲区满而丢弃的消息数
     
-    // 命令处理
-    CommandType current_cmd;
-    float cmd_value;
+    // 命令处理：当前命令处理完（type回到CMD_NONE）才组装下一行
+    Command_TypeDef command;
     
 } Communication_HandleTypeDef;
 
 // 函数声明
 void Communication_Init(Communication_HandleTypeDef *hcomm, UART_HandleTypeDef *huart);
-void Communication_SendData(float angle, float output);
+void Communication_SendTelemetry(const Telemetry_SampleTypeDef *sample);
 void Communication_SendString(const char *str);
+void Communication_SendFrame(const uint8_t *frame, uint16_t len);
+uint16_t Communication_TxFree(void);
+void Communication_Poll(void);
 uint8_t Communication_HasCommand(void);
-void Communication_ProcessCommand(PID_HandleTypeDef *hpid, float *target_angle);
+void Communication_ProcessCommand(Control_HandleTypeDef *hctrl, Attitude_HandleTypeDef *hatt);
 
 // 中断回调函数
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
 
 #endif
\ No newline at end of file
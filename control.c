@@ -0,0 +1,165 @@
+#include "control.h"
+#include <math.h>
+
+// 每个外环的分频数
+#define VELOCITY_DIV (CONTROL_RATE_HZ / VELOCITY_RATE_HZ)
+#define STEERING_DIV (CONTROL_RATE_HZ / STEERING_RATE_HZ)
+
+// 状态名称（"get status"回报用）
+static const char *const control_state_names[CONTROL_STATE_COUNT] = {
+    "idle", "calibrating", "balancing", "fallen", "recovering", "low_battery"
+};
+
+// 串级控制器初始化
+void Control_Init(Control_HandleTypeDef *hctrl, Motor_HandleTypeDef *hmotor) {
+    hctrl->hmotor = hmotor;
+    
+    PID_Init(&hctrl->angle, PID_KP, PID_KI, PID_KD);
+    
+    PID_Init(&hctrl->velocity, VELOCITY_KP, VELOCITY_KI, 0.0f);
+    PID_SetLimits(&hctrl->velocity, -VELOCITY_MAX_ANGLE, VELOCITY_MAX_ANGLE);
+    
+    PID_Init(&hctrl->steering, STEERING_KP, STEERING_KI, 0.0f);
+    PID_SetLimits(&hctrl->steering, -STEERING_MAX_OUTPUT, STEERING_MAX_OUTPUT);
+    
+    hctrl->target_angle = 0.0f;
+    hctrl->target_speed = 0.0f;
+    hctrl->target_turn = 0.0f;
+    
+    hctrl->state = CONTROL_IDLE;
+    hctrl->state_time = 0.0f;
+    
+    Control_Reset(hctrl);
+}
+
+// 重置三个环的状态
+void Control_Reset(Control_HandleTypeDef *hctrl) {
+    PID_Reset(&hctrl->angle);
+    PID_Reset(&hctrl->velocity);
+    PID_Reset(&hctrl->steering);
+    
+    hctrl->speed = 0.0f;
+    hctrl->turn = 0.0f;
+    hctrl->angle_offset = 0.0f;
+    hctrl->balance_output = 0.0f;
+    hctrl->steering_output = 0.0f;
+    
+    hctrl->velocity_counter = 0;
+    hctrl->steering_counter = 0;
+    hctrl->velocity_dt = 0.0f;
+    hctrl->steering_dt = 0.0f;
+}
+
+// 速度环：左右轮平均速度折算为直立环的目标角偏移
+// 车体要先向后仰才能减速，因此前进快于目标时目标角向后仰方向（正方向）调整，与速度误差反号
+static void Control_Velocity(Control_HandleTypeDef *hctrl) {
+    hctrl->speed = 0.5f * (Motor_GetVelocityLeft(hctrl->hmotor) + Motor_GetVelocityRight(hctrl->hmotor));
+    hctrl->angle_offset = -PID_CalculateDt(&hctrl->velocity, hctrl->target_speed, hctrl->speed, hctrl->velocity_dt);
+}
+
+// 转向环：左右轮速差跟踪目标转向
+static void Control_Steering(Control_HandleTypeDef *hctrl) {
+    hctrl->turn = Motor_GetVelocityRight(hctrl->hmotor) - Motor_GetVelocityLeft(hctrl->hmotor);
+    hctrl->steering_output = PID_CalculateDt(&hctrl->steering, hctrl->target_turn, hctrl->turn, hctrl->steering_dt);
+}
+
+// 停止输出：电机停止，各环状态清零
+static void Control_Halt(Control_HandleTypeDef *hctrl, Control_StateTypeDef state) {
+    Motor_Stop(hctrl->hmotor);
+    Control_Reset(hctrl);
+    hctrl->state = state;
+}
+
+// 状态转换，返回1时本周期运行串级控制
+static uint8_t Control_UpdateState(Control_HandleTypeDef *hctrl, float angle, float dt) {
+    float tilt = fabsf(angle - hctrl->target_angle);
+    
+    switch (hctrl->state) {
+        case CONTROL_BALANCING:
+            if (tilt > (float)MAX_ANGLE) {
+                Control_Halt(hctrl, CONTROL_FALLEN);
+                return 0;
+            }
+            return 1;
+            
+        case CONTROL_FALLEN:
+            if (tilt <= (float)RECOVER_ANGLE) {
+                hctrl->state = CONTROL_RECOVERING;
+                hctrl->state_time = 0.0f;
+            }
+            return 0;
+            
+        case CONTROL_RECOVERING:
+            if (tilt > (float)RECOVER_ANGLE) {
+                hctrl->state = CONTROL_FALLEN;
+                return 0;
+            }
+            hctrl->state_time += dt;
+            if (hctrl->state_time < RECOVER_TIME_MS * 0.001f) {
+                return 0;
+            }
+            // 扶起期间的轮速和外环状态不带入平衡
+            Control_Reset(hctrl);
+            hctrl->state = CONTROL_BALANCING;
+            return 1;
+            
+        default:
+            // IDLE/CALIBRATING/LOW_BATTERY：上电、校准结束或电压恢复后，车体接近平衡点时立即开始，否则按倒地处理
+            if (tilt <= (float)RECOVER_ANGLE) {
+                Control_Reset(hctrl);
+                hctrl->state = CONTROL_BALANCING;
+                return 1;
+            }
+            Control_Halt(hctrl, CONTROL_FALLEN);
+            return 0;
+    }
+}
+
+// 串级控制（控制中断中调用，dt为本周期时间，单位秒；轮速由调用者先用Motor_UpdateEncoders更新）
+// 先判断运行状态，倒地和扶起等待期间电机不输出
+void Control_Step(Control_HandleTypeDef *hctrl, float angle, float dt) {
+    if (!Control_UpdateState(hctrl, angle, dt)) {
+        return;
+    }
+    
+    hctrl->velocity_dt += dt;
+    hctrl->steering_dt += dt;
+    
+    if (++hctrl->velocity_counter >= VELOCITY_DIV) {
+        Control_Velocity(hctrl);
+        hctrl->velocity_counter = 0;
+        hctrl->velocity_dt = 0.0f;
+    }
+    
+    if (++hctrl->steering_counter >= STEERING_DIV) {
+        Control_Steering(hctrl);
+        hctrl->steering_counter = 0;
+        hctrl->steering_dt = 0.0f;
+    }
+    
+    // 直立环
+    hctrl->balance_output = PID_CalculateDt(&hctrl->angle, hctrl->target_angle + hctrl->angle_offset, angle, dt);
+    
+    // 差速输出：转向为正时右轮加速、左轮减速
+    Motor_Drive(hctrl->hmotor, hctrl->balance_output - hctrl->steering_output,
+                hctrl->balance_output + hctrl->steering_output);
+}
+
+// 校准（CONTROL_CALIBRATING）或欠压（CONTROL_LOW_BATTERY）期间代替Control_Step调用：
+// 电机停止，恢复后的第一个周期重新判断状态
+void Control_Suspend(Control_HandleTypeDef *hctrl, Control_StateTypeDef state) {
+    if (hctrl->state != state) {
+        Control_Halt(hctrl, state);
+    }
+    Motor_Stop(hctrl->hmotor);
+}
+
+// 当前运行状态（主循环读取）
+Control_StateTypeDef Control_GetState(Control_HandleTypeDef *hctrl) {
+    return hctrl->state;
+}
+
+// 状态名称
+const char *Control_GetStateName(Control_StateTypeDef state) {
+    return (state < CONTROL_STATE_COUNT) ? control_state_names[state] : "unknown";
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include "stm32f1xx_hal.h"
+#include "parameters.h"
+#include "pid.h"
+#include "motor.h"
+
+// 运行状态
+//
+// 由Control_Step在每个控制周期判断（几次比较，不增加可见开销）：
+//   IDLE        上电或校准结束，下一周期按倾角进入BALANCING（在RECOVER_ANGLE以内）或FALLEN
+//   CALIBRATING 校准进行中（Control_Suspend），电机不输出
+//   BALANCING   串级控制运行；倾角与目标角相差超过MAX_ANGLE时进入FALLEN
+//   FALLEN      电机停止，各环状态清零（积分不再累积）；扶起到RECOVER_ANGLE以内进入RECOVERING
+//   RECOVERING  电机仍不输出，保持RECOVER_TIME_MS后进入BALANCING；其间超出RECOVER_ANGLE回到FALLEN
+//   LOW_BATTERY 电池欠压（Control_Suspend），电机不输出；电压恢复后与IDLE相同地重新判断
+typedef enum {
+    CONTROL_IDLE = 0,
+    CONTROL_CALIBRATING,
+    CONTROL_BALANCING,
+    CONTROL_FALLEN,
+    CONTROL_RECOVERING,
+    CONTROL_LOW_BATTERY,
+    CONTROL_STATE_COUNT
+} Control_StateTypeDef;
+
+// 串级控制器结构体
+//
+// 直立环（角度PID）每个控制周期运行；速度环（PI）和转向环按VELOCITY_RATE_HZ/STEERING_RATE_HZ分频运行，
+// 两者都使用电机模块测得的轮速。速度环输出直立环的目标角偏移，转向环输出左右轮差速。
+typedef struct {
+    Motor_HandleTypeDef *hmotor;    // 电机句柄（输出和编码器）
+    
+    PID_HandleTypeDef angle;        // 直立环
+    PID_HandleTypeDef velocity;     // 速度环
+    PID_HandleTypeDef steering;     // 转向环
+    
+    // 目标值（可由串口命令修改）
+    float target_angle;             // 机械平衡角（度）
+    float target_speed;             // 目标速度（车轮转/秒，前进为正）
+    float target_turn;              // 目标转向（右轮减左轮，转/秒）
+    
+    // 各环最近一次的结果
+    float speed;                    // 左右轮平均速度（转/秒）
+    float turn;                     // 左右轮速差（转/秒）
+    float angle_offset;             // 速度环给出的目标角偏移（度）
+    float balance_output;           // 直立环输出（控制输出单位）
+    float steering_output;          // 转向环差速输出（控制输出单位）
+    
+    // 分频计数，以及各外环自上次运行以来的时间
+    uint16_t velocity_counter;
+    uint16_t steering_counter;
+    float velocity_dt;
+    float steering_dt;
+    
+    // 运行状态，以及进入RECOVERING以来的时间（秒）
+    Control_StateTypeDef state;
+    float state_time;
+    
+} Control_HandleTypeDef;
+
+// 函数声明
+void Control_Init(Control_HandleTypeDef *hctrl, Motor_HandleTypeDef *hmotor);
+void Control_Reset(Control_HandleTypeDef *hctrl);
+void Control_Step(Control_HandleTypeDef *hctrl, float angle, float dt);
+void Control_Suspend(Control_HandleTypeDef *hctrl, Control_StateTypeDef state);
+Control_StateTypeDef Control_GetState(Control_HandleTypeDef *hctrl);
+const char *Control_GetStateName(Control_StateTypeDef state);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "crc16.h"
+
+// 半字节查表：16项表只占32字节，每字节两次查表
+static const uint16_t crc16_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// 在已有CRC基础上继续计算（分段数据）
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ crc16_table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc16_table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+// 计算一段数据的CRC
+uint16_t CRC16_Compute(const uint8_t *data, uint16_t len) {
+    return CRC16_Update(CRC16_INIT, data, len);
+}
@@ -0,0 +1,12 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE（多项式0x1021，初值0xFFFF，不反转）
+#define CRC16_INIT 0xFFFFU
+
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t len);
+uint16_t CRC16_Compute(const uint8_t *data, uint16_t len);
+
+#endif
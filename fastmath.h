@@ -0,0 +1,68 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <stdint.h>
+#include <string.h>
+
+// 单精度快速数学函数（Cortex-M3无FPU，避免double软件库）
+//
+// FastMath_Atan2：多项式逼近（Abramowitz & Stegun 4.4.49），最大误差约1e-5 rad（0.0006°）
+// FastMath_InvSqrt：位级初值 + 两次牛顿迭代，最大相对误差约5e-6
+
+#define FASTMATH_PI      3.14159265f
+#define FASTMATH_PI_2    1.57079633f
+
+// 单精度绝对值（不调用fabs，避免提升为double）
+static inline float FastMath_Abs(float x) {
+    return x < 0.0f ? -x : x;
+}
+
+// 四象限反正切，返回值范围 [-π, π]；x、y同时为0时返回0
+static inline float FastMath_Atan2(float y, float x) {
+    float ax = FastMath_Abs(x);
+    float ay = FastMath_Abs(y);
+    float mx = ax > ay ? ax : ay;
+    float mn = ax > ay ? ay : ax;
+
+    if (mx == 0.0f) {
+        return 0.0f;
+    }
+
+    // 先在 [0, 1] 上逼近 atan(mn/mx)，再按象限展开
+    float a = mn / mx;
+    float s = a * a;
+    float r = ((((0.0208351f * s - 0.0851330f) * s + 0.1801410f) * s - 0.3302995f) * s + 0.9998660f) * a;
+
+    if (ay > ax) {
+        r = FASTMATH_PI_2 - r;
+    }
+    if (x < 0.0f) {
+        r = FASTMATH_PI - r;
+    }
+    return y < 0.0f ? -r : r;
+}
+
+// 平方根倒数，x <= 0 时返回0
+static inline float FastMath_InvSqrt(float x) {
+    if (x <= 0.0f) {
+        return 0.0f;
+    }
+
+    float half = 0.5f * x;
+    float y;
+    uint32_t i;
+    memcpy(&i, &x, sizeof(i));
+    i = 0x5F375A86U - (i >> 1);
+    memcpy(&y, &i, sizeof(y));
+
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    return y;
+}
+
+// 平方根（x * 1/√x）
+static inline float FastMath_Sqrt(float x) {
+    return x * FastMath_InvSqrt(x);
+}
+
+#endif
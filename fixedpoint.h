@@ -0,0 +1,111 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// 定点数辅助函数（CONTROL_FIXED_POINT=1 时卡尔曼滤波和PID使用）
+//
+// 格式记为 Qm.n：n为小数位数，值 = 整数 / 2^n
+//   Q16.16：角度（度）、角速度（度/秒）、PID增益与输出，范围 ±32768，分辨率1.5e-5
+//   Q2.30 ：协方差、卡尔曼增益、dt（秒），范围 ±2，分辨率9.3e-10
+// 乘法用64位中间结果并四舍五入，所有结果饱和到int32范围而不是回绕
+// 与浮点之间的转换只用整数运算（无FPU时不经过软件浮点库），只在模块接口处进行
+
+#define FIXED_Q16   16
+#define FIXED_Q30   30
+
+// 64位结果饱和到int32
+static inline int32_t Fixed_Sat(int64_t x) {
+    if (x > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (x < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)x;
+}
+
+// 饱和加法
+static inline int32_t Fixed_Add(int32_t a, int32_t b) {
+    return Fixed_Sat((int64_t)a + b);
+}
+
+// 饱和减法
+static inline int32_t Fixed_Sub(int32_t a, int32_t b) {
+    return Fixed_Sat((int64_t)a - b);
+}
+
+// 饱和乘法：结果小数位数 = a的小数位数 + b的小数位数 - shift
+static inline int32_t Fixed_Mul(int32_t a, int32_t b, int shift) {
+    return Fixed_Sat(((int64_t)a * b + ((int64_t)1 << (shift - 1))) >> shift);
+}
+
+// 浮点转定点（四舍五入，超出范围时饱和，NaN返回0）
+// 直接拆分IEEE-754位域，只用整数移位：Cortex-M3上不调用软件浮点库的乘法、比较和转换函数
+static inline int32_t Fixed_FromFloat(float x, int q) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    uint32_t exponent = (bits >> 23) & 0xFFU;
+    uint32_t negative = bits >> 31;
+    
+    if (exponent == 0xFFU) {
+        if (bits & 0x7FFFFFU) {
+            return 0;
+        }
+        return negative ? INT32_MIN : INT32_MAX;
+    }
+    if (exponent == 0) {
+        return 0;   // 0和非规格化数（远小于任何定点格式的分辨率）
+    }
+    
+    // |x| = mantissa × 2^(exponent-150)，定点值 = mantissa × 2^shift
+    uint32_t mantissa = (bits & 0x7FFFFFU) | 0x800000U;
+    int shift = (int)exponent - 150 + q;
+    uint32_t magnitude;
+    if (shift >= 8) {
+        return negative ? INT32_MIN : INT32_MAX;   // |x| × 2^q ≥ 2^31
+    } else if (shift >= 0) {
+        magnitude = mantissa << shift;
+    } else if (shift >= -24) {
+        magnitude = (mantissa + (1U << (-shift - 1))) >> -shift;
+    } else {
+        return 0;
+    }
+    return negative ? -(int32_t)magnitude : (int32_t)magnitude;
+}
+
+// 定点转浮点（与 (float)x / 2^q 结果相同，就近舍入到偶数）
+// 用CLZ求最高位后直接拼出位域，同样不调用软件浮点库
+static inline float Fixed_ToFloat(int32_t x, int q) {
+    if (x == 0) {
+        return 0.0f;
+    }
+    uint32_t sign = (x < 0) ? 0x80000000U : 0U;
+    uint32_t magnitude = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+    int msb = 31 - __builtin_clz(magnitude);
+    int exponent = msb - q + 127;
+    uint32_t mantissa;
+    
+    if (msb > 23) {
+        int shift = msb - 23;
+        uint32_t rest = magnitude & ((1U << shift) - 1U);
+        uint32_t half = 1U << (shift - 1);
+        mantissa = magnitude >> shift;
+        if (rest > half || (rest == half && (mantissa & 1U))) {
+            if (++mantissa == 0x1000000U) {
+                mantissa >>= 1;
+                exponent++;
+            }
+        }
+    } else {
+        mantissa = magnitude << (23 - msb);
+    }
+    
+    uint32_t bits = sign | ((uint32_t)exponent << 23) | (mantissa & 0x7FFFFFU);
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+#endif
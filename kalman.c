@@ -1,12 +1,252 @@
 #include "kalman.h"
 #include "stm32f1xx_hal.h"
+#include "fixedpoint.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KALMAN_SS_MAX_ITER  20000   // 求稳态增益的最大迭代次数
+#define KALMAN_SS_EPSILON   1e-7f   // 相邻两次迭代的增益之差小于该值视为收敛
+#define KALMAN_SS_REENTRY   1e-4f   // 退回完整递推后，增益与稳态值之差小于该值时重新使用稳态增益
+
+// 求稳态增益：以标称周期从P=0开始迭代协方差递推，直到增益不再变化（初始化时调用一次，
+// 200Hz约560次迭代，1kHz约2000次；修改Q/R时再调用）。P为更新后的协方差
+static void Kalman_SolveSteadyState(float dt, float q_angle, float q_gyro, float r_angle, float P[2][2], float K[2]) {
+    float p00 = 0.0f, p01 = 0.0f, p10 = 0.0f, p11 = 0.0f;
+    float k0 = 0.0f, k1 = 0.0f;
+    
+    for (uint32_t i = 0; i < KALMAN_SS_MAX_ITER; i++) {
+        p00 += dt * (dt * p11 - p01 - p10 + q_angle);
+        p01 -= dt * p11;
+        p10 -= dt * p11;
+        p11 += q_gyro * dt;
+        
+        float S = p00 + r_angle;
+        float n0 = p00 / S;
+        float n1 = p10 / S;
+        float P00_temp = p00;
+        float P01_temp = p01;
+        p00 -= n0 * P00_temp;
+        p01 -= n0 * P01_temp;
+        p10 -= n1 * P00_temp;
+        p11 -= n1 * P01_temp;
+        
+        uint8_t converged = (i > 0 && fabsf(n0 - k0) < KALMAN_SS_EPSILON && fabsf(n1 - k1) < KALMAN_SS_EPSILON);
+        k0 = n0;
+        k1 = n1;
+        if (converged) {
+            break;
+        }
+    }
+    
+    P[0][0] = p00;
+    P[0][1] = p01;
+    P[1][0] = p10;
+    P[1][1] = p11;
+    K[0] = k0;
+    K[1] = k1;
+}
+
+// 卡尔曼滤波更新（以HAL_GetTick计算dt，分辨率1ms）
+float Kalman_Update(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate) {
+    uint32_t current_time = HAL_GetTick();
+    float dt = (current_time - hkalman->last_time) / 1000.0f; // 转换为秒
+    
+    if (dt <= 0) {
+        return Kalman_GetAngle(hkalman); // 时间未变化，返回上次估计
+    }
+    
+    hkalman->last_time = current_time;
+    return Kalman_UpdateDt(hkalman, newAngle, newRate, dt);
+}
+
+#if CONTROL_FIXED_POINT
+// 写入噪声协方差
+static void Kalman_LoadNoise(Kalman_HandleTypeDef *hkalman, float q_angle, float q_gyro, float r_angle) {
+    hkalman->Q_angle = Fixed_FromFloat(q_angle, FIXED_Q30);
+    hkalman->Q_gyro = Fixed_FromFloat(q_gyro, FIXED_Q30);
+    hkalman->R_angle = Fixed_FromFloat(r_angle, FIXED_Q30);
+}
+
+// 写入求出的稳态增益和协方差，P直接从稳态值开始（调用者保证与控制中断互斥）
+static void Kalman_LoadSteadyState(Kalman_HandleTypeDef *hkalman, float dt, float P[2][2], float K[2]) {
+    for (uint8_t i = 0; i < 2; i++) {
+        hkalman->K_ss[i] = Fixed_FromFloat(K[i], FIXED_Q30);
+        hkalman->K[i] = hkalman->K_ss[i];
+        for (uint8_t j = 0; j < 2; j++) {
+            hkalman->P_ss[i][j] = Fixed_FromFloat(P[i][j], FIXED_Q30);
+            hkalman->P[i][j] = hkalman->P_ss[i][j];
+        }
+    }
+    hkalman->dt_min = Fixed_FromFloat(dt * (1.0f - (float)KALMAN_SS_DT_TOLERANCE), FIXED_Q30);
+    hkalman->dt_max = Fixed_FromFloat(dt * (1.0f + (float)KALMAN_SS_DT_TOLERANCE), FIXED_Q30);
+    hkalman->steady_state = 1;
+    hkalman->converged = 1;
+}
+
+// 卡尔曼滤波器初始化
+void Kalman_Init(Kalman_HandleTypeDef *hkalman) {
+    Kalman_LoadNoise(hkalman, Q_ANGLE, Q_GYRO, R_ANGLE);
+    
+    hkalman->angle = 0;
+    hkalman->bias = 0;
+    hkalman->rate = 0;
+    
+    // 初始化误差协方差矩阵
+    hkalman->P[0][0] = 0;
+    hkalman->P[0][1] = 0;
+    hkalman->P[1][0] = 0;
+    hkalman->P[1][1] = 0;
+    
+    Kalman_SetSteadyState(hkalman, KALMAN_STEADY_STATE);
+    hkalman->last_time = HAL_GetTick();
+}
+
+// 稳态增益模式：开启时求出标称周期下的稳态增益和协方差，P直接从稳态值开始
+void Kalman_SetSteadyState(Kalman_HandleTypeDef *hkalman, uint8_t enable) {
+    hkalman->steady_state = 0;
+    hkalman->converged = 0;
+    if (!enable) {
+        return;
+    }
+    
+    float dt = 1.0f / CONTROL_RATE_HZ;
+    float P[2][2], K[2];
+    Kalman_SolveSteadyState(dt, Fixed_ToFloat(hkalman->Q_angle, FIXED_Q30), Fixed_ToFloat(hkalman->Q_gyro, FIXED_Q30),
+                            Fixed_ToFloat(hkalman->R_angle, FIXED_Q30), P, K);
+    Kalman_LoadSteadyState(hkalman, dt, P, K);
+}
+
+// 卡尔曼滤波更新（定点版本，dt由调用者在采样时刻给出，单位秒）
+// 浮点接口只在入口和出口各做一次整数位域转换，滤波本身在Kalman_UpdateQ中全部为定点运算
+float Kalman_UpdateDt(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate, float dt) {
+    return Fixed_ToFloat(Kalman_UpdateQ(hkalman, Fixed_FromFloat(newAngle, FIXED_Q16),
+                                        Fixed_FromFloat(newRate, FIXED_Q16), Fixed_FromFloat(dt, FIXED_Q30)),
+                         FIXED_Q16);
+}
+
+// 卡尔曼滤波更新（角度、角速度Q16.16，dt为Q2.30秒），返回Q16.16角度
+// 稳态增益时只有乘加；完整递推只有一次64位除法（1/S），其余为32x32→64位乘法，不经过软件浮点库
+int32_t Kalman_UpdateQ(Kalman_HandleTypeDef *hkalman, int32_t angle_meas, int32_t rate_meas, int32_t dt_q) {
+    if (dt_q <= 0) {
+        return hkalman->angle;
+    }
+    
+    // 预测步骤
+    hkalman->rate = Fixed_Sub(rate_meas, hkalman->bias);
+    hkalman->angle = Fixed_Add(hkalman->angle, Fixed_Mul(dt_q, hkalman->rate, FIXED_Q30));
+    
+    // 稳态增益：dt接近标称周期时P保持稳态值，只需两次乘加
+    if (hkalman->converged) {
+        if (dt_q >= hkalman->dt_min && dt_q <= hkalman->dt_max) {
+            hkalman->y = Fixed_Sub(angle_meas, hkalman->angle);
+            hkalman->angle = Fixed_Add(hkalman->angle, Fixed_Mul(hkalman->K_ss[0], hkalman->y, FIXED_Q30));
+            hkalman->bias = Fixed_Add(hkalman->bias, Fixed_Mul(hkalman->K_ss[1], hkalman->y, FIXED_Q30));
+            return hkalman->angle;
+        }
+        hkalman->converged = 0;
+    }
+    
+    // 更新误差协方差矩阵
+    int32_t dt_P11 = Fixed_Mul(dt_q, hkalman->P[1][1], FIXED_Q30);
+    int32_t P00_rate = Fixed_Add(Fixed_Sub(Fixed_Sub(dt_P11, hkalman->P[0][1]), hkalman->P[1][0]), hkalman->Q_angle);
+    hkalman->P[0][0] = Fixed_Add(hkalman->P[0][0], Fixed_Mul(dt_q, P00_rate, FIXED_Q30));
+    hkalman->P[0][1] = Fixed_Sub(hkalman->P[0][1], dt_P11);
+    hkalman->P[1][0] = Fixed_Sub(hkalman->P[1][0], dt_P11);
+    hkalman->P[1][1] = Fixed_Add(hkalman->P[1][1], Fixed_Mul(hkalman->Q_gyro, dt_q, FIXED_Q30));
+    
+    // 计算卡尔曼增益：先求 1/S（Q24），两个增益都变成乘法
+    // S >= R_angle，R_angle不小于2^-8时 P×(1/S) 的64位中间结果不会溢出
+    hkalman->S = Fixed_Add(hkalman->P[0][0], hkalman->R_angle);
+    if (hkalman->S <= 0) {
+        return hkalman->angle;
+    }
+    int64_t inv_S = ((int64_t)1 << 54) / hkalman->S;
+    hkalman->K[0] = Fixed_Sat(((int64_t)hkalman->P[0][0] * inv_S + (1 << 23)) >> 24);
+    hkalman->K[1] = Fixed_Sat(((int64_t)hkalman->P[1][0] * inv_S + (1 << 23)) >> 24);
+    
+    // 计算角度差
+    hkalman->y = Fixed_Sub(angle_meas, hkalman->angle);
+    
+    // 更新估计
+    hkalman->angle = Fixed_Add(hkalman->angle, Fixed_Mul(hkalman->K[0], hkalman->y, FIXED_Q30));
+    hkalman->bias = Fixed_Add(hkalman->bias, Fixed_Mul(hkalman->K[1], hkalman->y, FIXED_Q30));
+    
+    // 更新误差协方差矩阵
+    int32_t P00_temp = hkalman->P[0][0];
+    int32_t P01_temp = hkalman->P[0][1];
+    
+    hkalman->P[0][0] = Fixed_Sub(hkalman->P[0][0], Fixed_Mul(hkalman->K[0], P00_temp, FIXED_Q30));
+    hkalman->P[0][1] = Fixed_Sub(hkalman->P[0][1], Fixed_Mul(hkalman->K[0], P01_temp, FIXED_Q30));
+    hkalman->P[1][0] = Fixed_Sub(hkalman->P[1][0], Fixed_Mul(hkalman->K[1], P00_temp, FIXED_Q30));
+    hkalman->P[1][1] = Fixed_Sub(hkalman->P[1][1], Fixed_Mul(hkalman->K[1], P01_temp, FIXED_Q30));
+    
+    // dt偏离后P需要若干周期重新收敛，增益回到稳态值附近后恢复稳态增益
+    const int32_t reentry = (int32_t)(KALMAN_SS_REENTRY * (1 << 30));
+    if (hkalman->steady_state && abs(hkalman->K[0] - hkalman->K_ss[0]) < reentry &&
+        abs(hkalman->K[1] - hkalman->K_ss[1]) < reentry) {
+        memcpy(hkalman->P, hkalman->P_ss, sizeof(hkalman->P));
+        hkalman->converged = 1;
+    }
+    
+    return hkalman->angle;
+}
+
+// 设置初始角度
+void Kalman_SetAngle(Kalman_HandleTypeDef *hkalman, float angle) {
+    hkalman->angle = Fixed_FromFloat(angle, FIXED_Q16);
+}
+
+// 获取无偏差的速率
+float Kalman_GetRate(Kalman_HandleTypeDef *hkalman) {
+    return Fixed_ToFloat(hkalman->rate, FIXED_Q16);
+}
+
+// 获取估计角度
+float Kalman_GetAngle(Kalman_HandleTypeDef *hkalman) {
+    return Fixed_ToFloat(hkalman->angle, FIXED_Q16);
+}
+
+// 获取陀螺仪零偏估计
+float Kalman_GetBias(Kalman_HandleTypeDef *hkalman) {
+    return Fixed_ToFloat(hkalman->bias, FIXED_Q16);
+}
+
+// 设置零偏估计（回放记录时作为初值）
+void Kalman_SetBias(Kalman_HandleTypeDef *hkalman, float bias) {
+    hkalman->bias = Fixed_FromFloat(bias, FIXED_Q16);
+}
+
+// 获取误差协方差矩阵对角元
+void Kalman_GetCovariance(Kalman_HandleTypeDef *hkalman, float *p00, float *p11) {
+    *p00 = Fixed_ToFloat(hkalman->P[0][0], FIXED_Q30);
+    *p11 = Fixed_ToFloat(hkalman->P[1][1], FIXED_Q30);
+}
+#else
+// 写入噪声协方差
+static void Kalman_LoadNoise(Kalman_HandleTypeDef *hkalman, float q_angle, float q_gyro, float r_angle) {
+    hkalman->Q_angle = q_angle;
+    hkalman->Q_gyro = q_gyro;
+    hkalman->R_angle = r_angle;
+}
+
+// 写入求出的稳态增益和协方差，P直接从稳态值开始（调用者保证与控制中断互斥）
+static void Kalman_LoadSteadyState(Kalman_HandleTypeDef *hkalman, float dt, float P[2][2], float K[2]) {
+    memcpy(hkalman->P_ss, P, sizeof(hkalman->P_ss));
+    hkalman->K_ss[0] = K[0];
+    hkalman->K_ss[1] = K[1];
+    memcpy(hkalman->P, hkalman->P_ss, sizeof(hkalman->P));
+    hkalman->K[0] = hkalman->K_ss[0];
+    hkalman->K[1] = hkalman->K_ss[1];
+    hkalman->dt_min = dt * (1.0f - (float)KALMAN_SS_DT_TOLERANCE);
+    hkalman->dt_max = dt * (1.0f + (float)KALMAN_SS_DT_TOLERANCE);
+    hkalman->steady_state = 1;
+    hkalman->converged = 1;
+}
 
 // 卡尔曼滤波器初始化
 void Kalman_Init(Kalman_HandleTypeDef *hkalman) {
-    hkalman->Q_angle = Q_ANGLE;
-    hkalman->Q_gyro = Q_GYRO;
-    hkalman->R_angle = R_ANGLE;
+    Kalman_LoadNoise(hkalman, Q_ANGLE, Q_GYRO, R_ANGLE);
     
     hkalman->angle = 0.0f;
     hkalman->bias = 0.0f;
@@ -18,24 +258,45 @@ void Kalman_Init(Kalman_HandleTypeDef *hkalman) {
     hkalman->P[1][0] = 0.0f;
     hkalman->P[1][1] = 0.0f;
     
+    Kalman_SetSteadyState(hkalman, KALMAN_STEADY_STATE);
     hkalman->last_time = HAL_GetTick();
 }
 
-// 卡尔曼滤波更新
-float Kalman_Update(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate) {
-    uint32_t current_time = HAL_GetTick();
-    float dt = (current_time - hkalman->last_time) / 1000.0f; // 转换为秒
+// 稳态增益模式：开启时求出标称周期下的稳态增益和协方差，P直接从稳态值开始
+void Kalman_SetSteadyState(Kalman_HandleTypeDef *hkalman, uint8_t enable) {
+    hkalman->steady_state = 0;
+    hkalman->converged = 0;
+    if (!enable) {
+        return;
+    }
     
+    float dt = 1.0f / CONTROL_RATE_HZ;
+    float P[2][2], K[2];
+    Kalman_SolveSteadyState(dt, hkalman->Q_angle, hkalman->Q_gyro, hkalman->R_angle, P, K);
+    Kalman_LoadSteadyState(hkalman, dt, P, K);
+}
+
+// 卡尔曼滤波更新（dt由调用者在采样时刻给出，单位秒）
+float Kalman_UpdateDt(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate, float dt) {
     if (dt <= 0) {
-        return hkalman->angle; // 时间未变化，返回上次估计
+        return hkalman->angle;
     }
     
-    hkalman->last_time = current_time;
-    
     // 预测步骤
     hkalman->rate = newRate - hkalman->bias;
     hkalman->angle += dt * hkalman->rate;
     
+    // 稳态增益：dt接近标称周期时P保持稳态值，只需两次乘加，没有除法
+    if (hkalman->converged) {
+        if (dt >= hkalman->dt_min && dt <= hkalman->dt_max) {
+            hkalman->y = newAngle - hkalman->angle;
+            hkalman->angle += hkalman->K_ss[0] * hkalman->y;
+            hkalman->bias += hkalman->K_ss[1] * hkalman->y;
+            return hkalman->angle;
+        }
+        hkalman->converged = 0;
+    }
+    
     // 更新误差协方差矩阵
     hkalman->P[0][0] += dt * (dt * hkalman->P[1][1] - hkalman->P[0][1] - hkalman->P[1][0] + hkalman->Q_angle);
     hkalman->P[0][1] -= dt * hkalman->P[1][1];
@@ -63,6 +324,13 @@ float Kalman_Update(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate
     hkalman->P[1][0] -= hkalman->K[1] * P00_temp;
     hkalman->P[1][1] -= hkalman->K[1] * P01_temp;
     
+    // dt偏离后P需要若干周期重新收敛，增益回到稳态值附近后恢复稳态增益
+    if (hkalman->steady_state && fabsf(hkalman->K[0] - hkalman->K_ss[0]) < KALMAN_SS_REENTRY &&
+        fabsf(hkalman->K[1] - hkalman->K_ss[1]) < KALMAN_SS_REENTRY) {
+        memcpy(hkalman->P, hkalman->P_ss, sizeof(hkalman->P));
+        hkalman->converged = 1;
+    }
+    
     return hkalman->angle;
 }
 
@@ -74,4 +342,44 @@ void Kalman_SetAngle(Kalman_HandleTypeDef *hkalman, float angle) {
 // 获取无偏差的速率
 float Kalman_GetRate(Kalman_HandleTypeDef *hkalman) {
     return hkalman->rate;
-}
\ No newline at end of file
+}
+
+// 获取估计角度
+float Kalman_GetAngle(Kalman_HandleTypeDef *hkalman) {
+    return hkalman->angle;
+}
+
+// 获取陀螺仪零偏估计
+float Kalman_GetBias(Kalman_HandleTypeDef *hkalman) {
+    return hkalman->bias;
+}
+
+// 设置零偏估计（回放记录时作为初值）
+void Kalman_SetBias(Kalman_HandleTypeDef *hkalman, float bias) {
+    hkalman->bias = bias;
+}
+
+// 获取误差协方差矩阵对角元
+void Kalman_GetCovariance(Kalman_HandleTypeDef *hkalman, float *p00, float *p11) {
+    *p00 = hkalman->P[0][0];
+    *p11 = hkalman->P[1][1];
+}
+#endif
+
+// 修改噪声协方差（主循环中调用）：稳态增益模式下先按新的Q/R求出稳态增益（200Hz约560次迭代），
+// 只有写入句柄的几行与控制中断互斥
+void Kalman_SetNoise(Kalman_HandleTypeDef *hkalman, float q_angle, float q_gyro, float r_angle) {
+    float dt = 1.0f / CONTROL_RATE_HZ;
+    float P[2][2], K[2];
+    uint8_t steady_state = hkalman->steady_state;
+    
+    if (steady_state) {
+        Kalman_SolveSteadyState(dt, q_angle, q_gyro, r_angle, P, K);
+    }
+    __disable_irq();
+    Kalman_LoadNoise(hkalman, q_angle, q_gyro, r_angle);
+    if (steady_state) {
+        Kalman_LoadSteadyState(hkalman, dt, P, K);
+    }
+    __enable_irq();
+}
@@ -4,6 +4,33 @@
 #include "stm32f1xx_hal.h"
 #include "parameters.h"
 
+#if CONTROL_FIXED_POINT
+// 卡尔曼滤波器结构体（定点版本：角度量为Q16.16，协方差与增益为Q2.30，见fixedpoint.h）
+typedef struct {
+    int32_t Q_angle;    // 过程噪声协方差（角度）
+    int32_t Q_gyro;     // 过程噪声协方差（陀螺仪）
+    int32_t R_angle;    // 测量噪声协方差
+    
+    int32_t angle;      // 估计角度
+    int32_t bias;       // 估计偏差
+    int32_t rate;       // 无偏差的速率
+    
+    int32_t P[2][2];    // 误差协方差矩阵
+    int32_t K[2];       // 卡尔曼增益
+    int32_t y;          // 角度差
+    int32_t S;          // 估计误差
+    
+    int32_t K_ss[2];    // 稳态卡尔曼增益
+    int32_t P_ss[2][2]; // 稳态误差协方差（更新后）
+    int32_t dt_min;     // dt（Q2.30）在[dt_min, dt_max]内时使用稳态增益
+    int32_t dt_max;
+    uint8_t steady_state; // 稳态增益模式
+    uint8_t converged;  // 当前P处于稳态值，使用稳态增益
+    
+    uint32_t last_time; // 上一次更新时间
+    
+} Kalman_HandleTypeDef;
+#else
 // 卡尔曼滤波器结构体
 typedef struct {
     float Q_angle;      // 过程噪声协方差（角度）
@@ -19,14 +46,33 @@ typedef struct {
     float y;            // 角度差
     float S;            // 估计误差
     
+    float K_ss[2];      // 稳态卡尔曼增益
+    float P_ss[2][2];   // 稳态误差协方差（更新后）
+    float dt_min;       // dt在[dt_min, dt_max]内时使用稳态增益
+    float dt_max;
+    uint8_t steady_state; // 稳态增益模式
+    uint8_t converged;  // 当前P处于稳态值，使用稳态增益
+    
     uint32_t last_time; // 上一次更新时间
     
 } Kalman_HandleTypeDef;
+#endif
 
-// 函数声明
+// 函数声明（两种数值格式接口相同，参数和返回值均为浮点）
+// 定点版本另有Kalman_UpdateQ：输入输出直接为定点数，调用者已有定点数据时不必来回转换
 void Kalman_Init(Kalman_HandleTypeDef *hkalman);
 float Kalman_Update(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate);
+float Kalman_UpdateDt(Kalman_HandleTypeDef *hkalman, float newAngle, float newRate, float dt);
+#if CONTROL_FIXED_POINT
+int32_t Kalman_UpdateQ(Kalman_HandleTypeDef *hkalman, int32_t angle_meas, int32_t rate_meas, int32_t dt_q);
+#endif
+void Kalman_SetSteadyState(Kalman_HandleTypeDef *hkalman, uint8_t enable);
+void Kalman_SetNoise(Kalman_HandleTypeDef *hkalman, float q_angle, float q_gyro, float r_angle);
 void Kalman_SetAngle(Kalman_HandleTypeDef *hkalman, float angle);
 float Kalman_GetRate(Kalman_HandleTypeDef *hkalman);
+float Kalman_GetAngle(Kalman_HandleTypeDef *hkalman);
+float Kalman_GetBias(Kalman_HandleTypeDef *hkalman);
+void Kalman_SetBias(Kalman_HandleTypeDef *hkalman, float bias);
+void Kalman_GetCovariance(Kalman_HandleTypeDef *hkalman, float *p00, float *p11);
 
 #endif
\ No newline at end of file
@@ -3,8 +3,16 @@
 #include "mpu6050.h"
 #include "pid.h"
 #include "motor.h"
-#include "kalman.h"
+#include "attitude.h"
+#include "control.h"
 #include "communication.h"
+#include "telemetry.h"
+#include "timebase.h"
+#include "profiler.h"
+#include "blackbox.h"
+#include "calibration.h"
+#include "paramstore.h"
+#include "battery.h"
 #include "pins.h"
 #include "parameters.h"
 
@@ -13,94 +21,243 @@ I2C_HandleTypeDef hi2c1;
 TIM_HandleTypeDef htim1;
 TIM_HandleTypeDef htim2;
 TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim4;
 UART_HandleTypeDef huart1;
+ADC_HandleTypeDef hadc1;
 
 MPU6050_HandleTypeDef hmpu;
-PID_HandleTypeDef hpid;
 Motor_HandleTypeDef hmotor;
-Kalman_HandleTypeDef hkalman;
+Control_HandleTypeDef hcontrol;
+Attitude_HandleTypeDef hattitude;
+Communication_HandleTypeDef hcomm;
 
-// 控制变量
-float targetAngle = 0.0f;  // 目标平衡角度
+// 控制变量（在TIM4中断中更新）
 float currentAngle = 0.0f; // 当前角度
-float output = 0.0f;       // PID输出
+uint32_t sampleCycles = 0; // 上次传感器采样时刻（DWT周期）
 
-uint32_t lastTime = 0;
-const uint32_t sampleTime = 10; // 10ms采样周期
+// 遥测数据快照：主循环取走上一帧（telemetryPending清零）后控制中断才写入下一帧
+volatile uint8_t telemetryPending = 0;
+Telemetry_SampleTypeDef telemetrySample;
+static uint16_t telemetryCounter = 0;
+
+// 控制状态变化时的提示（NULL为不提示，校准过程由校准模块自己回报）
+static const char *const stateMessages[CONTROL_STATE_COUNT] = {
+  NULL,
+  NULL,
+  "开始平衡\r\n",
+  "倒地，电机已停止\r\n",
+  "已扶起，保持静止后重新平衡\r\n",
+  "电池电压过低，电机已停止\r\n"
+};
 
 // 系统时钟配置
 void SystemClock_Config(void);
 
 // 外设初始化
 void MX_GPIO_Init(void);
+void MX_DMA_Init(void);
+void MX_ADC1_Init(void);
 void MX_I2C1_Init(void);
 void MX_TIM1_Init(void);
 void MX_TIM2_Init(void);
 void MX_TIM3_Init(void);
+void MX_TIM4_Init(void);
 void MX_USART1_UART_Init(void);
 
+static void Control_Loop(void);
+
 int main(void) {
   // HAL库初始化
   HAL_Init();
   SystemClock_Config();
+  Timebase_Init();
   
   // 外设初始化
   MX_GPIO_Init();
+  MX_DMA_Init();
+  MX_ADC1_Init();
   MX_I2C1_Init();
   MX_TIM1_Init();
   MX_TIM2_Init();
   MX_TIM3_Init();
+  MX_TIM4_Init();
   MX_USART1_UART_Init();
   
   // 启动PWM和编码器
-  HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
-  HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2);
+  HAL_TIM_PWM_Start(&htim1, MOTOR_A_CHANNEL);
+  HAL_TIM_PWM_Start(&htim1, MOTOR_B_CHANNEL);
   HAL_TIM_Encoder_Start(&htim2, TIM_CHANNEL_ALL);
   HAL_TIM_Encoder_Start(&htim3, TIM_CHANNEL_ALL);
   
   // 初始化各模块
   MPU6050_Init(&hmpu, &hi2c1);
-  PID_Init(&hpid, PID_KP, PID_KI, PID_KD);
   Motor_Init(&hmotor, &htim1);
-  Kalman_Init(&hkalman);
-  Communication_Init(&huart1);
+  Control_Init(&hcontrol, &hmotor);
+  Attitude_Init(&hattitude, (Attitude_FilterTypeDef)ATTITUDE_FILTER);
+  Communication_Init(&hcomm, &huart1);
+  
+  // 电池电压：ADC连续转换由DMA循环搬运，控制中断中只读取缓冲区
+  Battery_Init(&hadc1);
+  
+  // 校准值从闪存载入（几微秒）；无效或温度变化过大时在控制中断中重新校准陀螺仪，期间电机不输出
+  Calibration_Init(&hmpu);
+  hcontrol.target_angle = Calibration_Get()->mount_angle;
+  
+  // 保存过的PID增益、卡尔曼Q/R、死区、最大输出、目标角从闪存载入（约0.1ms），覆盖parameters.h中的值
+  ParamStore_Init(&hcontrol, &hattitude);
   
-  // 等待传感器稳定
-  HAL_Delay(1000);
+  // 滤波器从当前加速度计倾角开始，不必等待收敛
+  MPU6050_ReadData(&hmpu);
+  Attitude_SetAngle(&hattitude, hmpu.angleX);
   
   // 发送初始化完成信息
   Communication_SendString("STM32平衡小车初始化完成\r\n");
+  if (Calibration_IsActive()) {
+    Communication_SendString("正在校准陀螺仪，请保持车体静止\r\n");
+  }
+  
+  // 传感器改为中断触发的DMA读取（数据就绪或FIFO批量），控制循环只取最新样本
+  MPU6050_StartAsync(&hmpu);
+#if IMU_FIFO_MODE
+  HAL_TIM_OC_Start_IT(&htim4, TIM_CHANNEL_1);
+#endif
+  
+  // 启动控制定时器，此后平衡控制全部在TIM4中断中完成
+  sampleCycles = Timebase_GetCycles();
+  HAL_TIM_Base_Start_IT(&htim4);
   
+  // 主循环只处理低优先级的后台任务
+  Control_StateTypeDef reportedState = CONTROL_IDLE;
   while (1) {
-    uint32_t currentTime = HAL_GetTick();
+    // 遥测帧编码后放入发送缓冲区，由DMA在后台发送
+    if (telemetryPending) {
+      uint32_t sendStart = Profiler_Begin();
+      Communication_SendTelemetry(&telemetrySample);
+      telemetryPending = 0;
+      Profiler_End(PROFILE_SEND, sendStart);
+    }
+    
+    // 接收串口指令：DMA收到的字节在这里组装成命令行并解析，逐条处理
+    Communication_Poll();
+    while (Communication_HasCommand()) {
+      Communication_ProcessCommand(&hcontrol, &hattitude);
+      Communication_Poll();
+    }
+    
+    // 黑匣子冻结提示和分批导出
+    Blackbox_Poll();
     
-    // 定时控制循环
-    if (currentTime - lastTime >= sampleTime) {
-      lastTime = currentTime;
-      
-      // 读取传感器数据
-      MPU6050_ReadData(&hmpu);
-      
-      // 使用卡尔曼滤波处理角度数据
-      currentAngle = Kalman_Update(&hkalman, hmpu.angleX, hmpu.gyroX);
-      
-      // PID计算
-      output = PID_Calculate(&hpid, targetAngle, currentAngle);
-      
-      // 电机控制
-      Motor_Control(&hmotor, output);
-      
-      // 串口通信（调试信息）
-      Communication_SendData(currentAngle, output);
-      
-      // 接收串口指令
-      if (Communication_HasCommand()) {
-        Communication_ProcessCommand(&hpid, &targetAngle);
+    // 校准结果回报，校准值写入闪存；水平校准得到的目标角同时存入参数
+    if (Calibration_Poll() == CALIB_LEVEL) {
+      ParamStore_Set(PARAM_TARGET_ANGLE, Calibration_Get()->mount_angle);
+    }
+    
+    // 倒地停机、扶起、重新平衡的提示
+    Control_StateTypeDef state = Control_GetState(&hcontrol);
+    if (state != reportedState) {
+      reportedState = state;
+      if (stateMessages[state] != NULL) {
+        Communication_SendString(stateMessages[state]);
       }
     }
     
-    // 空闲时处理其他任务
-    HAL_Delay(1);
+    // 修改过的参数写入闪存：紧跟在控制周期之后每次写一条，擦除换页只在电机不输出（不在平衡状态）时进行
+    ParamStore_Poll(Timebase_GetCycles() - sampleCycles < PARAM_WRITE_WINDOW_US * (SystemCoreClock / 1000000U),
+                    state != CONTROL_BALANCING);
+    
+    // 等待下一次中断
+    __WFI();
+  }
+}
+
+// 平衡控制循环（TIM4更新中断，CONTROL_RATE_HZ）
+// 各阶段耗时由Profiler探针记录（PROFILER_ENABLE为0时探针为空）
+static void Control_Loop(void) {
+  uint32_t loopStart = Profiler_Begin();
+  uint32_t stageStart = loopStart;
+  
+  // 取最新传感器样本（不等待I2C），并在采样时刻取一次时间戳，滤波器和PID共用同一个dt
+  uint8_t fresh = MPU6050_ReadLatest(&hmpu);
+  float dt = Timebase_Delta(&sampleCycles);
+  Profiler_End(PROFILE_SENSOR, stageStart);
+  
+  // 电池电压：DMA缓冲区求平均并滤波，得到电机输出补偿系数和欠压状态
+  Battery_Update(dt);
+  
+  // 校准进行中：只采集样本，电机不输出；完成后滤波器从校正后的倾角重新开始
+  if (Calibration_IsActive()) {
+    Calibration_StageTypeDef done = fresh ? Calibration_Feed() : CALIB_IDLE;
+    if (done == CALIB_LEVEL) {
+      hcontrol.target_angle = Calibration_Get()->mount_angle;
+    }
+    if (done != CALIB_IDLE) {
+      Attitude_SetAngle(&hattitude, hmpu.angleX);
+    }
+    Control_Suspend(&hcontrol, CONTROL_CALIBRATING);
+    return;
+  }
+  
+  // 姿态估计（卡尔曼/互补/Mahony，由ATTITUDE_FILTER或"set filter"命令选择）
+  stageStart = Profiler_Begin();
+  currentAngle = Attitude_Update(&hattitude, &hmpu, dt);
+  Profiler_End(PROFILE_ATTITUDE, stageStart);
+  
+  // 编码器每个周期采样一次：16位计数器不会在两次采样之间回绕，轮速持续更新
+  stageStart = Profiler_Begin();
+  Motor_UpdateEncoders(&hmotor, dt);
+  Profiler_End(PROFILE_ENCODER, stageStart);
+  
+  // 串级控制：直立环每周期计算，速度环和转向环分频运行，左右电机分别输出；倒地时停机，扶起后重新开始
+  // 电池欠压时停机；否则电机输出按电池电压补偿
+  stageStart = Profiler_Begin();
+  if (Battery_IsLow()) {
+    Control_Suspend(&hcontrol, CONTROL_LOW_BATTERY);
+  } else {
+    Motor_SetVoltageScale(&hmotor, Battery_GetCompensation());
+    Control_Step(&hcontrol, currentAngle, dt);
+  }
+  Profiler_End(PROFILE_CONTROL, stageStart);
+  
+  // 黑匣子记录本周期状态，倒地后冻结
+  stageStart = Profiler_Begin();
+  Blackbox_Record(&hmpu, &hattitude, &hcontrol, dt, Timebase_GetMicros());
+  Profiler_End(PROFILE_BLACKBOX, stageStart);
+  
+  // 按遥测频率分频，交给主循环发送；主循环还没取走上一帧时跳过
+  if (++telemetryCounter >= CONTROL_RATE_HZ / TELEMETRY_RATE_HZ) {
+    telemetryCounter = 0;
+    stageStart = Profiler_Begin();
+    uint32_t timestamp_us = Timebase_GetMicros();
+    if (!telemetryPending) {
+      telemetrySample.timestamp_us = timestamp_us;
+      telemetrySample.angle = currentAngle;
+      telemetrySample.rate = Attitude_GetRate(&hattitude);
+      PID_GetTerms(&hcontrol.angle, &telemetrySample.p_term, &telemetrySample.i_term, &telemetrySample.d_term);
+      telemetrySample.output = hcontrol.balance_output;
+      telemetrySample.duty_left = hmotor.speed_left;
+      telemetrySample.duty_right = hmotor.speed_right;
+      telemetrySample.encoder_left = (uint16_t)Motor_GetEncoderLeft(&hmotor);
+      telemetrySample.encoder_right = (uint16_t)Motor_GetEncoderRight(&hmotor);
+      telemetrySample.voltage = Battery_GetVoltage();
+      telemetryPending = 1;
+    }
+    Profiler_End(PROFILE_SNAPSHOT, stageStart);
+  }
+  
+  Profiler_End(PROFILE_LOOP, loopStart);
+}
+
+// 定时器更新中断回调
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+  if (htim->Instance == TIM4) {
+    Control_Loop();
+  }
+}
+
+// 定时器比较中断回调：控制周期到来前开始读取MPU6050 FIFO
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+  if (htim->Instance == TIM4 && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {
+    MPU6050_StartFifoRead(&hmpu);
   }
 }
 
@@ -108,6 +265,7 @@ int main(void) {
 void SystemClock_Config(void) {
   RCC_OscInitTypeDef RCC_OscInitStruct = {0};
   RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+  RCC_PeriphCLKInitTypeDef PeriphClkInit = {0};
   
   // 配置HSE振荡器
   RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
@@ -126,4 +284,9 @@ void SystemClock_Config(void) {
   RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
   RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
   HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2);
+  
+  // ADC时钟不能超过14MHz：72MHz / 6 = 12MHz
+  PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_ADC;
+  PeriphClkInit.AdcClockSelection = RCC_ADCPCLK2_DIV6;
+  HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit);
 }
\ No newline at end of file
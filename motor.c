@@ -2,128 +2,213 @@
 #include "stm32f1xx_hal.h"
 #include <math.h>
 
-// 全局电机句柄（用于编码器中断）
-Motor_HandleTypeDef *g_motor_handle = NULL;
+#if MOTOR_PWM_PERIOD > 32767 || MOTOR_PWM_PERIOD < MOTOR_OUTPUT_RANGE
+#error "MOTOR_PWM_FREQ_HZ超出范围：PWM周期需在MOTOR_OUTPUT_RANGE到32767个计数之间"
+#endif
+
+// 每个控制输出单位对应的PWM比较值
+#define MOTOR_COUNTS_PER_UNIT ((float)MOTOR_PWM_PERIOD / MOTOR_OUTPUT_RANGE)
+
+// 编码器定时器句柄（定义在main.c）
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+
+// 编码器状态初始化，位置从0开始，计数器保持当前值
+static void Motor_EncoderInit(Motor_EncoderTypeDef *enc, TIM_HandleTypeDef *htim) {
+    enc->htim = htim;
+    enc->raw = (uint16_t)__HAL_TIM_GET_COUNTER(htim);
+    enc->position = 0;
+    enc->window_counts = 0;
+    enc->window_time = 0.0f;
+    enc->velocity = 0.0f;
+}
 
 // 电机初始化
 void Motor_Init(Motor_HandleTypeDef *hmotor, TIM_HandleTypeDef *htim) {
     hmotor->htim = htim;
     hmotor->speed_left = 0;
     hmotor->speed_right = 0;
-    hmotor->encoder_left = 0;
-    hmotor->encoder_right = 0;
+    hmotor->dir_left = 0;
+    hmotor->dir_right = 0;
+    hmotor->dead_zone = DEAD_ZONE;
+    hmotor->max_output = MAX_OUTPUT;
+    hmotor->voltage_scale = 1.0f;
     
-    // 保存全局句柄用于中断
-    g_motor_handle = hmotor;
+    // 编码器从当前计数开始累计
+    Motor_EncoderInit(&hmotor->encoder_left, &htim2);
+    Motor_EncoderInit(&hmotor->encoder_right, &htim3);
     
     // 初始化GPIO方向引脚
     GPIO_InitTypeDef GPIO_InitStruct = {0};
     
     // 使能GPIO时钟
-    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
     
-    // 配置方向引脚
-    GPIO_InitStruct.Pin = MOTOR_A_DIR_PIN | MOTOR_B_DIR_PIN;
+    // 初始两个输入都为低（驱动桥停止输出），再配置为输出
+    HAL_GPIO_WritePin(MOTOR_DIR_PORT, MOTOR_A_IN1_PIN | MOTOR_A_IN2_PIN | MOTOR_B_IN1_PIN | MOTOR_B_IN2_PIN,
+                      GPIO_PIN_RESET);
+    GPIO_InitStruct.Pin = MOTOR_A_IN1_PIN | MOTOR_A_IN2_PIN | MOTOR_B_IN1_PIN | MOTOR_B_IN2_PIN;
     GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
     GPIO_InitStruct.Pull = GPIO_NOPULL;
     GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    HAL_GPIO_Init(MOTOR_DIR_PORT, &GPIO_InitStruct);
+}
+
+// 设置一个电机的方向引脚，只在方向改变时写GPIO
+// 先把要变低的输入拉低再拉高另一个，两个输入不会同时为高（同时为高是短路制动）
+static void Motor_SetDirection(int8_t *current, int8_t dir, uint16_t in1_pin, uint16_t in2_pin) {
+    if (*current == dir) {
+        return;
+    }
+    *current = dir;
     
-    // 初始方向设置为正转
-    HAL_GPIO_WritePin(GPIOA, MOTOR_A_DIR_PIN, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(GPIOA, MOTOR_B_DIR_PIN, GPIO_PIN_SET);
+    if (dir > 0) {
+        HAL_GPIO_WritePin(MOTOR_DIR_PORT, in2_pin, GPIO_PIN_RESET);
+        HAL_GPIO_WritePin(MOTOR_DIR_PORT, in1_pin, GPIO_PIN_SET);
+    } else if (dir < 0) {
+        HAL_GPIO_WritePin(MOTOR_DIR_PORT, in1_pin, GPIO_PIN_RESET);
+        HAL_GPIO_WritePin(MOTOR_DIR_PORT, in2_pin, GPIO_PIN_SET);
+    } else {
+        HAL_GPIO_WritePin(MOTOR_DIR_PORT, in1_pin | in2_pin, GPIO_PIN_RESET);
+    }
 }
 
-// 电机控制（根据PID输出）
-void Motor_Control(Motor_HandleTypeDef *hmotor, float output) {
-    // 死区处理
-    if (fabs(output) < DEAD_ZONE) {
-        output = 0;
+// 控制输出转换为PWM比较值：死区补偿、电池电压补偿、限幅，再按MOTOR_COUNTS_PER_UNIT换算
+static int16_t Motor_OutputToSpeed(Motor_HandleTypeDef *hmotor, float output) {
+    // 死区补偿：|u|映射到 dead_zone + |u|·(满量程-dead_zone)/满量程，满量程输出不变；
+    // 零点附近MOTOR_DEADBAND_RAMP内补偿量按比例减小，输出在零点连续
+    float magnitude = fabsf(output);
+    if (magnitude == 0.0f) {
+        return 0;
+    }
+    float compensated = hmotor->dead_zone + magnitude * (1.0f - hmotor->dead_zone / MOTOR_OUTPUT_RANGE);
+    if (magnitude < (float)MOTOR_DEADBAND_RAMP) {
+        compensated *= magnitude / (float)MOTOR_DEADBAND_RAMP;
     }
     
+    // 控制输出按标称电池电压计，换算为当前电压下的占空比
+    compensated *= hmotor->voltage_scale;
+    
     // 限制输出范围
-    if (output > MAX_OUTPUT) {
-        output = MAX_OUTPUT;
-    } else if (output < -MAX_OUTPUT) {
-        output = -MAX_OUTPUT;
+    if (compensated > hmotor->max_output) {
+        compensated = hmotor->max_output;
     }
     
-    // 转换为电机速度
-    int16_t speed = (int16_t)output;
-    
-    // 设置左右电机速度（相同）
+    compensated *= MOTOR_COUNTS_PER_UNIT;
+    return (int16_t)((output < 0.0f) ? -compensated : compensated);
+}
+
+// 电机控制（根据PID输出，左右电机速度相同）
+void Motor_Control(Motor_HandleTypeDef *hmotor, float output) {
+    int16_t speed = Motor_OutputToSpeed(hmotor, output);
     Motor_SetSpeed(hmotor, speed, speed);
 }
 
-// 设置电机速度
+// 电机控制（左右电机分别给出控制输出）
+void Motor_Drive(Motor_HandleTypeDef *hmotor, float left_output, float right_output) {
+    Motor_SetSpeed(hmotor, Motor_OutputToSpeed(hmotor, left_output), Motor_OutputToSpeed(hmotor, right_output));
+}
+
+// 设置电机速度（PWM比较值，满量程MOTOR_PWM_PERIOD）
+// 速度为0时保持原方向：驱动桥在PWM低电平期间短路制动
 void Motor_SetSpeed(Motor_HandleTypeDef *hmotor, int16_t left_speed, int16_t right_speed) {
     // 限制速度范围
-    if (left_speed > MAX_OUTPUT) left_speed = MAX_OUTPUT;
-    if (left_speed < -MAX_OUTPUT) left_speed = -MAX_OUTPUT;
-    if (right_speed > MAX_OUTPUT) right_speed = MAX_OUTPUT;
-    if (right_speed < -MAX_OUTPUT) right_speed = -MAX_OUTPUT;
+    int16_t limit = (int16_t)(hmotor->max_output * MOTOR_COUNTS_PER_UNIT);
+    if (left_speed > limit) left_speed = limit;
+    if (left_speed < -limit) left_speed = -limit;
+    if (right_speed > limit) right_speed = limit;
+    if (right_speed < -limit) right_speed = -limit;
     
     hmotor->speed_left = left_speed;
     hmotor->speed_right = right_speed;
     
     // 设置左电机方向和PWM
-    if (left_speed >= 0) {
-        HAL_GPIO_WritePin(GPIOA, MOTOR_A_DIR_PIN, GPIO_PIN_SET); // 正转
-        __HAL_TIM_SET_COMPARE(hmotor->htim, TIM_CHANNEL_1, left_speed);
-    } else {
-        HAL_GPIO_WritePin(GPIOA, MOTOR_A_DIR_PIN, GPIO_PIN_RESET); // 反转
-        __HAL_TIM_SET_COMPARE(hmotor->htim, TIM_CHANNEL_1, -left_speed);
+    if (left_speed > 0) {
+        Motor_SetDirection(&hmotor->dir_left, 1, MOTOR_A_IN1_PIN, MOTOR_A_IN2_PIN);   // 正转
+    } else if (left_speed < 0) {
+        Motor_SetDirection(&hmotor->dir_left, -1, MOTOR_A_IN1_PIN, MOTOR_A_IN2_PIN);  // 反转
     }
+    __HAL_TIM_SET_COMPARE(hmotor->htim, MOTOR_A_CHANNEL, (left_speed >= 0) ? left_speed : -left_speed);
     
     // 设置右电机方向和PWM
-    if (right_speed >= 0) {
-        HAL_GPIO_WritePin(GPIOA, MOTOR_B_DIR_PIN, GPIO_PIN_SET); // 正转
-        __HAL_TIM_SET_COMPARE(hmotor->htim, TIM_CHANNEL_2, right_speed);
-    } else {
-        HAL_GPIO_WritePin(GPIOA, MOTOR_B_DIR_PIN, GPIO_PIN_RESET); // 反转
-        __HAL_TIM_SET_COMPARE(hmotor->htim, TIM_CHANNEL_2, -right_speed);
+    if (right_speed > 0) {
+        Motor_SetDirection(&hmotor->dir_right, 1, MOTOR_B_IN1_PIN, MOTOR_B_IN2_PIN);
+    } else if (right_speed < 0) {
+        Motor_SetDirection(&hmotor->dir_right, -1, MOTOR_B_IN1_PIN, MOTOR_B_IN2_PIN);
     }
+    __HAL_TIM_SET_COMPARE(hmotor->htim, MOTOR_B_CHANNEL, (right_speed >= 0) ? right_speed : -right_speed);
 }
 
-// 停止电机
+// 停止电机：PWM为0，两个输入都拉低使驱动桥输出高阻，倒地后车轮可自由转动
 void Motor_Stop(Motor_HandleTypeDef *hmotor) {
     Motor_SetSpeed(hmotor, 0, 0);
+    Motor_SetDirection(&hmotor->dir_left, 0, MOTOR_A_IN1_PIN, MOTOR_A_IN2_PIN);
+    Motor_SetDirection(&hmotor->dir_right, 0, MOTOR_B_IN1_PIN, MOTOR_B_IN2_PIN);
+}
+
+// 设置死区和最大输出（与控制中断互斥由调用者保证）
+void Motor_SetLimits(Motor_HandleTypeDef *hmotor, float dead_zone, float max_output) {
+    hmotor->dead_zone = dead_zone;
+    hmotor->max_output = max_output;
+}
+
+// 设置电池电压补偿系数（控制中断中每周期调用）
+void Motor_SetVoltageScale(Motor_HandleTypeDef *hmotor, float scale) {
+    hmotor->voltage_scale = scale;
+}
+
+// 采样一个编码器：16位计数差按有符号数处理（两次采样间不超过32767个计数即可正确回绕），累加到32位位置
+// 测速采用M/T法：计数足够多时按一个采样周期的计数计算（M法）；低速时延长测速窗口，
+// 直到累计ENCODER_MIN_COUNTS个计数或达到ENCODER_MAX_WINDOW（近似T法），再做一阶低通滤波
+static void Motor_EncoderUpdate(Motor_EncoderTypeDef *enc, float dt) {
+    uint16_t raw = (uint16_t)__HAL_TIM_GET_COUNTER(enc->htim);
+    int16_t delta = (int16_t)(raw - enc->raw);
+    enc->raw = raw;
+    enc->position += delta;
+    
+    enc->window_counts += delta;
+    enc->window_time += dt;
+    if (enc->window_counts >= ENCODER_MIN_COUNTS || enc->window_counts <= -ENCODER_MIN_COUNTS ||
+        enc->window_time >= ENCODER_MAX_WINDOW) {
+        float velocity = (float)enc->window_counts / (ENCODER_COUNTS_PER_REV * enc->window_time);
+        enc->velocity += ENCODER_VELOCITY_ALPHA * (velocity - enc->velocity);
+        enc->window_counts = 0;
+        enc->window_time = 0.0f;
+    }
+}
+
+// 采样左右编码器（每个控制周期调用一次，dt为采样间隔，单位秒）
+void Motor_UpdateEncoders(Motor_HandleTypeDef *hmotor, float dt) {
+    if (dt <= 0) {
+        return;
+    }
+    Motor_EncoderUpdate(&hmotor->encoder_left, dt);
+    Motor_EncoderUpdate(&hmotor->encoder_right, dt);
 }
 
 // 获取编码器值
 int32_t Motor_GetEncoderLeft(Motor_HandleTypeDef *hmotor) {
-    return hmotor->encoder_left;
+    return hmotor->encoder_left.position;
 }
 
 int32_t Motor_GetEncoderRight(Motor_HandleTypeDef *hmotor) {
-    return hmotor->encoder_right;
+    return hmotor->encoder_right.position;
 }
 
-// 重置编码器
-void Motor_ResetEncoders(Motor_HandleTypeDef *hmotor) {
-    hmotor->encoder_left = 0;
-    hmotor->encoder_right = 0;
-    
-    // 重置硬件计数器
-    __HAL_TIM_SET_COUNTER(&htim2, 0);
-    __HAL_TIM_SET_COUNTER(&htim3, 0);
+// 获取车轮速度（转/秒，前进为正）
+float Motor_GetVelocityLeft(Motor_HandleTypeDef *hmotor) {
+    return hmotor->encoder_left.velocity;
 }
 
-// 编码器中断回调函数
-void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
-    if (g_motor_handle == NULL) return;
-    
-    // 左编码器（TIM2）
-    if (htim->Instance == TIM2) {
-        int16_t count = (int16_t)__HAL_TIM_GET_COUNTER(htim);
-        g_motor_handle->encoder_left += count;
-        __HAL_TIM_SET_COUNTER(htim, 0);
-    }
-    
-    // 右编码器（TIM3）
-    if (htim->Instance == TIM3) {
-        int16_t count = (int16_t)__HAL_TIM_GET_COUNTER(htim);
-        g_motor_handle->encoder_right += count;
-        __HAL_TIM_SET_COUNTER(htim, 0);
-    }
+float Motor_GetVelocityRight(Motor_HandleTypeDef *hmotor) {
+    return hmotor->encoder_right.velocity;
+}
+
+// 重置编码器
+void Motor_ResetEncoders(Motor_HandleTypeDef *hmotor) {
+    // 先清零硬件计数器，再从0开始累计
+    __HAL_TIM_SET_COUNTER(hmotor->encoder_left.htim, 0);
+    __HAL_TIM_SET_COUNTER(hmotor->encoder_right.htim, 0);
+    Motor_EncoderInit(&hmotor->encoder_left, hmotor->encoder_left.htim);
+    Motor_EncoderInit(&hmotor->encoder_right, hmotor->encoder_right.htim);
 }
\ No newline at end of file
@@ -5,30 +5,50 @@
 #include "pins.h"
 #include "parameters.h"
 
+// 单个编码器的采样与测速状态
+typedef struct {
+    TIM_HandleTypeDef *htim;        // 编码器定时器句柄
+    uint16_t raw;                   // 上次读取的16位计数器值
+    int32_t position;               // 累计位置（计数）
+    int32_t window_counts;          // 当前测速窗口内的计数
+    float window_time;              // 当前测速窗口时长（秒）
+    float velocity;                 // 滤波后的车轮速度（转/秒）
+} Motor_EncoderTypeDef;
+
 // 电机控制器结构体
 typedef struct {
     TIM_HandleTypeDef *htim;        // PWM定时器句柄
     
     // 电机参数
-    int16_t speed_left;             // 左电机速度
+    int16_t speed_left;             // 左电机速度（PWM比较值，满量程MOTOR_PWM_PERIOD）
     int16_t speed_right;            // 右电机速度
+    int8_t dir_left;                // 当前方向引脚状态：1正转，-1反转，0两个输入都为低（停止）
+    int8_t dir_right;
     
-    // 编码器值
-    int32_t encoder_left;           // 左编码器计数
-    int32_t encoder_right;          // 右编码器计数
+    // 输出限制（初值DEAD_ZONE/MAX_OUTPUT，可由参数存储修改）
+    float dead_zone;                // 死区补偿（控制输出单位），加在非零输出上
+    float max_output;               // 最大输出（控制输出单位，MOTOR_OUTPUT_RANGE为100%占空比）
+    float voltage_scale;            // 电池电压补偿系数（Battery_GetCompensation），乘在控制输出上
+    
+    // 编码器
+    Motor_EncoderTypeDef encoder_left;  // 左编码器（TIM2）
+    Motor_EncoderTypeDef encoder_right; // 右编码器（TIM3）
     
 } Motor_HandleTypeDef;
 
 // 函数声明
 void Motor_Init(Motor_HandleTypeDef *hmotor, TIM_HandleTypeDef *htim);
 void Motor_Control(Motor_HandleTypeDef *hmotor, float output);
+void Motor_Drive(Motor_HandleTypeDef *hmotor, float left_output, float right_output);
 void Motor_SetSpeed(Motor_HandleTypeDef *hmotor, int16_t left_speed, int16_t right_speed);
 void Motor_Stop(Motor_HandleTypeDef *hmotor);
+void Motor_SetLimits(Motor_HandleTypeDef *hmotor, float dead_zone, float max_output);
+void Motor_SetVoltageScale(Motor_HandleTypeDef *hmotor, float scale);
+void Motor_UpdateEncoders(Motor_HandleTypeDef *hmotor, float dt);
 int32_t Motor_GetEncoderLeft(Motor_HandleTypeDef *hmotor);
 int32_t Motor_GetEncoderRight(Motor_HandleTypeDef *hmotor);
+float Motor_GetVelocityLeft(Motor_HandleTypeDef *hmotor);
+float Motor_GetVelocityRight(Motor_HandleTypeDef *hmotor);
 void Motor_ResetEncoders(Motor_HandleTypeDef *hmotor);
 
-// 编码器中断回调函数
-void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim);
-
 #endif
\ No newline at end of file
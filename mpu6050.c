@@ -1,5 +1,7 @@
 #include "mpu6050.h"
 #include "stm32f1xx_hal.h"
+#include "parameters.h"
+#include "fastmath.h"
 #include <math.h>
 
 // 转换系数
@@ -7,9 +9,18 @@
 #define GYRO_SCALE 131.0f     // ±250°/s范围
 #define RAD_TO_DEG 57.29578f  // 弧度转角度
 
+// MPU6050所在的I2C总线
+static I2C_HandleTypeDef *mpu_hi2c = NULL;
+
+// 异步读取使用的句柄（中断回调中访问），StartAsync之前为NULL
+static MPU6050_HandleTypeDef *mpu_async = NULL;
+
+static void MPU6050_Convert(MPU6050_HandleTypeDef *hmpu, float ax, float ay, float az, float gx, float gy);
+
 // MPU6050初始化
 uint8_t MPU6050_Init(MPU6050_HandleTypeDef *hmpu, I2C_HandleTypeDef *hi2c) {
     hmpu->hi2c = hi2c;
+    mpu_hi2c = hi2c;
     
     // 检查设备ID
     uint8_t whoami = MPU6050_ReadByte(MPU6050_RA_WHO_AM_I);
@@ -21,72 +32,314 @@ uint8_t MPU6050_Init(MPU6050_HandleTypeDef *hmpu, I2C_HandleTypeDef *hi2c) {
     MPU6050_WriteByte(MPU6050_RA_PWR_MGMT_1, 0x00);
     HAL_Delay(100);
     
+    // 数字低通滤波和采样率：输出频率 = 陀螺仪输出频率 / (1 + SMPLRT_DIV)
+    MPU6050_WriteByte(MPU6050_RA_CONFIG, IMU_DLPF_CFG);
+    MPU6050_WriteByte(MPU6050_RA_SMPLRT_DIV, MPU6050_GYRO_OUTPUT_HZ / IMU_SAMPLE_RATE_HZ - 1);
+    
     // 配置陀螺仪量程 ±250°/s
     MPU6050_WriteByte(MPU6050_RA_GYRO_CONFIG, MPU6050_GYRO_FS_250);
     
     // 配置加速度计量程 ±2g
     MPU6050_WriteByte(MPU6050_RA_ACCEL_CONFIG, MPU6050_ACCEL_FS_2);
     
-    // 初始化变量
+    // 初始化变量（校准值由Calibration_Init从闪存载入，或在控制循环中重新测量）
     hmpu->gyroXoffset = 0;
     hmpu->gyroYoffset = 0;
     hmpu->gyroZoffset = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        hmpu->accelOffset[i] = 0;
+        hmpu->accelScaleError[i] = 0;
+    }
     hmpu->angleX = 0;
     hmpu->angleY = 0;
     hmpu->lastUpdate = HAL_GetTick();
     
-    // 校准陀螺仪
-    MPU6050_Calibrate(hmpu, 1000);
+    // 温度只在这里读取一次：启动异步读取后总线由DMA占用，FIFO中也不含温度
+    MPU6050_ReadTemperature(hmpu);
     
     return 1; // 初始化成功
 }
 
-// 读取传感器数据
+// 读取传感器数据（阻塞，只能在启动异步读取之前调用）
 void MPU6050_ReadData(MPU6050_HandleTypeDef *hmpu) {
-    uint8_t buffer[14];
+    uint8_t buffer[MPU6050_BURST_SIZE];
     
     // 读取加速度计和陀螺仪数据
-    MPU6050_ReadBytes(MPU6050_RA_ACCEL_XOUT_H, buffer, 14);
-    
+    MPU6050_ReadBytes(MPU6050_RA_ACCEL_XOUT_H, buffer, MPU6050_BURST_SIZE);
+    MPU6050_ProcessRaw(hmpu, buffer);
+}
+
+// 解析一次突发读取的原始数据
+void MPU6050_ProcessRaw(MPU6050_HandleTypeDef *hmpu, const uint8_t *buffer) {
     // 解析加速度数据
     hmpu->accelX = (int16_t)((buffer[0] << 8) | buffer[1]);
     hmpu->accelY = (int16_t)((buffer[2] << 8) | buffer[3]);
     hmpu->accelZ = (int16_t)((buffer[4] << 8) | buffer[5]);
     
     // 解析陀螺仪数据
-    hmpu->gyroX = (int16_t)((buffer[8] << 8) | buffer[9]);
-    hmpu->gyroY = (int16_t)((buffer[10] << 8) | buffer[11]);
-    hmpu->gyroZ = (int16_t)((buffer[12] << 8) | buffer[13]);
+    hmpu->gyroX_raw = (int16_t)((buffer[8] << 8) | buffer[9]);
+    hmpu->gyroY_raw = (int16_t)((buffer[10] << 8) | buffer[11]);
+    hmpu->gyroZ_raw = (int16_t)((buffer[12] << 8) | buffer[13]);
     
-    // 计算角度（使用加速度计）
-    float accelX_g = hmpu->accelX / ACCEL_SCALE;
-    float accelY_g = hmpu->accelY / ACCEL_SCALE;
-    float accelZ_g = hmpu->accelZ / ACCEL_SCALE;
+    MPU6050_Convert(hmpu, hmpu->accelX, hmpu->accelY, hmpu->accelZ, hmpu->gyroX_raw, hmpu->gyroY_raw);
+}
+
+// 由原始值（LSB，可以是多个样本的平均）计算角度和角速度
+static void MPU6050_Convert(MPU6050_HandleTypeDef *hmpu, float ax, float ay, float az, float gx, float gy) {
+    // 计算角度（使用校正后的加速度计），校正值保存下来供Mahony滤波使用
+    float accelX_g = (ax - hmpu->accelOffset[0]) * (1.0f + hmpu->accelScaleError[0]) / ACCEL_SCALE;
+    float accelY_g = (ay - hmpu->accelOffset[1]) * (1.0f + hmpu->accelScaleError[1]) / ACCEL_SCALE;
+    float accelZ_g = (az - hmpu->accelOffset[2]) * (1.0f + hmpu->accelScaleError[2]) / ACCEL_SCALE;
+    hmpu->accel[0] = accelX_g;
+    hmpu->accel[1] = accelY_g;
+    hmpu->accel[2] = accelZ_g;
     
     // 计算俯仰角和横滚角
+#if USE_FAST_MATH
+    hmpu->angleX = FastMath_Atan2(accelY_g, accelZ_g) * RAD_TO_DEG;
+    hmpu->angleY = FastMath_Atan2(-accelX_g, FastMath_Sqrt(accelY_g * accelY_g + accelZ_g * accelZ_g)) * RAD_TO_DEG;
+#else
     hmpu->angleX = atan2(accelY_g, accelZ_g) * RAD_TO_DEG;
     hmpu->angleY = atan2(-accelX_g, sqrt(accelY_g * accelY_g + accelZ_g * accelZ_g)) * RAD_TO_DEG;
+#endif
     
     // 计算角速度（去除偏移）
-    hmpu->gyroX = (hmpu->gyroX / GYRO_SCALE) - hmpu->gyroXoffset;
-    hmpu->gyroY = (hmpu->gyroY / GYRO_SCALE) - hmpu->gyroYoffset;
+    hmpu->gyroX = (gx / GYRO_SCALE) - hmpu->gyroXoffset;
+    hmpu->gyroY = (gy / GYRO_SCALE) - hmpu->gyroYoffset;
+}
+
+// 解算一批样本的累加值（ax, ay, az, gx, gy, gz），samples不能为0
+// 平均后再解算，噪声按样本数的平方根下降；原始值字段保存截断后的平均值
+void MPU6050_ProcessSum(MPU6050_HandleTypeDef *hmpu, const int32_t *sum, uint8_t samples) {
+    float inv = 1.0f / samples;
+    hmpu->accelX = (int16_t)(sum[0] / samples);
+    hmpu->accelY = (int16_t)(sum[1] / samples);
+    hmpu->accelZ = (int16_t)(sum[2] / samples);
+    hmpu->gyroX_raw = (int16_t)(sum[3] / samples);
+    hmpu->gyroY_raw = (int16_t)(sum[4] / samples);
+    hmpu->gyroZ_raw = (int16_t)(sum[5] / samples);
+    MPU6050_Convert(hmpu, sum[0] * inv, sum[1] * inv, sum[2] * inv, sum[3] * inv, sum[4] * inv);
+}
+
+// 启动异步读取
+// 数据就绪模式：打开INT引脚数据就绪中断，每个新样本触发一次DMA读取
+// FIFO模式：传感器数据写入片上FIFO，由 MPU6050_StartFifoRead 每个控制周期批量读取
+uint8_t MPU6050_StartAsync(MPU6050_HandleTypeDef *hmpu) {
+    hmpu->readyIndex = 0;
+    hmpu->busy = 0;
+    hmpu->sampleCount = 0;
+    hmpu->consumedCount = 0;
+    hmpu->missedCount = 0;
+    hmpu->errorCount = 0;
+    hmpu->overflowCount = 0;
+    hmpu->stallCount = 0;
+    hmpu->fifoStage = MPU6050_FIFO_STAGE_IDLE;
+    mpu_async = hmpu;
+    
+#if IMU_FIFO_MODE
+    // 加速度计和三轴陀螺仪写入FIFO，复位后再使能
+    MPU6050_WriteByte(MPU6050_RA_FIFO_EN, MPU6050_FIFOEN_ACCEL | MPU6050_FIFOEN_GYRO);
+    MPU6050_WriteByte(MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_RESET);
+    return MPU6050_WriteByte(MPU6050_RA_USER_CTRL, MPU6050_USERCTRL_FIFO_EN) == HAL_OK;
+#else
+    MPU6050_WriteByte(MPU6050_RA_INT_PIN_CFG, MPU6050_INTCFG_INT_RD_CLEAR);
+    
+    // 最后打开中断，第一次数据就绪即开始传输
+    return MPU6050_WriteByte(MPU6050_RA_INT_ENABLE, MPU6050_INTEN_DATA_RDY) == HAL_OK;
+#endif
+}
+
+// 取最近一次完成的样本（不等待总线），有新样本返回1；无新样本时保持上次的角度和角速度并返回0
+// FIFO模式下取到的是上一批样本的平均值
+uint8_t MPU6050_ReadLatest(MPU6050_HandleTypeDef *hmpu) {
+#if IMU_FIFO_MODE
+    int32_t sum[6];
+    uint8_t samples = 0;
+#else
+    uint8_t buffer[MPU6050_BURST_SIZE];
+#endif
+    uint32_t count;
+    
+    // 关中断拷贝，避免拷贝过程中DMA完成并开始改写这个缓冲区
+    __disable_irq();
+    count = hmpu->sampleCount;
+    if (count != hmpu->consumedCount) {
+#if IMU_FIFO_MODE
+        samples = hmpu->fifoSamples[hmpu->readyIndex];
+        for (uint8_t i = 0; i < 6; i++) {
+            sum[i] = hmpu->fifoSum[hmpu->readyIndex][i];
+        }
+#else
+        const uint8_t *src = hmpu->rawBuffer[hmpu->readyIndex];
+        for (uint8_t i = 0; i < MPU6050_BURST_SIZE; i++) {
+            buffer[i] = src[i];
+        }
+#endif
+    }
+    __enable_irq();
+    
+    if (count == hmpu->consumedCount) {
+        return 0;
+    }
+    hmpu->consumedCount = count;
+    
+#if IMU_FIFO_MODE
+    MPU6050_ProcessSum(hmpu, sum, samples);
+#else
+    MPU6050_ProcessRaw(hmpu, buffer);
+#endif
+    return 1;
+}
+
+// 准备发起一次传输：上一次传输未结束时跳过，长时间未结束则复位I2C；可以发起返回1
+static uint8_t MPU6050_BeginTransfer(MPU6050_HandleTypeDef *hmpu) {
+    if (hmpu->busy) {
+        hmpu->missedCount++;
+        if (++hmpu->stallCount < MPU6050_BUS_STALL_LIMIT) {
+            return 0;
+        }
+        // 传输长时间未完成：复位I2C外设后重新发起
+        hmpu->errorCount++;
+        HAL_I2C_DeInit(mpu_hi2c);
+        HAL_I2C_Init(mpu_hi2c);
+    }
+    
+    hmpu->stallCount = 0;
+    hmpu->busy = 1;
+    return 1;
+}
+
+// 结束本次传输（成功、失败或FIFO为空）
+static void MPU6050_EndTransfer(MPU6050_HandleTypeDef *hmpu, uint8_t error) {
+    if (error) {
+        hmpu->errorCount++;
+    }
+    hmpu->fifoStage = MPU6050_FIFO_STAGE_IDLE;
+    hmpu->busy = 0;
+}
+
+// 数据就绪中断：读取一个样本到未发布的缓冲区
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin != MPU6050_INT_PIN || mpu_async == NULL) {
+        return;
+    }
+    if (!MPU6050_BeginTransfer(mpu_async)) {
+        return;
+    }
+    
+    uint8_t *dest = mpu_async->rawBuffer[mpu_async->readyIndex ^ 1];
+    if (HAL_I2C_Mem_Read_DMA(mpu_hi2c, MPU6050_ADDR << 1, MPU6050_RA_ACCEL_XOUT_H,
+                             I2C_MEMADD_SIZE_8BIT, dest, MPU6050_BURST_SIZE) != HAL_OK) {
+        MPU6050_EndTransfer(mpu_async, 1);
+    }
+}
+
+// 开始读取FIFO：先读FIFO_COUNT，完成后在DMA回调中接着读取数据（在控制周期到来前调用）
+void MPU6050_StartFifoRead(MPU6050_HandleTypeDef *hmpu) {
+    if (!MPU6050_BeginTransfer(hmpu)) {
+        return;
+    }
+    
+    hmpu->fifoStage = MPU6050_FIFO_STAGE_COUNT;
+    if (HAL_I2C_Mem_Read_DMA(mpu_hi2c, MPU6050_ADDR << 1, MPU6050_RA_FIFO_COUNTH,
+                             I2C_MEMADD_SIZE_8BIT, hmpu->fifoCount, 2) != HAL_OK) {
+        MPU6050_EndTransfer(hmpu, 1);
+    }
+}
+
+// FIFO读取各阶段完成
+static void MPU6050_FifoTransferDone(MPU6050_HandleTypeDef *hmpu) {
+    if (hmpu->fifoStage == MPU6050_FIFO_STAGE_COUNT) {
+        uint16_t count = (uint16_t)((hmpu->fifoCount[0] << 8) | hmpu->fifoCount[1]);
+        
+        // 溢出后数据错位，复位FIFO丢弃全部数据
+        // 回调在最高优先级中断中运行，SysTick不会前进，不能用带超时的阻塞写：改为中断方式写入，完成后结束本次传输
+        if (count > MPU6050_FIFO_SIZE - MPU6050_FIFO_SAMPLE_SIZE || count % MPU6050_FIFO_SAMPLE_SIZE != 0) {
+            hmpu->overflowCount++;
+            hmpu->fifoCtrl = MPU6050_USERCTRL_FIFO_EN | MPU6050_USERCTRL_FIFO_RESET;
+            hmpu->fifoStage = MPU6050_FIFO_STAGE_RESET;
+            if (HAL_I2C_Mem_Write_IT(mpu_hi2c, MPU6050_ADDR << 1, MPU6050_RA_USER_CTRL, I2C_MEMADD_SIZE_8BIT,
+                                     &hmpu->fifoCtrl, 1) != HAL_OK) {
+                MPU6050_EndTransfer(hmpu, 1);
+            }
+            return;
+        }
+        
+        uint16_t samples = count / MPU6050_FIFO_SAMPLE_SIZE;
+        if (samples == 0) {
+            MPU6050_EndTransfer(hmpu, 0);
+            return;
+        }
+        if (samples > MPU6050_FIFO_MAX_SAMPLES) {
+            samples = MPU6050_FIFO_MAX_SAMPLES; // 剩余样本下个周期读取
+        }
+        
+        hmpu->fifoPending = (uint8_t)samples;
+        hmpu->fifoStage = MPU6050_FIFO_STAGE_DATA;
+        if (HAL_I2C_Mem_Read_DMA(mpu_hi2c, MPU6050_ADDR << 1, MPU6050_RA_FIFO_R_W, I2C_MEMADD_SIZE_8BIT,
+                                 hmpu->fifoBuffer, samples * MPU6050_FIFO_SAMPLE_SIZE) != HAL_OK) {
+            MPU6050_EndTransfer(hmpu, 1);
+        }
+        return;
+    }
+    
+    // 累加本批样本，写入未发布的一半后切换
+    uint8_t index = hmpu->readyIndex ^ 1;
+    int32_t *sum = hmpu->fifoSum[index];
+    for (uint8_t i = 0; i < 6; i++) {
+        sum[i] = 0;
+    }
+    for (uint8_t n = 0; n < hmpu->fifoPending; n++) {
+        const uint8_t *p = &hmpu->fifoBuffer[n * MPU6050_FIFO_SAMPLE_SIZE];
+        for (uint8_t i = 0; i < 6; i++) {
+            sum[i] += (int16_t)((p[2 * i] << 8) | p[2 * i + 1]);
+        }
+    }
+    hmpu->fifoSamples[index] = hmpu->fifoPending;
+    hmpu->readyIndex = index;
+    hmpu->sampleCount++;
+    MPU6050_EndTransfer(hmpu, 0);
 }
 
-// 陀螺仪校准
-void MPU6050_Calibrate(MPU6050_HandleTypeDef *hmpu, uint16_t samples) {
-    float sumX = 0, sumY = 0, sumZ = 0;
+// DMA读取完成
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c != mpu_hi2c || mpu_async == NULL) {
+        return;
+    }
+    if (mpu_async->fifoStage != MPU6050_FIFO_STAGE_IDLE) {
+        MPU6050_FifoTransferDone(mpu_async);
+        return;
+    }
     
-    for (uint16_t i = 0; i < samples; i++) {
-        MPU6050_ReadData(hmpu);
-        sumX += hmpu->gyroX;
-        sumY += hmpu->gyroY;
-        sumZ += hmpu->gyroZ;
-        HAL_Delay(5);
+    // 单样本：切换到刚写完的缓冲区
+    mpu_async->readyIndex ^= 1;
+    mpu_async->sampleCount++;
+    MPU6050_EndTransfer(mpu_async, 0);
+}
+
+// 写入完成（只有FIFO复位使用），下个控制周期重新读取
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c != mpu_hi2c || mpu_async == NULL) {
+        return;
     }
+    MPU6050_EndTransfer(mpu_async, 0);
+}
+
+// I2C错误：放弃本次传输，等待下一次数据就绪或控制周期重试
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c != mpu_hi2c || mpu_async == NULL) {
+        return;
+    }
+    MPU6050_EndTransfer(mpu_async, 1);
+}
+
+// 读取芯片温度（阻塞，只能在启动异步读取之前调用）
+float MPU6050_ReadTemperature(MPU6050_HandleTypeDef *hmpu) {
+    uint8_t buffer[2];
     
-    hmpu->gyroXoffset = sumX / samples;
-    hmpu->gyroYoffset = sumY / samples;
-    hmpu->gyroZoffset = sumZ / samples;
+    MPU6050_ReadBytes(MPU6050_RA_TEMP_OUT_H, buffer, 2);
+    hmpu->temperature = (int16_t)((buffer[0] << 8) | buffer[1]) / 340.0f + 36.53f;
+    return hmpu->temperature;
 }
 
 // 获取角度数据
@@ -110,19 +363,19 @@ float MPU6050_GetGyroY(MPU6050_HandleTypeDef *hmpu) {
 // I2C写字节
 uint8_t MPU6050_WriteByte(uint8_t reg, uint8_t data) {
     uint8_t buffer[2] = {reg, data};
-    return HAL_I2C_Master_Transmit(MPU6050_I2C, MPU6050_ADDR << 1, buffer, 2, 100);
+    return HAL_I2C_Master_Transmit(mpu_hi2c, MPU6050_ADDR << 1, buffer, 2, 100);
 }
 
 // I2C读字节
 uint8_t MPU6050_ReadByte(uint8_t reg) {
     uint8_t data;
-    HAL_I2C_Master_Transmit(MPU6050_I2C, MPU6050_ADDR << 1, &reg, 1, 100);
-    HAL_I2C_Master_Receive(MPU6050_I2C, MPU6050_ADDR << 1, &data, 1, 100);
+    HAL_I2C_Master_Transmit(mpu_hi2c, MPU6050_ADDR << 1, &reg, 1, 100);
+    HAL_I2C_Master_Receive(mpu_hi2c, MPU6050_ADDR << 1, &data, 1, 100);
     return data;
 }
 
 // I2C读多个字节
 void MPU6050_ReadBytes(uint8_t reg, uint8_t *data, uint8_t length) {
-    HAL_I2C_Master_Transmit(MPU6050_I2C, MPU6050_ADDR << 1, &reg, 1, 100);
-    HAL_I2C_Master_Receive(MPU6050_I2C, MPU6050_ADDR << 1, data, length, 100);
+    HAL_I2C_Master_Transmit(mpu_hi2c, MPU6050_ADDR << 1, &reg, 1, 100);
+    HAL_I2C_Master_Receive(mpu_hi2c, MPU6050_ADDR << 1, data, length, 100);
 }
\ No newline at end of file
@@ -3,14 +3,62 @@
 
 #include "stm32f1xx_hal.h"
 #include "pins.h"
+#include "parameters.h"
 
 // MPU6050寄存器地址定义
 #define MPU6050_RA_WHO_AM_I         0x75
 #define MPU6050_RA_PWR_MGMT_1       0x6B
+#define MPU6050_RA_SMPLRT_DIV       0x19
+#define MPU6050_RA_CONFIG           0x1A
 #define MPU6050_RA_GYRO_CONFIG      0x1B
 #define MPU6050_RA_ACCEL_CONFIG     0x1C
+#define MPU6050_RA_INT_PIN_CFG      0x37
+#define MPU6050_RA_INT_ENABLE       0x38
+#define MPU6050_RA_INT_STATUS       0x3A
+#define MPU6050_RA_FIFO_EN          0x23
 #define MPU6050_RA_ACCEL_XOUT_H     0x3B
+#define MPU6050_RA_TEMP_OUT_H       0x41
 #define MPU6050_RA_GYRO_XOUT_H      0x43
+#define MPU6050_RA_USER_CTRL        0x6A
+#define MPU6050_RA_FIFO_COUNTH      0x72
+#define MPU6050_RA_FIFO_R_W         0x74
+
+// 陀螺仪输出频率：DLPF关闭（0或7）时8kHz，否则1kHz
+#define MPU6050_GYRO_OUTPUT_HZ      ((IMU_DLPF_CFG == 0 || IMU_DLPF_CFG == 7) ? 8000 : 1000)
+
+// 中断配置
+#define MPU6050_INTCFG_INT_RD_CLEAR 0x10  // 任意读操作清除中断状态
+#define MPU6050_INTEN_DATA_RDY      0x01  // 数据就绪中断
+
+// FIFO配置
+#define MPU6050_FIFOEN_ACCEL        0x08
+#define MPU6050_FIFOEN_GYRO         0x70  // XG | YG | ZG
+#define MPU6050_USERCTRL_FIFO_EN    0x40
+#define MPU6050_USERCTRL_FIFO_RESET 0x04
+#define MPU6050_FIFO_SIZE           1024
+#define MPU6050_FIFO_SAMPLE_SIZE    12    // 加速度(6) + 陀螺仪(6)
+#define MPU6050_FIFO_MAX_SAMPLES    16    // 每次最多读取的样本数
+
+// FIFO模式下每个控制周期的样本数，以及在控制周期前提前多久开始读取：
+// 400kHz下每字节约22.5µs，按多一个样本预留余量
+#define MPU6050_FIFO_SAMPLES_PER_TICK (IMU_SAMPLE_RATE_HZ / CONTROL_RATE_HZ)
+#define MPU6050_FIFO_LEAD_US        (25 * (MPU6050_FIFO_SAMPLE_SIZE * (MPU6050_FIFO_SAMPLES_PER_TICK + 1) + 10))
+
+#if IMU_FIFO_MODE && (MPU6050_FIFO_LEAD_US >= 1000000 / CONTROL_RATE_HZ || MPU6050_FIFO_SAMPLES_PER_TICK >= MPU6050_FIFO_MAX_SAMPLES)
+#error "FIFO模式下每个控制周期的样本数过多，降低IMU_SAMPLE_RATE_HZ或提高CONTROL_RATE_HZ"
+#endif
+
+// FIFO读取阶段
+#define MPU6050_FIFO_STAGE_IDLE     0
+#define MPU6050_FIFO_STAGE_COUNT    1     // 正在读取FIFO_COUNT
+#define MPU6050_FIFO_STAGE_DATA     2     // 正在读取样本
+#define MPU6050_FIFO_STAGE_RESET    3     // 溢出后正在写USER_CTRL复位FIFO
+
+// 连续多少次数据就绪时总线仍忙，判定为总线挂死并复位I2C
+#define MPU6050_BUS_STALL_LIMIT     10
+
+// 一次突发读取：加速度(6) + 温度(2) + 陀螺仪(6)
+#define MPU6050_BURST_SIZE          14
 
 // 传感器量程设置
 #define MPU6050_GYRO_FS_250         0x00  // ±250°/s
@@ -22,24 +70,53 @@ typedef struct {
     
     // 原始数据
     int16_t accelX, accelY, accelZ;
-    int16_t gyroX, gyroY, gyroZ;
+    int16_t gyroX_raw, gyroY_raw, gyroZ_raw;
     
-    // 校准数据
-    float gyroXoffset, gyroYoffset, gyroZoffset;
+    // 校准数据（calibration.c写入；清零即不校准）
+    float gyroXoffset, gyroYoffset, gyroZoffset;    // 陀螺仪零偏（°/s）
+    float accelOffset[3];               // 加速度计零偏（LSB）
+    float accelScaleError[3];           // 加速度计标度误差：校正值 = (原始值 - 零偏) × (1 + 标度误差)
+    float temperature;                  // 芯片温度（°C，初始化时读取）
     
     // 处理后的数据
+    float accel[3];                 // 校正后的加速度（g，三种姿态滤波器共用）
     float angleX, angleY;           // 角度（度）
     float gyroX, gyroY;             // 角速度（°/s）
     
     // 时间戳
     uint32_t lastUpdate;
     
+    // 异步读取：数据就绪中断触发DMA突发读，双缓冲
+    uint8_t rawBuffer[2][MPU6050_BURST_SIZE];
+    volatile uint8_t readyIndex;        // 最近一次完成的缓冲区（或FIFO累加值），DMA写另一个
+    volatile uint8_t busy;              // DMA传输进行中
+    volatile uint32_t sampleCount;      // 已完成的采样数
+    uint32_t consumedCount;             // 控制循环已取用的采样数
+    volatile uint32_t missedCount;      // 数据就绪时总线仍忙而跳过的次数
+    uint8_t stallCount;                 // 连续跳过次数
+    volatile uint32_t errorCount;       // I2C/DMA错误次数
+    
+    // FIFO批量读取
+    uint8_t fifoCount[2];               // FIFO_COUNTH/L
+    uint8_t fifoBuffer[MPU6050_FIFO_MAX_SAMPLES * MPU6050_FIFO_SAMPLE_SIZE];
+    int32_t fifoSum[2][6];              // 每批样本累加值：ax, ay, az, gx, gy, gz
+    uint8_t fifoSamples[2];             // 每批样本数
+    uint8_t fifoPending;                // 正在读取的样本数
+    uint8_t fifoCtrl;                   // 复位FIFO时写入USER_CTRL的值（中断方式写入，传输期间保持有效）
+    volatile uint8_t fifoStage;         // 读取阶段
+    volatile uint32_t overflowCount;    // FIFO溢出复位次数
+    
 } MPU6050_HandleTypeDef;
 
 // 函数声明
 uint8_t MPU6050_Init(MPU6050_HandleTypeDef *hmpu, I2C_HandleTypeDef *hi2c);
 void MPU6050_ReadData(MPU6050_HandleTypeDef *hmpu);
-void MPU6050_Calibrate(MPU6050_HandleTypeDef *hmpu, uint16_t samples);
+void MPU6050_ProcessRaw(MPU6050_HandleTypeDef *hmpu, const uint8_t *buffer);
+void MPU6050_ProcessSum(MPU6050_HandleTypeDef *hmpu, const int32_t *sum, uint8_t samples);
+uint8_t MPU6050_StartAsync(MPU6050_HandleTypeDef *hmpu);
+uint8_t MPU6050_ReadLatest(MPU6050_HandleTypeDef *hmpu);
+void MPU6050_StartFifoRead(MPU6050_HandleTypeDef *hmpu);
+float MPU6050_ReadTemperature(MPU6050_HandleTypeDef *hmpu);
 float MPU6050_GetAngleX(MPU6050_HandleTypeDef *hmpu);
 float MPU6050_GetAngleY(MPU6050_HandleTypeDef *hmpu);
 float MPU6050_GetGyroX(MPU6050_HandleTypeDef *hmpu);
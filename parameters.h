@@ -1,23 +1,127 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
 
-// PID参数
-#define PID_KP 15.0      // 比例系数
+// PID参数（默认值在sim的物理模型上整定，make run 检验）
+#define PID_KP 110.0     // 比例系数
 #define PID_KI 0.05      // 积分系数
-#define PID_KD 0.1       // 微分系数
+#define PID_KD 3.0       // 微分系数
 
 // 卡尔曼滤波参数
 #define Q_ANGLE 0.001    // 过程噪声协方差
 #define Q_GYRO 0.003     // 陀螺仪噪声协方差
 #define R_ANGLE 0.03     // 测量噪声协方差
+// 稳态增益：Q/R和dt恒定时P和K收敛为常数，初始化时按标称控制周期迭代求出，此后每次更新只有几次乘加；
+// dt偏离标称值超过 KALMAN_SS_DT_TOLERANCE（相对值）的那一次退回完整的协方差递推
+#ifndef KALMAN_STEADY_STATE
+#define KALMAN_STEADY_STATE 1
+#endif
+#define KALMAN_SS_DT_TOLERANCE 0.05
+
+// 姿态估计器（attitude.h）：0 = 卡尔曼，1 = 互补滤波，2 = Mahony四元数；上电默认值，运行中可用"set filter"切换
+#ifndef ATTITUDE_FILTER
+#define ATTITUDE_FILTER 0
+#endif
+#define COMP_TIME_CONSTANT 0.5   // 互补滤波时间常数（秒）：更快的变化信任陀螺仪，更慢的信任加速度计
+#define COMP_KI 0.5              // 互补滤波零偏估计积分增益（1/s²）
+#define MAHONY_KP 2.0            // Mahony比例增益（1/s），约等于互补滤波时间常数的倒数
+#define MAHONY_KI 0.5            // Mahony积分增益（1/s²）
+
+// 传感器参数
+#define IMU_SAMPLE_RATE_HZ 1000  // MPU6050采样频率（Hz）
+#define IMU_DLPF_CFG 3           // 数字低通滤波：3 = 加速度计44Hz/陀螺仪42Hz
+#define IMU_FIFO_MODE 1          // 1：片上FIFO缓存，每个控制周期批量读取并平均；0：每次数据就绪单独DMA读取
+
+// 传感器校准（calibration.h）：陀螺仪零偏、加速度计零偏/标度、安装角保存在闪存最后一页（STM32F103C8，1KB），
+// 链接脚本不能把程序放进这一页。上电读取，温度与校准时相差超过CALIB_TEMP_DELTA或数据无效时重新校准陀螺仪
+#ifndef CALIB_FLASH_ADDR
+#define CALIB_FLASH_ADDR (FLASH_BASE + 0xFC00)
+#endif
+#define CALIB_TIME_MS 2000           // 每次校准的采集时间（毫秒），在控制中断中进行，期间电机不输出
+#define CALIB_TEMP_DELTA 10.0        // 重新校准陀螺仪的温度变化（°C）
+#define CALIB_GYRO_MAX_STD 0.5       // 陀螺仪校准时角速度标准差上限（°/s），超过视为车体在动，重新采集
+
+// 参数存储（paramstore.h）：PID增益、卡尔曼Q/R、死区、最大输出、目标角以日志方式追加在校准页之前的两页闪存中，
+// 一页写满后把最新值整理到另一页（两页轮流擦除）。串口修改立即生效，写入推迟到主循环：
+// 每条记录紧跟在控制周期之后写入，需要擦除的整理只在电机不输出时（倒地或校准中）进行
+#ifndef PARAM_FLASH_ADDR
+#define PARAM_FLASH_ADDR (FLASH_BASE + 0xF400)   // 占两页：PARAM_FLASH_ADDR 和 PARAM_FLASH_ADDR + FLASH_PAGE_SIZE
+#endif
+#define PARAM_WRITE_WINDOW_US 1000   // 控制周期开始后多长时间内允许写入一条记录（微秒，一条约200µs）
+
+// 数学库：1 = 单精度快速atan2/平方根（fastmath.h），0 = 标准库双精度函数（可在编译命令中覆盖）
+#ifndef USE_FAST_MATH
+#define USE_FAST_MATH 1
+#endif
+
+// 控制算法数值格式：1 = 卡尔曼滤波和PID使用定点运算（fixedpoint.h），0 = 单精度浮点（可在编译命令中覆盖）
+#ifndef CONTROL_FIXED_POINT
+#define CONTROL_FIXED_POINT 0
+#endif
+
+// 分段耗时统计：1 = 控制循环各阶段记录DWT周期数（profiler.h，"get profile"命令输出），0 = 探针编译为空
+#ifndef PROFILER_ENABLE
+#define PROFILER_ENABLE 1
+#endif
+
+// 电机PWM（TIM1，72MHz不分频）：频率在听觉范围以上，每个周期 MOTOR_PWM_PERIOD 个计数（20kHz为3600，10kHz为7200）
+#define MOTOR_PWM_FREQ_HZ 20000
+#define MOTOR_PWM_PERIOD (72000000 / MOTOR_PWM_FREQ_HZ)
+
+// 控制输出单位：千分之一占空比，满量程MOTOR_OUTPUT_RANGE为100%，与PWM频率无关（电机模块换算为比较值）
+// 电机死区补偿：非零输出加上DEAD_ZONE（车轮刚好开始转动的占空比，按标称电压计）再按比例压缩到满量程，
+// 小输出不再被丢弃；|输出|小于MOTOR_DEADBAND_RAMP时补偿量线性减小到0，输出在零点两侧连续，不会来回跳变
+#define MOTOR_OUTPUT_RANGE 1000
+#define MOTOR_DEADBAND_RAMP 5.0
 
 // 控制参数
-#define MAX_OUTPUT 255   // 最大输出限制
-#define DEAD_ZONE 2.0    // 死区范围（度）
-#define SAMPLE_TIME 10   // 采样时间（毫秒）
+#define MAX_OUTPUT 1000  // 最大输出限制（控制输出单位，1000为100%占空比）
+#define DEAD_ZONE 2.0    // 电机死区补偿（控制输出单位）
+#define CONTROL_RATE_HZ 200   // 控制循环频率（Hz），由TIM4更新中断驱动，可选200/500/1000
+#define TELEMETRY_RATE_HZ 50  // 串口遥测频率（Hz），在主循环后台发送
+
+// 编码器参数：每个控制周期采样一次计数器，按M/T法测速
+#define ENCODER_COUNTS_PER_REV 1560.0f  // 车轮每转编码器计数（13线 × 4倍频 × 30减速比）
+#define ENCODER_MIN_COUNTS 4            // 测速窗口内至少累计的计数，不足时延长窗口（低速）
+#define ENCODER_MAX_WINDOW 0.1f         // 最长测速窗口（秒），超过后按窗口内计数计算（可为0）
+#define ENCODER_VELOCITY_ALPHA 0.3f     // 速度一阶低通滤波系数（0~1，越小越平滑）
 
-// 安全参数
-#define MAX_ANGLE 45.0   // 最大允许角度
+// 串级控制参数：直立环每个控制周期运行，速度环和转向环按各自频率分频运行（须为CONTROL_RATE_HZ的约数）
+#define VELOCITY_RATE_HZ 50      // 速度环频率（Hz）
+#define VELOCITY_KP 2.0          // 速度环比例系数（度 / (转/秒)）
+#define VELOCITY_KI 0.5          // 速度环积分系数（度 / 转，积分项相当于位置保持）
+#define VELOCITY_MAX_ANGLE 8.0   // 速度环给出的最大目标角偏移（度）
+#define STEERING_RATE_HZ 100     // 转向环频率（Hz）
+#define STEERING_KP 40.0         // 转向环比例系数（控制输出单位 / (转/秒)）
+#define STEERING_KI 40.0         // 转向环积分系数（控制输出单位 / 转，消除轮速差静差）
+#define STEERING_MAX_OUTPUT 60   // 转向环最大差速输出（控制输出单位，60为6%占空比）
+
+// 安全参数：倾角与目标角相差超过MAX_ANGLE判定倒地，电机停止、各环状态清零；扶起到与目标角相差RECOVER_ANGLE以内
+// 并保持RECOVER_TIME_MS后重新开始平衡（上电时在RECOVER_ANGLE以内则直接开始）
+#define MAX_ANGLE 45.0   // 最大允许角度（度，相对目标角）
+#define RECOVER_ANGLE 15.0       // 扶起判定角度（度，相对目标角）
+#define RECOVER_TIME_MS 500      // 扶起后保持时间（毫秒）
+
+// 电池电压（battery.h）：ADC1连续转换、DMA循环写入缓冲区，控制中断每周期求平均并低通滤波。
+// 电机输出按 BATTERY_NOMINAL_VOLTAGE / 电压 补偿，电量变化时同一控制输出对应的电机电压不变；
+// 电压低于MIN_VOLTAGE持续BATTERY_CUTOFF_MS后停机，回到BATTERY_RESUME_VOLTAGE以上才恢复（停机后电压会回升，不能只看MIN_VOLTAGE）
+#ifndef BATTERY_COMPENSATION
+#define BATTERY_COMPENSATION 1
+#endif
+#define BATTERY_NOMINAL_VOLTAGE 7.4  // 标称电压（V，2S锂电池），PID增益按此电压整定
+#define BATTERY_DIVIDER 3.0          // 分压比（20k/10k：电池电压 = ADC引脚电压 × 3）
+#define BATTERY_ADC_SAMPLES 16       // DMA缓冲区采样数（每次转换约21µs，缓冲区约0.34ms刷新一遍）
+#define BATTERY_FILTER_TIME 0.2      // 电压低通滤波时间常数（秒），滤掉电机电流引起的波动
+#define BATTERY_COMP_MIN 0.8         // 补偿系数下限（满电8.4V约为0.88）
+#define BATTERY_COMP_MAX 1.25        // 补偿系数上限（防止电压读数异常时输出过大）
 #define MIN_VOLTAGE 6.0  // 最低工作电压
+#define BATTERY_CUTOFF_MS 1000       // 低于MIN_VOLTAGE多长时间后停机（毫秒，忽略加速时的短暂压降）
+#define BATTERY_RESUME_VOLTAGE 6.8   // 停机后恢复的电压（V，更换或充电后）
+
+// 黑匣子：每个控制周期记录一条（36字节），角度与目标角相差超过MAX_ANGLE时冻结，"get blackbox"导出
+// 记录条数决定回看时长（BLACKBOX_RECORDS / CONTROL_RATE_HZ 秒）和RAM占用
+#ifndef BLACKBOX_ENABLE
+#define BLACKBOX_ENABLE 1
+#endif
+#define BLACKBOX_RECORDS 200     // 200条 = 7200字节，200Hz下约1秒
 
 #endif
\ No newline at end of file
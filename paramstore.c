@@ -0,0 +1,306 @@
+#include "paramstore.h"
+#include "calibration.h"
+#include "crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+#define PARAM_PAGES     2
+#define PARAM_NONE      0xFF        // 没有有效页
+#define PARAM_RECORDS   ((FLASH_PAGE_SIZE - sizeof(ParamStore_HeaderTypeDef)) / sizeof(ParamStore_RecordTypeDef))
+#define PARAM_EMPTY     0xFFFFU     // 擦除后的半字
+
+// 页和记录的闪存地址
+#define PARAM_PAGE_ADDR(page)           (PARAM_FLASH_ADDR + (page) * FLASH_PAGE_SIZE)
+#define PARAM_RECORD_ADDR(page, index)  (PARAM_PAGE_ADDR(page) + sizeof(ParamStore_HeaderTypeDef) + \
+                                         (index) * sizeof(ParamStore_RecordTypeDef))
+
+#define PARAM_MASK(id)      (1U << (id))
+#define PARAM_PID_MASK      (PARAM_MASK(PARAM_KP) | PARAM_MASK(PARAM_KI) | PARAM_MASK(PARAM_KD))
+#define PARAM_KALMAN_MASK   (PARAM_MASK(PARAM_Q_ANGLE) | PARAM_MASK(PARAM_Q_GYRO) | PARAM_MASK(PARAM_R_ANGLE))
+#define PARAM_MOTOR_MASK    (PARAM_MASK(PARAM_DEAD_ZONE) | PARAM_MASK(PARAM_MAX_OUTPUT))
+#define PARAM_ALL_MASK      (PARAM_MASK(PARAM_COUNT) - 1U)
+
+// 参数表：串口命令中的名称、parameters.h中的默认值、允许范围（超出范围的设置和闪存记录都不接受）
+typedef struct {
+    const char *name;
+    float def;
+    float min;
+    float max;
+} ParamStore_InfoTypeDef;
+
+static const ParamStore_InfoTypeDef param_info[PARAM_COUNT] = {
+    {"kp",       PID_KP,     0.0f,        1000.0f},
+    {"ki",       PID_KI,     0.0f,        100.0f},
+    {"kd",       PID_KD,     0.0f,        100.0f},
+    {"qangle",   Q_ANGLE,    1e-6f,       1.0f},
+    {"qgyro",    Q_GYRO,     1e-6f,       1.0f},
+    {"rangle",   R_ANGLE,    1e-6f,       10.0f},
+    {"deadzone", DEAD_ZONE,  0.0f,        100.0f},
+    {"maxout",   MAX_OUTPUT, 0.0f,        MOTOR_OUTPUT_RANGE},  // 不超过满量程（100%占空比）
+    {"angle",    0.0f,       -MAX_ANGLE,  MAX_ANGLE},   // 默认值为校准得到的安装角
+};
+
+static Control_HandleTypeDef *param_ctrl = NULL;
+static Attitude_HandleTypeDef *param_att = NULL;
+static float param_values[PARAM_COUNT];     // 当前生效的参数值
+
+static uint16_t param_stored = 0;           // 当前页中有记录的参数
+static uint16_t param_dirty = 0;            // 已修改、尚未写入闪存的参数
+static uint8_t param_compact = 0;           // 需要整理换页（"reset params"清除全部记录）
+static uint8_t param_page = PARAM_NONE;     // 当前页
+static uint16_t param_sequence = 0;         // 当前页序号
+static uint16_t param_next = 0;             // 当前页下一条空记录
+
+static const ParamStore_HeaderTypeDef *ParamStore_Header(uint8_t page) {
+    return (const ParamStore_HeaderTypeDef *)PARAM_PAGE_ADDR(page);
+}
+
+static const ParamStore_RecordTypeDef *ParamStore_Records(uint8_t page) {
+    return (const ParamStore_RecordTypeDef *)PARAM_RECORD_ADDR(page, 0);
+}
+
+static uint8_t ParamStore_PageValid(uint8_t page) {
+    const ParamStore_HeaderTypeDef *header = ParamStore_Header(page);
+    return header->magic == PARAM_STORE_MAGIC && header->version == PARAM_STORE_VERSION;
+}
+
+// 整页为擦除状态（不必再擦除即可写入）
+static uint8_t ParamStore_PageBlank(uint8_t page) {
+    const uint32_t *word = (const uint32_t *)PARAM_PAGE_ADDR(page);
+    for (uint16_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (word[i] != 0xFFFFFFFFU) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint16_t ParamStore_RecordCrc(const ParamStore_RecordTypeDef *record) {
+    return CRC16_Compute((const uint8_t *)record, offsetof(ParamStore_RecordTypeDef, crc));
+}
+
+static uint8_t ParamStore_InRange(ParamStore_IdTypeDef id, float value) {
+    return value >= param_info[id].min && value <= param_info[id].max;  // NaN不通过
+}
+
+static float ParamStore_Default(ParamStore_IdTypeDef id) {
+    return (id == PARAM_TARGET_ANGLE) ? Calibration_Get()->mount_angle : param_info[id].def;
+}
+
+// 把参数值写入各模块（mask为改变的参数）；卡尔曼Q/R改变时重新求稳态增益
+static void ParamStore_Apply(uint16_t mask) {
+    const float *v = param_values;
+    
+    if (mask & PARAM_PID_MASK) {
+        __disable_irq();
+        PID_SetTunings(&param_ctrl->angle, v[PARAM_KP], v[PARAM_KI], v[PARAM_KD]);
+        __enable_irq();
+    }
+    if (mask & PARAM_KALMAN_MASK) {
+        Kalman_SetNoise(&param_att->kalman, v[PARAM_Q_ANGLE], v[PARAM_Q_GYRO], v[PARAM_R_ANGLE]);
+    }
+    if (mask & PARAM_MOTOR_MASK) {
+        __disable_irq();
+        Motor_SetLimits(param_ctrl->hmotor, v[PARAM_DEAD_ZONE], v[PARAM_MAX_OUTPUT]);
+        PID_SetLimits(&param_ctrl->angle, -v[PARAM_MAX_OUTPUT], v[PARAM_MAX_OUTPUT]);
+        __enable_irq();
+    }
+    if (mask & PARAM_MASK(PARAM_TARGET_ANGLE)) {
+        param_ctrl->target_angle = v[PARAM_TARGET_ANGLE];
+    }
+}
+
+// 逐半字写入（调用者已解锁闪存）
+static HAL_StatusTypeDef ParamStore_Program(uint32_t address, const uint16_t *data, uint16_t count) {
+    HAL_StatusTypeDef status = HAL_OK;
+    for (uint16_t i = 0; status == HAL_OK && i < count; i++) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address + 2 * i, data[i]);
+    }
+    return status;
+}
+
+// 在page的第index条写入参数id的当前值（CRC是最后一个半字）
+static HAL_StatusTypeDef ParamStore_WriteRecord(uint8_t page, uint16_t index, ParamStore_IdTypeDef id) {
+    ParamStore_RecordTypeDef record;
+    
+    record.key = id;
+    memcpy(record.value, &param_values[id], sizeof(record.value));
+    record.crc = ParamStore_RecordCrc(&record);
+    
+    HAL_StatusTypeDef status = ParamStore_Program(PARAM_RECORD_ADDR(page, index), (const uint16_t *)&record,
+                                                  sizeof(record) / 2);
+    if (status == HAL_OK && memcmp(&ParamStore_Records(page)[index], &record, sizeof(record)) != 0) {
+        status = HAL_ERROR;
+    }
+    return status;
+}
+
+// 整理换页：擦除另一页，写入所有已保存和待写入参数的最新值，最后写页头使新页生效
+static void ParamStore_Compact(void) {
+    uint8_t page = (param_page == 0) ? 1 : 0;
+    uint16_t mask = param_stored | param_dirty;
+    uint16_t count = 0;
+    ParamStore_HeaderTypeDef header;
+    FLASH_EraseInitTypeDef erase;
+    uint32_t page_error;
+    HAL_StatusTypeDef status = HAL_OK;
+    
+    header.version = PARAM_STORE_VERSION;
+    header.sequence = (param_page == PARAM_NONE) ? 1 : (uint16_t)(param_sequence + 1);
+    header.magic = PARAM_STORE_MAGIC;
+    
+    HAL_FLASH_Unlock();
+    if (!ParamStore_PageBlank(page)) {
+        memset(&erase, 0, sizeof(erase));
+        erase.TypeErase = FLASH_TYPEERASE_PAGES;
+        erase.Banks = FLASH_BANK_1;
+        erase.PageAddress = PARAM_PAGE_ADDR(page);
+        erase.NbPages = 1;
+        status = HAL_FLASHEx_Erase(&erase, &page_error);
+    }
+    for (uint8_t id = 0; status == HAL_OK && id < PARAM_COUNT; id++) {
+        if (mask & PARAM_MASK(id)) {
+            status = ParamStore_WriteRecord(page, count++, (ParamStore_IdTypeDef)id);
+        }
+    }
+    if (status == HAL_OK) {
+        status = ParamStore_Program(PARAM_PAGE_ADDR(page), (const uint16_t *)&header, sizeof(header) / 2);
+    }
+    HAL_FLASH_Lock();
+    
+    if (status != HAL_OK || !ParamStore_PageValid(page)) {
+        return;     // 旧页仍是当前页，下次再试
+    }
+    param_page = page;
+    param_sequence = header.sequence;
+    param_next = count;
+    param_stored = mask;
+    param_dirty = 0;
+    param_compact = 0;
+}
+
+// 载入参数并写入各模块（各模块和校准值须已初始化）：找出序号最大的有效页，逐条读取记录
+void ParamStore_Init(Control_HandleTypeDef *hctrl, Attitude_HandleTypeDef *hatt) {
+    param_ctrl = hctrl;
+    param_att = hatt;
+    for (uint8_t id = 0; id < PARAM_COUNT; id++) {
+        param_values[id] = ParamStore_Default((ParamStore_IdTypeDef)id);
+    }
+    param_stored = 0;
+    param_dirty = 0;
+    param_compact = 0;
+    param_page = PARAM_NONE;
+    param_next = 0;
+    
+    for (uint8_t page = 0; page < PARAM_PAGES; page++) {
+        uint16_t sequence = ParamStore_Header(page)->sequence;
+        if (ParamStore_PageValid(page) &&
+            (param_page == PARAM_NONE || (int16_t)(sequence - param_sequence) > 0)) {
+            param_page = page;
+            param_sequence = sequence;
+        }
+    }
+    if (param_page == PARAM_NONE) {
+        return;
+    }
+    
+    // 同一参数以最后一条为准；CRC不对（写到一半掉电）或超出范围的记录跳过，但仍占用位置
+    const ParamStore_RecordTypeDef *records = ParamStore_Records(param_page);
+    while (param_next < PARAM_RECORDS && records[param_next].key != PARAM_EMPTY) {
+        const ParamStore_RecordTypeDef *record = &records[param_next++];
+        float value;
+        memcpy(&value, record->value, sizeof(value));
+        if (record->key < PARAM_COUNT && record->crc == ParamStore_RecordCrc(record) &&
+            ParamStore_InRange((ParamStore_IdTypeDef)record->key, value)) {
+            param_values[record->key] = value;
+            param_stored |= PARAM_MASK(record->key);
+        }
+    }
+    ParamStore_Apply(param_stored);
+}
+
+// 修改参数（主循环中调用）：检查范围后立即生效，闪存记录由ParamStore_Poll稍后写入；超出范围返回0
+uint8_t ParamStore_Set(ParamStore_IdTypeDef id, float value) {
+    if (id >= PARAM_COUNT || !ParamStore_InRange(id, value)) {
+        return 0;
+    }
+    if (value == param_values[id] && (param_stored & PARAM_MASK(id))) {
+        return 1;   // 与已保存的值相同，不必再写
+    }
+    param_values[id] = value;
+    param_dirty |= PARAM_MASK(id);
+    ParamStore_Apply(PARAM_MASK(id));
+    return 1;
+}
+
+float ParamStore_Get(ParamStore_IdTypeDef id) {
+    return (id < PARAM_COUNT) ? param_values[id] : 0.0f;
+}
+
+uint8_t ParamStore_IsStored(ParamStore_IdTypeDef id) {
+    return (id < PARAM_COUNT) && (param_stored & PARAM_MASK(id)) && !(param_dirty & PARAM_MASK(id));
+}
+
+void ParamStore_GetRange(ParamStore_IdTypeDef id, float *min, float *max) {
+    *min = param_info[id].min;
+    *max = param_info[id].max;
+}
+
+// 全部恢复默认值并立即生效；已保存的记录在下一次整理换页时清除
+void ParamStore_Reset(void) {
+    for (uint8_t id = 0; id < PARAM_COUNT; id++) {
+        param_values[id] = ParamStore_Default((ParamStore_IdTypeDef)id);
+    }
+    param_stored = 0;
+    param_dirty = 0;
+    param_compact = (param_page != PARAM_NONE && param_next > 0);
+    ParamStore_Apply(PARAM_ALL_MASK);
+}
+
+// 主循环中调用：write_window表示控制周期刚结束（写入一条记录不会与下一次控制中断重叠），
+// motor_idle表示电机不输出（可以擦除）。每次最多写一条记录或做一次整理换页
+void ParamStore_Poll(uint8_t write_window, uint8_t motor_idle) {
+    if ((param_dirty == 0 && !param_compact) || !write_window) {
+        return;
+    }
+    
+    if (param_compact || param_page == PARAM_NONE || param_next >= PARAM_RECORDS) {
+        if (motor_idle) {
+            ParamStore_Compact();
+        }
+        return;
+    }
+    
+    uint8_t id = 0;
+    while (!(param_dirty & PARAM_MASK(id))) {
+        id++;
+    }
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = ParamStore_WriteRecord(param_page, param_next, (ParamStore_IdTypeDef)id);
+    HAL_FLASH_Lock();
+    
+    // 写失败的记录CRC不对，载入时跳过；参数保持待写入，下次写在后一条
+    param_next++;
+    if (status == HAL_OK) {
+        param_dirty &= ~PARAM_MASK(id);
+        param_stored |= PARAM_MASK(id);
+    }
+}
+
+// 待写入闪存的参数个数
+uint16_t ParamStore_Pending(void) {
+    uint16_t count = 0;
+    for (uint8_t id = 0; id < PARAM_COUNT; id++) {
+        count += (param_dirty >> id) & 1U;
+    }
+    return count;
+}
+
+// 当前页已用的记录条数（一页PARAM_RECORDS条，写满后整理换页）
+uint16_t ParamStore_Used(void) {
+    return (param_page == PARAM_NONE) ? 0 : param_next;
+}
+
+const char *ParamStore_GetName(ParamStore_IdTypeDef id) {
+    return (id < PARAM_COUNT) ? param_info[id].name : "unknown";
+}
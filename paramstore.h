@@ -0,0 +1,65 @@
+#ifndef PARAMSTORE_H
+#define PARAMSTORE_H
+
+#include "stm32f1xx_hal.h"
+#include "control.h"
+#include "attitude.h"
+#include "parameters.h"
+
+// 参数存储：可调参数保存在闪存 PARAM_FLASH_ADDR 处的两页中，上电载入，修改后不必重新编译
+//
+// 每页开头是页头（版本、序号、魔数），其后按半字追加8字节的记录（参数编号、浮点值、CRC），
+// 同一参数以最后一条有效记录为准。页头最后写魔数，记录最后写CRC，写到一半掉电的页头或记录在载入时被忽略。
+// 当前页写满时把所有已保存参数的最新值写入另一页（先擦除），写完页头后新页序号更大，成为当前页；
+// 旧页留到下一次整理时再擦除，因此任何时刻掉电都至少有一页完整。一页可存127条记录，两页轮流擦除。
+//
+// 上电时ParamStore_Init扫描当前页（最多127条，约0.1ms），把保存过的参数写入各模块；
+// 没保存过的参数保持parameters.h中的值（目标角为校准得到的安装角）。
+// ParamStore_Set在主循环中修改参数并立即生效，记录由ParamStore_Poll在主循环中写入：
+// 每次只写一条（4个半字，约200µs，编程期间CPU取指暂停），只在控制周期刚结束时进行，不会推迟控制中断；
+// 整理换页要擦除一页（约20ms），只在电机不输出时进行，此前修改的参数已生效，只是暂不保存。
+
+#define PARAM_STORE_MAGIC   0x534D5250U     // "PRMS"
+#define PARAM_STORE_VERSION 1               // 参数编号的含义改变时加1，旧数据不再载入
+
+// 参数编号（保存在闪存中，只能在末尾添加）
+typedef enum {
+    PARAM_KP = 0,           // 直立环比例系数
+    PARAM_KI,               // 直立环积分系数
+    PARAM_KD,               // 直立环微分系数
+    PARAM_Q_ANGLE,          // 卡尔曼过程噪声协方差（角度）
+    PARAM_Q_GYRO,           // 卡尔曼过程噪声协方差（陀螺仪）
+    PARAM_R_ANGLE,          // 卡尔曼测量噪声协方差
+    PARAM_DEAD_ZONE,        // 电机死区
+    PARAM_MAX_OUTPUT,       // 最大输出（电机和直立环限幅）
+    PARAM_TARGET_ANGLE,     // 直立环目标角（度）
+    PARAM_COUNT
+} ParamStore_IdTypeDef;
+
+// 页头（8字节，按半字写入，魔数最后写）
+typedef struct {
+    uint16_t version;
+    uint16_t sequence;      // 每次整理换页加1，两页都有效时序号大的是当前页
+    uint32_t magic;
+} ParamStore_HeaderTypeDef;
+
+// 记录（8字节，按半字写入，CRC最后写；参数编号为0xFFFF表示页中此后为空）
+typedef struct {
+    uint16_t key;           // 参数编号
+    uint16_t value[2];      // 浮点值的位模式，低半字在前
+    uint16_t crc;           // CRC-16/CCITT-FALSE（key和value）
+} ParamStore_RecordTypeDef;
+
+// 函数声明
+void ParamStore_Init(Control_HandleTypeDef *hctrl, Attitude_HandleTypeDef *hatt);
+uint8_t ParamStore_Set(ParamStore_IdTypeDef id, float value);
+float ParamStore_Get(ParamStore_IdTypeDef id);
+uint8_t ParamStore_IsStored(ParamStore_IdTypeDef id);
+void ParamStore_GetRange(ParamStore_IdTypeDef id, float *min, float *max);
+void ParamStore_Reset(void);
+void ParamStore_Poll(uint8_t write_window, uint8_t motor_idle);
+uint16_t ParamStore_Pending(void);
+uint16_t ParamStore_Used(void);
+const char *ParamStore_GetName(ParamStore_IdTypeDef id);
+
+#endif
\ No newline at end of file
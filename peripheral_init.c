@@ -1,13 +1,23 @@
 #include "main.h"
 #include "stm32f1xx_hal.h"
 #include "pins.h"
+#include "parameters.h"
+#include "mpu6050.h"
 
 // 外设句柄定义
 extern I2C_HandleTypeDef hi2c1;
 extern TIM_HandleTypeDef htim1;
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
 extern UART_HandleTypeDef huart1;
+extern ADC_HandleTypeDef hadc1;
+
+// DMA句柄（由MSP初始化关联到外设句柄）
+DMA_HandleTypeDef hdma_adc1;
+DMA_HandleTypeDef hdma_i2c1_rx;
+DMA_HandleTypeDef hdma_usart1_tx;
+DMA_HandleTypeDef hdma_usart1_rx;
 
 // GPIO初始化
 void MX_GPIO_Init(void) {
@@ -30,6 +40,55 @@ void MX_GPIO_Init(void) {
     GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
     GPIO_InitStruct.Pull = GPIO_PULLUP;
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    // 配置MPU6050数据就绪中断引脚（INT默认推挽高电平有效）
+    GPIO_InitStruct.Pin = MPU6050_INT_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+    GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+    HAL_GPIO_Init(MPU6050_INT_PORT, &GPIO_InitStruct);
+
+    // 数据就绪只发起DMA传输，优先级最高
+    HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+}
+
+// DMA初始化
+void MX_DMA_Init(void) {
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    // DMA1通道1：ADC1（循环模式，电池电压采样），结果只在控制中断中读取，不开中断
+
+    // DMA1通道7：I2C1_RX
+    HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+
+    // DMA1通道4：USART1_TX，与串口中断同级，低于控制循环
+    HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+
+    // DMA1通道5：USART1_RX（循环模式，半满/全满时搬运数据）
+    HAL_NVIC_SetPriority(DMA1_Channel5_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+}
+
+// ADC1初始化（电池电压）：单通道连续转换，每次转换 (239.5 + 12.5) / 12MHz = 21µs，结果由DMA循环搬运
+void MX_ADC1_Init(void) {
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    hadc1.Instance = ADC1;
+    hadc1.Init.ScanConvMode = ADC_SCAN_DISABLE;
+    hadc1.Init.ContinuousConvMode = ENABLE;
+    hadc1.Init.DiscontinuousConvMode = DISABLE;
+    hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+    hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+    hadc1.Init.NbrOfConversion = 1;
+    HAL_ADC_Init(&hadc1);
+
+    // 最长采样时间：分压电阻的输出阻抗较高，采样电容需要充分充电
+    sConfig.Channel = BATTERY_ADC_CHANNEL;
+    sConfig.Rank = ADC_REGULAR_RANK_1;
+    sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
+    HAL_ADC_ConfigChannel(&hadc1, &sConfig);
 }
 
 // I2C1初始化
@@ -54,19 +113,19 @@ void MX_TIM1_Init(void) {
     TIM_BreakDeadTimeConfigTypeDef sBreakDeadTimeConfig = {0};
 
     htim1.Instance = TIM1;
-    htim1.Init.Prescaler = 71; // 72MHz / (71+1) = 1MHz
+    htim1.Init.Prescaler = 0;  // 72MHz不分频，占空比分辨率为一个定时器时钟
     htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
-    htim1.Init.Period = 999;   // 1MHz / 1000 = 1kHz PWM频率
+    htim1.Init.Period = MOTOR_PWM_PERIOD - 1;  // 72MHz / MOTOR_PWM_PERIOD = MOTOR_PWM_FREQ_HZ
     htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
     htim1.Init.RepetitionCounter = 0;
-    htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
     HAL_TIM_PWM_Init(&htim1);
 
     sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
     HAL_TIM_ConfigClockSource(&htim1, &sClockSourceConfig);
 
-    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_1);
-    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_2);
+    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, MOTOR_A_CHANNEL);
+    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, MOTOR_B_CHANNEL);
 
     sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
     sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
@@ -89,8 +148,8 @@ void MX_TIM1_Init(void) {
     sConfigOC.OCIdleState = TIM_OCIDLESTATE_RESET;
     sConfigOC.OCNIdleState = TIM_OCNIDLESTATE_RESET;
 
-    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_1);
-    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_2);
+    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, MOTOR_A_CHANNEL);
+    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, MOTOR_B_CHANNEL);
 }
 
 // TIM2编码器初始化（左电机）
@@ -147,6 +206,38 @@ void MX_TIM3_Init(void) {
     HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig);
 }
 
+// TIM4初始化（控制循环定时）
+void MX_TIM4_Init(void) {
+    TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+    TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+    htim4.Instance = TIM4;
+    htim4.Init.Prescaler = 71; // 72MHz / (71+1) = 1MHz
+    htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim4.Init.Period = 1000000 / CONTROL_RATE_HZ - 1; // 更新中断频率 = CONTROL_RATE_HZ
+    htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    HAL_TIM_Base_Init(&htim4);
+
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    HAL_TIM_ConfigClockSource(&htim4, &sClockSourceConfig);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim4, &sMasterConfig);
+
+#if IMU_FIFO_MODE
+    // 通道1比较中断：在更新中断前 MPU6050_FIFO_LEAD_US 开始读取FIFO
+    TIM_OC_InitTypeDef sConfigOC = {0};
+    HAL_TIM_OC_Init(&htim4);
+    sConfigOC.OCMode = TIM_OCMODE_TIMING;
+    sConfigOC.Pulse = 1000000 / CONTROL_RATE_HZ - MPU6050_FIFO_LEAD_US;
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    HAL_TIM_OC_ConfigChannel(&htim4, &sConfigOC, TIM_CHANNEL_1);
+#endif
+}
+
 // USART1初始化（串口调试）
 void MX_USART1_UART_Init(void) {
     huart1.Instance = USART1;
@@ -166,6 +257,32 @@ void HAL_MspInit(void) {
     __HAL_RCC_PWR_CLK_ENABLE();
 }
 
+// ADC MSP初始化
+void HAL_ADC_MspInit(ADC_HandleTypeDef* hadc) {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    if(hadc->Instance==ADC1) {
+        __HAL_RCC_ADC1_CLK_ENABLE();
+        __HAL_RCC_GPIOA_CLK_ENABLE();
+        
+        // PA4 - ADC1_IN4（电池分压）
+        GPIO_InitStruct.Pin = BATTERY_ADC_PIN;
+        GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+        HAL_GPIO_Init(BATTERY_ADC_PORT, &GPIO_InitStruct);
+        
+        // ADC1 DMA（循环模式，转换结果按半字写入电池模块的采样缓冲区）
+        hdma_adc1.Instance = DMA1_Channel1;
+        hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+        hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+        hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+        hdma_adc1.Init.Mode = DMA_CIRCULAR;
+        hdma_adc1.Init.Priority = DMA_PRIORITY_LOW;
+        HAL_DMA_Init(&hdma_adc1);
+        __HAL_LINKDMA(hadc, DMA_Handle, hdma_adc1);
+    }
+}
+
 // I2C MSP初始化
 void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c) {
     GPIO_InitTypeDef GPIO_InitStruct = {0};
@@ -178,13 +295,75 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c) {
         GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
         GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
         HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+        
+        // I2C1_RX DMA（MPU6050突发读取）
+        hdma_i2c1_rx.Instance = DMA1_Channel7;
+        hdma_i2c1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+        hdma_i2c1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_i2c1_rx.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_i2c1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        hdma_i2c1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        hdma_i2c1_rx.Init.Mode = DMA_NORMAL;
+        hdma_i2c1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+        HAL_DMA_Init(&hdma_i2c1_rx);
+        __HAL_LINKDMA(hi2c, hdmarx, hdma_i2c1_rx);
+        
+        // 地址阶段由I2C事件中断推进，错误中断用于总线异常恢复
+        HAL_NVIC_SetPriority(I2C1_EV_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+        HAL_NVIC_SetPriority(I2C1_ER_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
     }
 }
 
 // TIM MSP初始化
 void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef* htim_pwm) {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
     if(htim_pwm->Instance==TIM1) {
         __HAL_RCC_TIM1_CLK_ENABLE();
+        __HAL_RCC_GPIOA_CLK_ENABLE();
+        
+        // PA8 - TIM1_CH1, PA11 - TIM1_CH4（左右电机PWM）
+        GPIO_InitStruct.Pin = MOTOR_A_PWM_PIN|MOTOR_B_PWM_PIN;
+        GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+        GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+        HAL_GPIO_Init(MOTOR_PWM_PORT, &GPIO_InitStruct);
+    }
+}
+
+// TIM编码器MSP初始化
+void HAL_TIM_Encoder_MspInit(TIM_HandleTypeDef* htim_encoder) {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    if(htim_encoder->Instance==TIM2) {
+        __HAL_RCC_TIM2_CLK_ENABLE();
+        __HAL_RCC_GPIOA_CLK_ENABLE();
+        
+        // PA0 - TIM2_CH1, PA1 - TIM2_CH2（左编码器A/B相）
+        GPIO_InitStruct.Pin = ENCODER_A_PIN_A|ENCODER_A_PIN_B;
+        GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+        GPIO_InitStruct.Pull = GPIO_PULLUP;
+        HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    }
+    else if(htim_encoder->Instance==TIM3) {
+        __HAL_RCC_TIM3_CLK_ENABLE();
+        __HAL_RCC_GPIOA_CLK_ENABLE();
+        
+        // PA6 - TIM3_CH1, PA7 - TIM3_CH2（右编码器A/B相）
+        GPIO_InitStruct.Pin = ENCODER_B_PIN_A|ENCODER_B_PIN_B;
+        GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+        GPIO_InitStruct.Pull = GPIO_PULLUP;
+        HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    }
+}
+
+// TIM Base MSP初始化
+void HAL_TIM_Base_MspInit(TIM_HandleTypeDef* htim_base) {
+    if(htim_base->Instance==TIM4) {
+        __HAL_RCC_TIM4_CLK_ENABLE();
+        
+        // 控制循环中断优先级高于串口
+        HAL_NVIC_SetPriority(TIM4_IRQn, 1, 0);
+        HAL_NVIC_EnableIRQ(TIM4_IRQn);
     }
 }
 
@@ -205,5 +384,33 @@ void HAL_UART_MspInit(UART_HandleTypeDef* huart) {
         GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
         GPIO_InitStruct.Pull = GPIO_NOPULL;
         HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+        
+        // USART1_TX DMA（遥测帧和文本从发送环形缓冲区直接发送）
+        hdma_usart1_tx.Instance = DMA1_Channel4;
+        hdma_usart1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        hdma_usart1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_usart1_tx.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_usart1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        hdma_usart1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        hdma_usart1_tx.Init.Mode = DMA_NORMAL;
+        hdma_usart1_tx.Init.Priority = DMA_PRIORITY_LOW;
+        HAL_DMA_Init(&hdma_usart1_tx);
+        __HAL_LINKDMA(huart, hdmatx, hdma_usart1_tx);
+        
+        // USART1_RX DMA（循环模式，配合空闲线检测接收不定长命令）
+        hdma_usart1_rx.Instance = DMA1_Channel5;
+        hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+        hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
+        hdma_usart1_rx.Init.Priority = DMA_PRIORITY_LOW;
+        HAL_DMA_Init(&hdma_usart1_rx);
+        __HAL_LINKDMA(huart, hdmarx, hdma_usart1_rx);
+        
+        // 串口中断优先级低于控制循环
+        HAL_NVIC_SetPriority(USART1_IRQn, 2, 0);
+        HAL_NVIC_EnableIRQ(USART1_IRQn);
     }
 }
\ No newline at end of file
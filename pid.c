@@ -1,7 +1,168 @@
 #include "pid.h"
 #include "stm32f1xx_hal.h"
+#include "fixedpoint.h"
 #include <math.h>
 
+// PID计算（以HAL_GetTick计算dt，分辨率1ms）
+float PID_Calculate(PID_HandleTypeDef *hpid, float setpoint, float input) {
+    uint32_t current_time = HAL_GetTick();
+    float dt = (current_time - hpid->last_time) / 1000.0f; // 转换为秒
+    
+    if (dt <= 0) {
+        return PID_GetOutput(hpid); // 时间未变化，返回上次输出
+    }
+    
+    hpid->last_time = current_time;
+    return PID_CalculateDt(hpid, setpoint, input, dt);
+}
+
+#if CONTROL_FIXED_POINT
+// 积分限幅随输出限幅和ki变化，在修改时计算；ki为0时不限幅
+static void PID_UpdateIntegralLimits(PID_HandleTypeDef *hpid, float output_min, float output_max, float ki) {
+    if (ki == 0.0f) {
+        hpid->integral_min = INT32_MIN;
+        hpid->integral_max = INT32_MAX;
+    } else {
+        hpid->integral_min = Fixed_FromFloat(output_min / ki, FIXED_Q16);
+        hpid->integral_max = Fixed_FromFloat(output_max / ki, FIXED_Q16);
+    }
+}
+
+// PID控制器初始化
+void PID_Init(PID_HandleTypeDef *hpid, float kp, float ki, float kd) {
+    hpid->kp = Fixed_FromFloat(kp, FIXED_Q16);
+    hpid->ki = Fixed_FromFloat(ki, FIXED_Q16);
+    hpid->kd = Fixed_FromFloat(kd, FIXED_Q16);
+    
+    hpid->setpoint = 0;
+    hpid->integral = 0;
+    hpid->prev_error = 0;
+    hpid->output = 0;
+    hpid->p_term = 0;
+    hpid->i_term = 0;
+    hpid->d_term = 0;
+    
+    // 设置默认输出限制
+    hpid->output_min = Fixed_FromFloat(-MAX_OUTPUT, FIXED_Q16);
+    hpid->output_max = Fixed_FromFloat(MAX_OUTPUT, FIXED_Q16);
+    PID_UpdateIntegralLimits(hpid, -MAX_OUTPUT, MAX_OUTPUT, ki);
+    
+    hpid->last_time = HAL_GetTick();
+}
+
+// 设置输出限制
+void PID_SetLimits(PID_HandleTypeDef *hpid, float min, float max) {
+    hpid->output_min = Fixed_FromFloat(min, FIXED_Q16);
+    hpid->output_max = Fixed_FromFloat(max, FIXED_Q16);
+    PID_UpdateIntegralLimits(hpid, min, max, Fixed_ToFloat(hpid->ki, FIXED_Q16));
+}
+
+// PID计算（定点版本，dt由调用者在采样时刻给出，单位秒）
+// 浮点接口只在入口和出口做整数位域转换，计算本身在PID_CalculateQ中全部为定点运算
+float PID_CalculateDt(PID_HandleTypeDef *hpid, float setpoint, float input, float dt) {
+    return Fixed_ToFloat(PID_CalculateQ(hpid, Fixed_FromFloat(setpoint, FIXED_Q16), Fixed_FromFloat(input, FIXED_Q16),
+                                        Fixed_FromFloat(dt, FIXED_Q30)),
+                         FIXED_Q16);
+}
+
+// PID计算（目标值、输入Q16.16，dt为Q2.30秒），返回Q16.16输出
+// 只有32x32→64位乘法和一次32位除法（Cortex-M3硬件除法），没有64位除法，不经过软件浮点库
+int32_t PID_CalculateQ(PID_HandleTypeDef *hpid, int32_t setpoint, int32_t input, int32_t dt_q) {
+    if (dt_q <= 0) {
+        return hpid->output;
+    }
+    
+    hpid->setpoint = setpoint;
+    
+    // 计算误差
+    int32_t error = Fixed_Sub(setpoint, input);
+    
+    // 比例项
+    int32_t proportional = Fixed_Mul(hpid->kp, error, FIXED_Q16);
+    
+    // 积分项（抗积分饱和）
+    hpid->integral = Fixed_Add(hpid->integral, Fixed_Mul(error, dt_q, FIXED_Q30));
+    
+    // 积分限幅
+    if (hpid->integral > hpid->integral_max) {
+        hpid->integral = hpid->integral_max;
+    } else if (hpid->integral < hpid->integral_min) {
+        hpid->integral = hpid->integral_min;
+    }
+    
+    int32_t integral_term = Fixed_Mul(hpid->ki, hpid->integral, FIXED_Q16);
+    
+    // 微分项：dt降为Q8.24（分辨率0.06µs）后用32位除法求1/dt（Q24.8），误差变化量乘以1/dt
+    uint32_t dt_q24 = (uint32_t)dt_q >> (FIXED_Q30 - 24);
+    uint32_t inv_dt = 0xFFFFFFFFU / (dt_q24 ? dt_q24 : 1U);
+    int32_t derivative = Fixed_Sat(((int64_t)Fixed_Sub(error, hpid->prev_error) * inv_dt + (1 << 7)) >> 8);
+    int32_t derivative_term = Fixed_Mul(hpid->kd, derivative, FIXED_Q16);
+    
+    hpid->p_term = proportional;
+    hpid->i_term = integral_term;
+    hpid->d_term = derivative_term;
+    
+    // 计算输出
+    hpid->output = Fixed_Add(Fixed_Add(proportional, integral_term), derivative_term);
+    
+    // 输出限幅
+    if (hpid->output > hpid->output_max) {
+        hpid->output = hpid->output_max;
+    } else if (hpid->output < hpid->output_min) {
+        hpid->output = hpid->output_min;
+    }
+    
+    // 保存误差用于下次计算
+    hpid->prev_error = error;
+    
+    return hpid->output;
+}
+
+// 重置PID控制器
+void PID_Reset(PID_HandleTypeDef *hpid) {
+    hpid->integral = 0;
+    hpid->prev_error = 0;
+    hpid->output = 0;
+    hpid->p_term = 0;
+    hpid->i_term = 0;
+    hpid->d_term = 0;
+    hpid->last_time = HAL_GetTick();
+}
+
+// 设置PID参数
+void PID_SetTunings(PID_HandleTypeDef *hpid, float kp, float ki, float kd) {
+    hpid->kp = Fixed_FromFloat(kp, FIXED_Q16);
+    hpid->ki = Fixed_FromFloat(ki, FIXED_Q16);
+    hpid->kd = Fixed_FromFloat(kd, FIXED_Q16);
+    PID_UpdateIntegralLimits(hpid, Fixed_ToFloat(hpid->output_min, FIXED_Q16),
+                             Fixed_ToFloat(hpid->output_max, FIXED_Q16), ki);
+}
+
+// 读取PID参数
+void PID_GetTunings(PID_HandleTypeDef *hpid, float *kp, float *ki, float *kd) {
+    *kp = Fixed_ToFloat(hpid->kp, FIXED_Q16);
+    *ki = Fixed_ToFloat(hpid->ki, FIXED_Q16);
+    *kd = Fixed_ToFloat(hpid->kd, FIXED_Q16);
+}
+
+// 获取上次输出
+float PID_GetOutput(PID_HandleTypeDef *hpid) {
+    return Fixed_ToFloat(hpid->output, FIXED_Q16);
+}
+
+// 获取上次计算的P/I/D各项（遥测用）
+void PID_GetTerms(PID_HandleTypeDef *hpid, float *p_term, float *i_term, float *d_term) {
+    *p_term = Fixed_ToFloat(hpid->p_term, FIXED_Q16);
+    *i_term = Fixed_ToFloat(hpid->i_term, FIXED_Q16);
+    *d_term = Fixed_ToFloat(hpid->d_term, FIXED_Q16);
+}
+#else
+// 积分限幅随输出限幅和ki变化，在修改时计算，避免每次PID计算做两次除法
+static void PID_UpdateIntegralLimits(PID_HandleTypeDef *hpid) {
+    hpid->integral_min = hpid->output_min / hpid->ki;
+    hpid->integral_max = hpid->output_max / hpid->ki;
+}
+
 // PID控制器初始化
 void PID_Init(PID_HandleTypeDef *hpid, float kp, float ki, float kd) {
     hpid->kp = kp;
@@ -12,10 +173,14 @@ void PID_Init(PID_HandleTypeDef *hpid, float kp, float ki, float kd) {
     hpid->integral = 0.0f;
     hpid->prev_error = 0.0f;
     hpid->output = 0.0f;
+    hpid->p_term = 0.0f;
+    hpid->i_term = 0.0f;
+    hpid->d_term = 0.0f;
     
     // 设置默认输出限制
     hpid->output_min = -MAX_OUTPUT;
     hpid->output_max = MAX_OUTPUT;
+    PID_UpdateIntegralLimits(hpid);
     
     hpid->last_time = HAL_GetTick();
 }
@@ -24,18 +189,15 @@ void PID_Init(PID_HandleTypeDef *hpid, float kp, float ki, float kd) {
 void PID_SetLimits(PID_HandleTypeDef *hpid, float min, float max) {
     hpid->output_min = min;
     hpid->output_max = max;
+    PID_UpdateIntegralLimits(hpid);
 }
 
-// PID计算
-float PID_Calculate(PID_HandleTypeDef *hpid, float setpoint, float input) {
-    uint32_t current_time = HAL_GetTick();
-    float dt = (current_time - hpid->last_time) / 1000.0f; // 转换为秒
-    
+// PID计算（dt由调用者在采样时刻给出，单位秒）
+float PID_CalculateDt(PID_HandleTypeDef *hpid, float setpoint, float input, float dt) {
     if (dt <= 0) {
-        return hpid->output; // 时间未变化，返回上次输出
+        return hpid->output;
     }
     
-    hpid->last_time = current_time;
     hpid->setpoint = setpoint;
     
     // 计算误差
@@ -48,10 +210,10 @@ float PID_Calculate(PID_HandleTypeDef *hpid, float setpoint, float input) {
     hpid->integral += error * dt;
     
     // 积分限幅
-    if (hpid->integral > hpid->output_max / hpid->ki) {
-        hpid->integral = hpid->output_max / hpid->ki;
-    } else if (hpid->integral < hpid->output_min / hpid->ki) {
-        hpid->integral = hpid->output_min / hpid->ki;
+    if (hpid->integral > hpid->integral_max) {
+        hpid->integral = hpid->integral_max;
+    } else if (hpid->integral < hpid->integral_min) {
+        hpid->integral = hpid->integral_min;
     }
     
     float integral_term = hpid->ki * hpid->integral;
@@ -60,6 +222,10 @@ float PID_Calculate(PID_HandleTypeDef *hpid, float setpoint, float input) {
     float derivative = (error - hpid->prev_error) / dt;
     float derivative_term = hpid->kd * derivative;
     
+    hpid->p_term = proportional;
+    hpid->i_term = integral_term;
+    hpid->d_term = derivative_term;
+    
     // 计算输出
     hpid->output = proportional + integral_term + derivative_term;
     
@@ -81,6 +247,9 @@ void PID_Reset(PID_HandleTypeDef *hpid) {
     hpid->integral = 0.0f;
     hpid->prev_error = 0.0f;
     hpid->output = 0.0f;
+    hpid->p_term = 0.0f;
+    hpid->i_term = 0.0f;
+    hpid->d_term = 0.0f;
     hpid->last_time = HAL_GetTick();
 }
 
@@ -89,4 +258,25 @@ void PID_SetTunings(PID_HandleTypeDef *hpid, float kp, float ki, float kd) {
     hpid->kp = kp;
     hpid->ki = ki;
     hpid->kd = kd;
-}
\ No newline at end of file
+    PID_UpdateIntegralLimits(hpid);
+}
+
+// 读取PID参数
+void PID_GetTunings(PID_HandleTypeDef *hpid, float *kp, float *ki, float *kd) {
+    *kp = hpid->kp;
+    *ki = hpid->ki;
+    *kd = hpid->kd;
+}
+
+// 获取上次输出
+float PID_GetOutput(PID_HandleTypeDef *hpid) {
+    return hpid->output;
+}
+
+// 获取上次计算的P/I/D各项（遥测用）
+void PID_GetTerms(PID_HandleTypeDef *hpid, float *p_term, float *i_term, float *d_term) {
+    *p_term = hpid->p_term;
+    *i_term = hpid->i_term;
+    *d_term = hpid->d_term;
+}
+#endif
@@ -4,6 +4,32 @@
 #include "stm32f1xx_hal.h"
 #include "parameters.h"
 
+#if CONTROL_FIXED_POINT
+// PID控制器结构体（定点版本：除last_time外均为Q16.16，见fixedpoint.h）
+typedef struct {
+    int32_t kp;         // 比例系数
+    int32_t ki;         // 积分系数
+    int32_t kd;         // 微分系数
+    
+    int32_t setpoint;   // 目标值
+    int32_t integral;   // 积分项
+    int32_t prev_error; // 上一次误差
+    
+    int32_t output;     // 输出值
+    int32_t output_min; // 输出最小值
+    int32_t output_max; // 输出最大值
+    
+    int32_t integral_min; // 积分下限（output_min / ki，修改增益或限幅时计算）
+    int32_t integral_max; // 积分上限（output_max / ki）
+    
+    int32_t p_term;     // 上次计算的比例项
+    int32_t i_term;     // 上次计算的积分项
+    int32_t d_term;     // 上次计算的微分项
+    
+    uint32_t last_time; // 上一次计算时间
+    
+} PID_HandleTypeDef;
+#else
 // PID控制器结构体
 typedef struct {
     float kp;           // 比例系数
@@ -18,15 +44,31 @@ typedef struct {
     float output_min;   // 输出最小值
     float output_max;   // 输出最大值
     
+    float integral_min; // 积分下限（output_min / ki，修改增益或限幅时计算）
+    float integral_max; // 积分上限（output_max / ki）
+    
+    float p_term;       // 上次计算的比例项
+    float i_term;       // 上次计算的积分项
+    float d_term;       // 上次计算的微分项
+    
     uint32_t last_time; // 上一次计算时间
     
 } PID_HandleTypeDef;
+#endif
 
-// 函数声明
+// 函数声明（两种数值格式接口相同，参数和返回值均为浮点）
+// 定点版本另有PID_CalculateQ：输入输出直接为定点数，调用者已有定点数据时不必来回转换
 void PID_Init(PID_HandleTypeDef *hpid, float kp, float ki, float kd);
 void PID_SetLimits(PID_HandleTypeDef *hpid, float min, float max);
 float PID_Calculate(PID_HandleTypeDef *hpid, float setpoint, float input);
+float PID_CalculateDt(PID_HandleTypeDef *hpid, float setpoint, float input, float dt);
+#if CONTROL_FIXED_POINT
+int32_t PID_CalculateQ(PID_HandleTypeDef *hpid, int32_t setpoint, int32_t input, int32_t dt_q);
+#endif
 void PID_Reset(PID_HandleTypeDef *hpid);
 void PID_SetTunings(PID_HandleTypeDef *hpid, float kp, float ki, float kd);
+void PID_GetTunings(PID_HandleTypeDef *hpid, float *kp, float *ki, float *kd);
+float PID_GetOutput(PID_HandleTypeDef *hpid);
+void PID_GetTerms(PID_HandleTypeDef *hpid, float *p_term, float *i_term, float *d_term);
 
 #endif
\ No newline at end of file
@@ -6,12 +6,21 @@
 // MPU6050 I2C引脚 (PB6-SCL, PB7-SDA)
 #define MPU6050_I2C                I2C1
 #define MPU6050_ADDR               0x68
-
-// 电机PWM引脚 (TIM1 CH1-CH4)
-#define MOTOR_A_PWM_PIN            GPIO_PIN_8   // PA8 - 左电机PWM
-#define MOTOR_A_DIR_PIN            GPIO_PIN_9   // PA9 - 左电机方向
-#define MOTOR_B_PWM_PIN            GPIO_PIN_10  // PA10 - 右电机PWM
-#define MOTOR_B_DIR_PIN            GPIO_PIN_11  // PA11 - 右电机方向
+#define MPU6050_INT_PIN            GPIO_PIN_5   // PB5 - 数据就绪中断
+#define MPU6050_INT_PORT           GPIOB
+
+// 电机驱动 (TB6612FNG)：PWM接TIM1通道1/4，每个电机两个方向输入
+// IN1高IN2低正转，IN1低IN2高反转，PWM低电平期间短路制动；IN1、IN2都为低时驱动桥输出高阻（停止）
+#define MOTOR_A_PWM_PIN            GPIO_PIN_8   // PA8 - 左电机PWM (TIM1_CH1)
+#define MOTOR_B_PWM_PIN            GPIO_PIN_11  // PA11 - 右电机PWM (TIM1_CH4)
+#define MOTOR_PWM_PORT             GPIOA
+#define MOTOR_A_CHANNEL            TIM_CHANNEL_1
+#define MOTOR_B_CHANNEL            TIM_CHANNEL_4
+#define MOTOR_A_IN1_PIN            GPIO_PIN_12  // PB12 - 左电机AIN1
+#define MOTOR_A_IN2_PIN            GPIO_PIN_13  // PB13 - 左电机AIN2
+#define MOTOR_B_IN1_PIN            GPIO_PIN_14  // PB14 - 右电机BIN1
+#define MOTOR_B_IN2_PIN            GPIO_PIN_15  // PB15 - 右电机BIN2
+#define MOTOR_DIR_PORT             GPIOB
 #define MOTOR_TIM                  TIM1
 
 // 编码器引脚 (TIM2/TIM3)
@@ -27,6 +36,11 @@
 #define USART_TX_PIN               GPIO_PIN_9   // PA9
 #define USART_RX_PIN               GPIO_PIN_10  // PA10
 
+// 电池电压检测 (ADC1_IN4)，经分压电阻接电池正极，分压比见 BATTERY_DIVIDER
+#define BATTERY_ADC_PIN            GPIO_PIN_4   // PA4
+#define BATTERY_ADC_PORT           GPIOA
+#define BATTERY_ADC_CHANNEL        ADC_CHANNEL_4
+
 // LED指示灯
 #define LED_PIN                    GPIO_PIN_13  // PC13
 
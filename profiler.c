@@ -0,0 +1,121 @@
+#include "profiler.h"
+#include "strconv.h"
+#include <string.h>
+
+// 各探针的统计，以及控制循环超时次数
+static Profiler_StatsTypeDef profiler_stats[PROFILE_COUNT];
+static volatile uint32_t profiler_overruns = 0;
+
+// 探针名称（与Profiler_ProbeTypeDef顺序一致）
+static const char *const profiler_names[PROFILE_COUNT] = {
+    "sensor", "attitude", "encoder", "control", "blackbox", "snapshot", "loop", "send"
+};
+
+// 周期数所在的直方图格：floor(log2(cycles))
+static uint8_t Profiler_Bucket(uint32_t cycles) {
+    uint8_t bucket = 0;
+    while (cycles > 1 && bucket < PROFILER_BUCKETS - 1) {
+        cycles >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+#if PROFILER_ENABLE
+// 结束计时并记录；无符号相减自动处理周期计数器回绕
+void Profiler_End(Profiler_ProbeTypeDef probe, uint32_t start) {
+    uint32_t cycles = PROFILER_CYCLES() - start;
+    Profiler_StatsTypeDef *stats = &profiler_stats[probe];
+    
+    if (stats->count == 0 || cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+    stats->count++;
+    stats->total += cycles;
+    stats->histogram[Profiler_Bucket(cycles)]++;
+    
+    // 控制循环耗时超过一个控制周期，下一次更新中断已被推迟
+    if (probe == PROFILE_LOOP && cycles > SystemCoreClock / CONTROL_RATE_HZ) {
+        profiler_overruns++;
+    }
+}
+#endif
+
+// 清空统计（与控制中断互斥）
+void Profiler_Reset(void) {
+    __disable_irq();
+    memset(profiler_stats, 0, sizeof(profiler_stats));
+    profiler_overruns = 0;
+    __enable_irq();
+}
+
+// 复制一个探针的统计（关中断复制，避免读到一半被控制中断更新）
+void Profiler_GetStats(Profiler_ProbeTypeDef probe, Profiler_StatsTypeDef *stats) {
+    __disable_irq();
+    *stats = profiler_stats[probe];
+    __enable_irq();
+}
+
+// 控制循环超时次数
+uint32_t Profiler_GetOverruns(void) {
+    return profiler_overruns;
+}
+
+// 由直方图估计百分位（permille：500为中位数，990为P99），返回所在格的上界，不超过最大值
+uint32_t Profiler_Percentile(const Profiler_StatsTypeDef *stats, uint16_t permille) {
+    if (stats->count == 0) {
+        return 0;
+    }
+    uint32_t target = (uint32_t)(((uint64_t)stats->count * permille + 999) / 1000);
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+        cumulative += stats->histogram[i];
+        if (cumulative >= target) {
+            uint32_t upper = (2U << i) - 1U;
+            return upper < stats->max ? upper : stats->max;
+        }
+    }
+    return stats->max;
+}
+
+// 探针名称
+const char *Profiler_GetName(Profiler_ProbeTypeDef probe) {
+    return profiler_names[probe];
+}
+
+// 表头（含时钟频率和超时次数）
+int Profiler_FormatHeader(char *buffer, size_t size) {
+    StrConv_BufferTypeDef out;
+    StrConv_Init(&out, buffer, (uint16_t)size);
+    StrConv_AppendString(&out, "profile: cycles @");
+    StrConv_AppendUint(&out, SystemCoreClock / 1000000U, 0);
+    StrConv_AppendString(&out, "MHz, budget ");
+    StrConv_AppendUint(&out, SystemCoreClock / CONTROL_RATE_HZ, 0);
+    StrConv_AppendString(&out, ", overruns ");
+    StrConv_AppendUint(&out, Profiler_GetOverruns(), 0);
+    StrConv_AppendString(&out, "\r\nprobe        count    min    avg    p50    p99    max\r\n");
+    return out.length;
+}
+
+// 一个探针一行：次数、最小、平均、P50、P99、最大（周期数）
+int Profiler_FormatProbe(Profiler_ProbeTypeDef probe, char *buffer, size_t size) {
+    Profiler_StatsTypeDef stats;
+    Profiler_GetStats(probe, &stats);
+    
+    uint32_t mean = stats.count ? (uint32_t)(stats.total / stats.count) : 0;
+    StrConv_BufferTypeDef out;
+    StrConv_Init(&out, buffer, (uint16_t)size);
+    StrConv_AppendPadded(&out, Profiler_GetName(probe), 9);
+    StrConv_AppendString(&out, " ");
+    StrConv_AppendUint(&out, stats.count, 8);
+    uint32_t columns[5] = {stats.min, mean, Profiler_Percentile(&stats, 500), Profiler_Percentile(&stats, 990), stats.max};
+    for (uint8_t i = 0; i < 5; i++) {
+        StrConv_AppendString(&out, " ");
+        StrConv_AppendUint(&out, columns[i], 6);
+    }
+    StrConv_AppendString(&out, "\r\n");
+    return out.length;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "stm32f1xx_hal.h"
+#include "parameters.h"
+#include <stddef.h>
+
+// 控制循环分段耗时统计
+//
+// 每个探针记录调用次数、最小/最大/累计周期数，以及按2的幂分格的直方图（估计百分位），全部放在静态RAM中。
+// 用法：uint32_t start = Profiler_Begin(); ...被测代码...; Profiler_End(PROFILE_xxx, start);
+// 同一探针只能在一个执行上下文中记录（控制中断或主循环），读取时关中断复制。
+
+// 周期计数来源：固件为DWT周期计数器；主机仿真在stm32f1xx_hal.h中改为按主机时钟折算的周期数
+#ifndef PROFILER_CYCLES
+#define PROFILER_CYCLES()  (DWT->CYCCNT)
+#endif
+
+#define PROFILER_BUCKETS 24     // 直方图：第i格统计 [2^i, 2^(i+1)) 个周期，最后一格包含更长的耗时
+
+// 探针
+typedef enum {
+    PROFILE_SENSOR = 0,         // MPU6050_ReadLatest：取最新传感器样本
+    PROFILE_ATTITUDE,           // Attitude_Update
+    PROFILE_ENCODER,            // Motor_UpdateEncoders
+    PROFILE_CONTROL,            // Control_Step：三个控制环与电机输出
+    PROFILE_BLACKBOX,           // Blackbox_Record
+    PROFILE_SNAPSHOT,           // 遥测快照
+    PROFILE_LOOP,               // 整个控制循环（超过控制周期计为超时）
+    PROFILE_SEND,               // 主循环中Communication_SendTelemetry（编码并放入发送缓冲区）
+    PROFILE_COUNT
+} Profiler_ProbeTypeDef;
+
+// 单个探针的统计
+typedef struct {
+    uint32_t count;             // 记录次数
+    uint32_t min;               // 最小周期数
+    uint32_t max;               // 最大周期数
+    uint64_t total;             // 累计周期数
+    uint32_t histogram[PROFILER_BUCKETS];
+} Profiler_StatsTypeDef;
+
+#if PROFILER_ENABLE
+// 开始计时，返回当前周期计数
+static inline uint32_t Profiler_Begin(void) {
+    return PROFILER_CYCLES();
+}
+
+void Profiler_End(Profiler_ProbeTypeDef probe, uint32_t start);
+#else
+static inline uint32_t Profiler_Begin(void) {
+    return 0;
+}
+
+static inline void Profiler_End(Profiler_ProbeTypeDef probe, uint32_t start) {
+    (void)probe;
+    (void)start;
+}
+#endif
+
+// 函数声明
+void Profiler_Reset(void);
+void Profiler_GetStats(Profiler_ProbeTypeDef probe, Profiler_StatsTypeDef *stats);
+uint32_t Profiler_GetOverruns(void);
+uint32_t Profiler_Percentile(const Profiler_StatsTypeDef *stats, uint16_t permille);
+const char *Profiler_GetName(Profiler_ProbeTypeDef probe);
+int Profiler_FormatHeader(char *buffer, size_t size);
+int Profiler_FormatProbe(Profiler_ProbeTypeDef probe, char *buffer, size_t size);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdint.h>
+#include <string.h>
+
+// 单生产者/单消费者字节环形缓冲区
+//
+// head只由生产者修改，tail只由消费者修改，两端分别位于主循环和中断中时不需要关中断。
+// head/tail为自由递增的16位计数，取模后得到下标，因此容量必须是2的幂且不超过32768。
+
+// 编译器屏障：保证数据拷贝完成后才更新head/tail（单核Cortex-M3不需要内存屏障指令）
+#define RINGBUF_BARRIER()  __asm volatile ("" ::: "memory")
+
+typedef struct {
+    uint8_t *buffer;            // 存储区
+    uint16_t size;              // 容量（2的幂）
+    volatile uint16_t head;     // 写入计数（生产者）
+    volatile uint16_t tail;     // 读取计数（消费者）
+} RingBuf_HandleTypeDef;
+
+static inline void RingBuf_Init(RingBuf_HandleTypeDef *rb, uint8_t *buffer, uint16_t size) {
+    rb->buffer = buffer;
+    rb->size = size;
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+// 可读字节数
+static inline uint16_t RingBuf_Used(const RingBuf_HandleTypeDef *rb) {
+    return (uint16_t)(rb->head - rb->tail);
+}
+
+// 可写字节数
+static inline uint16_t RingBuf_Free(const RingBuf_HandleTypeDef *rb) {
+    return (uint16_t)(rb->size - RingBuf_Used(rb));
+}
+
+// 写入整块数据，空间不足时不写入任何字节并返回0（保证帧不被截断）
+static inline uint16_t RingBuf_Write(RingBuf_HandleTypeDef *rb, const uint8_t *data, uint16_t len) {
+    if (len > RingBuf_Free(rb)) {
+        return 0;
+    }
+    uint16_t index = rb->head & (rb->size - 1);
+    uint16_t first = rb->size - index;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&rb->buffer[index], data, first);
+    memcpy(&rb->buffer[0], data + first, len - first);
+    RINGBUF_BARRIER();
+    rb->head = (uint16_t)(rb->head + len);
+    return len;
+}
+
+// 读取最多len字节，返回实际读取数
+static inline uint16_t RingBuf_Read(RingBuf_HandleTypeDef *rb, uint8_t *data, uint16_t len) {
+    uint16_t used = RingBuf_Used(rb);
+    if (len > used) {
+        len = used;
+    }
+    uint16_t index = rb->tail & (rb->size - 1);
+    uint16_t first = rb->size - index;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, &rb->buffer[index], first);
+    memcpy(data + first, &rb->buffer[0], len - first);
+    RINGBUF_BARRIER();
+    rb->tail = (uint16_t)(rb->tail + len);
+    return len;
+}
+
+// 取从tail开始的连续可读区域（供DMA直接发送），返回长度
+static inline uint16_t RingBuf_Peek(const RingBuf_HandleTypeDef *rb, uint8_t **data) {
+    uint16_t used = RingBuf_Used(rb);
+    uint16_t index = rb->tail & (rb->size - 1);
+    uint16_t first = rb->size - index;
+    *data = &rb->buffer[index];
+    return used < first ? used : first;
+}
+
+// 丢弃已处理的len字节（配合RingBuf_Peek使用）
+static inline void RingBuf_Skip(RingBuf_HandleTypeDef *rb, uint16_t len) {
+    RINGBUF_BARRIER();
+    rb->tail = (uint16_t)(rb->tail + len);
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * 姿态解算数学函数基准测试
+ *
+ *   bench [--iterations N]
+ *
+ * 1. 精度表：±MAX_ANGLE 范围内按加速度计原始值解算倾角，对比 FastMath_Atan2 与双精度 atan2
+ * 2. 全范围最大误差：FastMath_Atan2（整圆）、FastMath_InvSqrt（1e-3 ~ 1e3）
+ * 3. 耗时表：各数学函数以及 MPU6050_ProcessRaw / MPU6050_ReadData 的主机耗时
+ *
+ * MPU6050部分使用的解算方式由编译时的 USE_FAST_MATH 决定，
+ * make bench 会分别构建 USE_FAST_MATH=1 与 0 两个版本做前后对比。
+ * 耗时为主机测量值（x86上同时给出TSC周期），只用于相对比较，不等于Cortex-M3周期数。
+ */
+#include "hal_sim.h"
+#include "mpu6050_sim.h"
+#include "mpu6050.h"
+#include "fastmath.h"
+#include "parameters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_INPUTS    1024
+#define RAD_TO_DEG_D    (180.0 / M_PI)
+
+// bench不运行固件main()，只链接被测模块
+int Firmware_Main(void) {
+    return 0;
+}
+
+static volatile float sink_f;
+static volatile double sink_d;
+
+static float inputs_y[BENCH_INPUTS];
+static float inputs_x[BENCH_INPUTS];
+static uint8_t raw_samples[BENCH_INPUTS][MPU6050_BURST_SIZE];
+
+static double Bench_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t Bench_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 统计结果一行
+static void Bench_Report(const char *name, double ns, uint64_t cycles, long iterations) {
+    if (cycles != 0) {
+        printf("%-32s %10.1f %12.1f\n", name, ns / iterations, (double)cycles / iterations);
+    } else {
+        printf("%-32s %10.1f %12s\n", name, ns / iterations, "-");
+    }
+}
+
+#define BENCH_RUN(name, iterations, body)                          \
+    do {                                                           \
+        double t0_ = Bench_Now();                                  \
+        uint64_t c0_ = Bench_Cycles();                             \
+        for (long n = 0; n < (iterations); n++) {                  \
+            int i = (int)(n & (BENCH_INPUTS - 1));                 \
+            (void)i;                                               \
+            body;                                                  \
+        }                                                          \
+        uint64_t c1_ = Bench_Cycles();                             \
+        Bench_Report(name, Bench_Now() - t0_, c1_ - c0_, (iterations)); \
+    } while (0)
+
+static void Bench_PutRaw(uint8_t *buffer, int index, int16_t value) {
+    buffer[index] = (uint8_t)((uint16_t)value >> 8);
+    buffer[index + 1] = (uint8_t)((uint16_t)value & 0xFF);
+}
+
+// 倾角 angle（度）时的加速度计原始值（±2g量程，Y轴指向车头，Z轴向上）
+static void Bench_MakeSample(uint8_t *buffer, double angle, double noise) {
+    double a = angle / RAD_TO_DEG_D;
+    memset(buffer, 0, MPU6050_BURST_SIZE);
+    Bench_PutRaw(buffer, 0, (int16_t)lrint(noise * 16384.0));
+    Bench_PutRaw(buffer, 2, (int16_t)lrint(sin(a) * 16384.0));
+    Bench_PutRaw(buffer, 4, (int16_t)lrint(cos(a) * 16384.0));
+}
+
+static void Bench_Accuracy(void) {
+    MPU6050_HandleTypeDef hmpu;
+    uint8_t buffer[MPU6050_BURST_SIZE];
+
+    memset(&hmpu, 0, sizeof(hmpu));
+    printf("倾角精度（USE_FAST_MATH=%d，原始值量化后与双精度atan2对比）\n", USE_FAST_MATH);
+    printf("%8s %12s %12s %12s\n", "倾角°", "atan2°", "解算°", "误差°");
+
+    double worst = 0.0;
+    for (int deg = -(int)MAX_ANGLE; deg <= (int)MAX_ANGLE; deg += 5) {
+        Bench_MakeSample(buffer, deg, 0.0);
+        MPU6050_ProcessRaw(&hmpu, buffer);
+        double reference = atan2((double)hmpu.accelY, (double)hmpu.accelZ) * RAD_TO_DEG_D;
+        double error = hmpu.angleX - reference;
+        if (fabs(error) > worst) {
+            worst = fabs(error);
+        }
+        printf("%8d %12.5f %12.5f %12.2e\n", deg, reference, hmpu.angleX, error);
+    }
+    printf("±%.0f° 范围最大误差: %.2e°\n\n", MAX_ANGLE, worst);
+
+    // 整圆扫描 FastMath_Atan2，对数扫描 FastMath_InvSqrt
+    double atan_worst = 0.0;
+    for (int k = 0; k < 100000; k++) {
+        double a = -M_PI + 2.0 * M_PI * k / 100000.0;
+        float y = (float)sin(a);
+        float x = (float)cos(a);
+        double error = fabs(FastMath_Atan2(y, x) - atan2(y, x));
+        if (error > M_PI) {
+            error = 2.0 * M_PI - error;
+        }
+        if (error > atan_worst) {
+            atan_worst = error;
+        }
+    }
+    double inv_worst = 0.0;
+    for (int k = 0; k <= 100000; k++) {
+        float x = (float)pow(10.0, -3.0 + 6.0 * k / 100000.0);
+        double error = fabs(FastMath_InvSqrt(x) * sqrt(x) - 1.0);
+        if (error > inv_worst) {
+            inv_worst = error;
+        }
+    }
+    printf("FastMath_Atan2 整圆最大误差:   %.2e rad (%.2e°)\n", atan_worst, atan_worst * RAD_TO_DEG_D);
+    printf("FastMath_InvSqrt 最大相对误差: %.2e\n\n", inv_worst);
+}
+
+static void Bench_Timing(long iterations) {
+    MPU6050_HandleTypeDef hmpu;
+    I2C_HandleTypeDef hi2c;
+
+    srand(1);
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        double angle = -MAX_ANGLE + 2.0 * MAX_ANGLE * rand() / RAND_MAX;
+        inputs_y[i] = (float)sin(angle / RAD_TO_DEG_D);
+        inputs_x[i] = (float)cos(angle / RAD_TO_DEG_D);
+        Bench_MakeSample(raw_samples[i], angle, 0.01 * (rand() % 3 - 1));
+    }
+
+    // ReadData 走仿真I2C总线，含HAL替身开销
+    memset(&hmpu, 0, sizeof(hmpu));
+    memset(&hi2c, 0, sizeof(hi2c));
+    hi2c.Instance = I2C1;
+    SIM_Reset();
+    MPU6050_Init(&hmpu, &hi2c);
+    SIM_MPU6050_SetRaw(0, 2000, 16000, 10, -10, 0);
+
+    printf("耗时（USE_FAST_MATH=%d，%ld 次）\n", USE_FAST_MATH, iterations);
+    printf("%-32s %10s %12s\n", "函数", "ns/次", "主机周期/次");
+    BENCH_RUN("atan2 (double)", iterations, sink_d = atan2((double)inputs_y[i], (double)inputs_x[i]));
+    BENCH_RUN("atan2f", iterations, sink_f = atan2f(inputs_y[i], inputs_x[i]));
+    BENCH_RUN("FastMath_Atan2", iterations, sink_f = FastMath_Atan2(inputs_y[i], inputs_x[i]));
+    BENCH_RUN("sqrt (double)", iterations, sink_d = sqrt((double)inputs_x[i] + 1.0));
+    BENCH_RUN("sqrtf", iterations, sink_f = sqrtf(inputs_x[i] + 1.0f));
+    BENCH_RUN("FastMath_Sqrt", iterations, sink_f = FastMath_Sqrt(inputs_x[i] + 1.0f));
+    BENCH_RUN("MPU6050_ProcessRaw", iterations, (MPU6050_ProcessRaw(&hmpu, raw_samples[i]), sink_f = hmpu.angleX));
+    BENCH_RUN("MPU6050_ReadData (仿真I2C)", iterations, (MPU6050_ReadData(&hmpu), sink_f = hmpu.angleX));
+}
+
+int main(int argc, char **argv) {
+    long iterations = 2000000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "用法: %s [--iterations N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Bench_Accuracy();
+    Bench_Timing(iterations);
+    return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * 卡尔曼滤波/PID 定点与浮点版本等价性检查
+ *
+ *   equiv run     --log raw.csv [--out traj.csv] [--repeat N]
+ *   equiv compare float.csv fixed.csv
+ *
+ * run     : 读取 sim run --sensor-log 记录的原始传感器数据，经 MPU6050_ProcessRaw 解算后
+ *           按固件FIFO模式的方式每个控制周期取一批样本的平均值，依次调用
+ *           Kalman_UpdateDt → PID_CalculateDt，输出每个控制周期的轨迹，并统计两级的主机耗时。
+ *           被测版本由编译时的 CONTROL_FIXED_POINT 决定，make equiv 分别构建
+ *           equiv（浮点）与 equiv_fixed（定点）
+ * compare : 逐行比较两条轨迹，输出角度/角速度/PID输出的最大与RMS偏差，超出容差时返回1
+ *
+ * 耗时为主机测量值（主机有FPU），只用于确认定点版本没有异常开销，不代表Cortex-M3上的加速比。
+ * 定点版本另外统计输入预先转换为定点数、直接调用 Kalman_UpdateQ → PID_CalculateQ 的耗时，
+ * 与浮点接口之差即为入口/出口转换的开销。
+ */
+#include "hal_sim.h"
+#include "fixedpoint.h"
+#include "mpu6050.h"
+#include "kalman.h"
+#include "pid.h"
+#include "parameters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define EQUIV_BATCH         (IMU_SAMPLE_RATE_HZ / CONTROL_RATE_HZ)  // 每个控制周期的样本数
+#define EQUIV_ANGLE_TOL     0.01    // 角度最大允许偏差（度）
+#define EQUIV_RATE_TOL      0.01    // 角速度最大允许偏差（度/秒）
+#define EQUIV_OUTPUT_TOL    0.5     // PID输出最大允许偏差（控制输出单位，满量程MAX_OUTPUT）
+
+// 一个控制周期的输入
+typedef struct {
+    double t;
+    float angle;
+    float rate;
+    float dt;
+} Equiv_InputTypeDef;
+
+// 一个控制周期的输出
+typedef struct {
+    double t;
+    double angle;
+    double rate;
+    double output;
+} Equiv_PointTypeDef;
+
+// equiv不运行固件main()，只链接被测模块
+int Firmware_Main(void) {
+    return 0;
+}
+
+static double Equiv_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void Equiv_PutRaw(uint8_t *buffer, int index, int value) {
+    buffer[index] = (uint8_t)((uint16_t)value >> 8);
+    buffer[index + 1] = (uint8_t)((uint16_t)value & 0xFF);
+}
+
+// 读取原始传感器记录并按控制周期分批，返回控制周期数
+static size_t Equiv_LoadLog(const char *path, Equiv_InputTypeDef **inputs) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    MPU6050_HandleTypeDef hmpu;
+    memset(&hmpu, 0, sizeof(hmpu));
+
+    size_t count = 0;
+    size_t capacity = 0;
+    *inputs = NULL;
+
+    char line[128];
+    unsigned long long t_us;
+    int raw[6];
+    double sum_angle = 0.0;
+    double sum_rate = 0.0;
+    int batch = 0;
+    double last_t = -1.0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%llu,%d,%d,%d,%d,%d,%d", &t_us,
+                   &raw[0], &raw[1], &raw[2], &raw[3], &raw[4], &raw[5]) != 7) {
+            continue;   // 表头
+        }
+
+        uint8_t buffer[MPU6050_BURST_SIZE];
+        memset(buffer, 0, sizeof(buffer));
+        for (int i = 0; i < 3; i++) {
+            Equiv_PutRaw(buffer, 2 * i, raw[i]);
+            Equiv_PutRaw(buffer, 8 + 2 * i, raw[3 + i]);
+        }
+        MPU6050_ProcessRaw(&hmpu, buffer);
+        sum_angle += hmpu.angleX;
+        sum_rate += hmpu.gyroX;
+
+        if (++batch < EQUIV_BATCH) {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            *inputs = realloc(*inputs, capacity * sizeof(**inputs));
+        }
+        double t = t_us * 1e-6;
+        Equiv_InputTypeDef *in = &(*inputs)[count++];
+        in->t = t;
+        in->angle = (float)(sum_angle / batch);
+        in->rate = (float)(sum_rate / batch);
+        in->dt = (float)(last_t < 0.0 ? (double)EQUIV_BATCH / IMU_SAMPLE_RATE_HZ : t - last_t);
+        last_t = t;
+        sum_angle = 0.0;
+        sum_rate = 0.0;
+        batch = 0;
+    }
+    fclose(file);
+    return count;
+}
+
+// 与固件 Control_Loop 相同的滤波+控制链路
+static void Equiv_Process(const Equiv_InputTypeDef *inputs, size_t count, Equiv_PointTypeDef *points) {
+    Kalman_HandleTypeDef hkalman;
+    PID_HandleTypeDef hpid;
+
+    Kalman_Init(&hkalman);
+    PID_Init(&hpid, PID_KP, PID_KI, PID_KD);
+
+    for (size_t i = 0; i < count; i++) {
+        float angle = Kalman_UpdateDt(&hkalman, inputs[i].angle, inputs[i].rate, inputs[i].dt);
+        float output = PID_CalculateDt(&hpid, 0.0f, angle, inputs[i].dt);
+        if (points != NULL) {
+            points[i].t = inputs[i].t;
+            points[i].angle = angle;
+            points[i].rate = Kalman_GetRate(&hkalman);
+            points[i].output = output;
+        }
+    }
+}
+
+#if CONTROL_FIXED_POINT
+// 定点输入：角度、角速度Q16.16，dt为Q2.30
+typedef struct {
+    int32_t angle;
+    int32_t rate;
+    int32_t dt;
+} Equiv_FixedInputTypeDef;
+
+// 同一链路，状态、增益和中间结果全程为定点数（不经过浮点接口）
+static void Equiv_ProcessQ(const Equiv_FixedInputTypeDef *inputs, size_t count, volatile int32_t *sink) {
+    Kalman_HandleTypeDef hkalman;
+    PID_HandleTypeDef hpid;
+
+    Kalman_Init(&hkalman);
+    PID_Init(&hpid, PID_KP, PID_KI, PID_KD);
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t angle = Kalman_UpdateQ(&hkalman, inputs[i].angle, inputs[i].rate, inputs[i].dt);
+        *sink = PID_CalculateQ(&hpid, 0, angle, inputs[i].dt);
+    }
+}
+
+static void Equiv_TimeQ(const Equiv_InputTypeDef *inputs, size_t count, long repeat) {
+    Equiv_FixedInputTypeDef *fixed = calloc(count, sizeof(*fixed));
+    volatile int32_t sink;
+    for (size_t i = 0; i < count; i++) {
+        fixed[i].angle = Fixed_FromFloat(inputs[i].angle, FIXED_Q16);
+        fixed[i].rate = Fixed_FromFloat(inputs[i].rate, FIXED_Q16);
+        fixed[i].dt = Fixed_FromFloat(inputs[i].dt, FIXED_Q30);
+    }
+
+    double t0 = Equiv_Now();
+    for (long r = 0; r < repeat; r++) {
+        Equiv_ProcessQ(fixed, count, &sink);
+    }
+    double ns = Equiv_Now() - t0;
+    printf("CONTROL_FIXED_POINT=1: %zu 个控制周期, Kalman_UpdateQ+PID_CalculateQ 主机耗时 %.1f ns/次（不含转换）\n",
+           count, repeat > 0 ? ns / ((double)repeat * count) : 0.0);
+    free(fixed);
+}
+#endif
+
+static int Equiv_Run(int argc, char **argv) {
+    const char *log_path = NULL;
+    const char *out_path = NULL;
+    long repeat = 200;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "未知参数: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (log_path == NULL) {
+        fprintf(stderr, "缺少 --log\n");
+        return 1;
+    }
+
+    Equiv_InputTypeDef *inputs;
+    size_t count = Equiv_LoadLog(log_path, &inputs);
+    if (count == 0) {
+        fprintf(stderr, "%s: 没有可用的传感器数据\n", log_path);
+        free(inputs);
+        return 1;
+    }
+
+    Equiv_PointTypeDef *points = calloc(count, sizeof(*points));
+    Equiv_Process(inputs, count, points);
+
+    if (out_path != NULL) {
+        FILE *out = fopen(out_path, "w");
+        if (out == NULL) {
+            perror(out_path);
+            free(points);
+            free(inputs);
+            return 1;
+        }
+        fprintf(out, "t,angle,rate,output\n");
+        for (size_t i = 0; i < count; i++) {
+            fprintf(out, "%.6f,%.6f,%.6f,%.6f\n", points[i].t, points[i].angle, points[i].rate, points[i].output);
+        }
+        fclose(out);
+    }
+
+    double t0 = Equiv_Now();
+    for (long r = 0; r < repeat; r++) {
+        Equiv_Process(inputs, count, NULL);
+    }
+    double ns = Equiv_Now() - t0;
+    printf("CONTROL_FIXED_POINT=%d: %zu 个控制周期, Kalman_UpdateDt+PID_CalculateDt 主机耗时 %.1f ns/次\n",
+           CONTROL_FIXED_POINT, count, repeat > 0 ? ns / ((double)repeat * count) : 0.0);
+#if CONTROL_FIXED_POINT
+    Equiv_TimeQ(inputs, count, repeat);
+#endif
+
+    free(points);
+    free(inputs);
+    return 0;
+}
+
+// 读取 run --out 输出的轨迹
+static size_t Equiv_LoadTrajectory(const char *path, Equiv_PointTypeDef **points) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    size_t count = 0;
+    size_t capacity = 0;
+    *points = NULL;
+
+    char line[128];
+    Equiv_PointTypeDef p;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%lf,%lf,%lf,%lf", &p.t, &p.angle, &p.rate, &p.output) != 4) {
+            continue;   // 表头
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            *points = realloc(*points, capacity * sizeof(**points));
+        }
+        (*points)[count++] = p;
+    }
+    fclose(file);
+    return count;
+}
+
+// 单个量的偏差统计
+typedef struct {
+    const char *name;
+    double tolerance;
+    double max;
+    double max_t;
+    double sum_sq;
+} Equiv_ErrorTypeDef;
+
+static void Equiv_Accumulate(Equiv_ErrorTypeDef *err, double t, double a, double b) {
+    double d = fabs(a - b);
+    if (d > err->max) {
+        err->max = d;
+        err->max_t = t;
+    }
+    err->sum_sq += d * d;
+}
+
+static int Equiv_Compare(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "用法: equiv compare float.csv fixed.csv\n");
+        return 1;
+    }
+
+    Equiv_PointTypeDef *a;
+    Equiv_PointTypeDef *b;
+    size_t count_a = Equiv_LoadTrajectory(argv[0], &a);
+    size_t count_b = Equiv_LoadTrajectory(argv[1], &b);
+    if (count_a == 0 || count_a != count_b) {
+        fprintf(stderr, "轨迹长度不一致: %zu / %zu\n", count_a, count_b);
+        free(a);
+        free(b);
+        return 1;
+    }
+
+    Equiv_ErrorTypeDef errors[3] = {
+        { "角度°", EQUIV_ANGLE_TOL, 0.0, 0.0, 0.0 },
+        { "角速度°/s", EQUIV_RATE_TOL, 0.0, 0.0, 0.0 },
+        { "PID输出", EQUIV_OUTPUT_TOL, 0.0, 0.0, 0.0 },
+    };
+    for (size_t i = 0; i < count_a; i++) {
+        Equiv_Accumulate(&errors[0], a[i].t, a[i].angle, b[i].angle);
+        Equiv_Accumulate(&errors[1], a[i].t, a[i].rate, b[i].rate);
+        Equiv_Accumulate(&errors[2], a[i].t, a[i].output, b[i].output);
+    }
+
+    int failed = 0;
+    printf("%-14s %12s %12s %12s %8s\n", "量", "最大偏差", "出现时刻s", "RMS偏差", "结果");
+    for (int k = 0; k < 3; k++) {
+        int ok = errors[k].max <= errors[k].tolerance;
+        failed |= !ok;
+        printf("%-14s %12.2e %12.3f %12.2e %8s\n", errors[k].name, errors[k].max, errors[k].max_t,
+               sqrt(errors[k].sum_sq / count_a), ok ? "通过" : "超差");
+    }
+
+    free(a);
+    free(b);
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        return Equiv_Run(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "compare") == 0) {
+        return Equiv_Compare(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "用法: %s run --log raw.csv [--out traj.csv] [--repeat N]\n"
+                    "      %s compare float.csv fixed.csv\n", argv[0], argv[0]);
+    return 1;
+}
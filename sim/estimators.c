@@ -0,0 +1,305 @@
+/*
+ * 姿态估计器对比：同一份传感器记录分别送入卡尔曼、互补、Mahony三种滤波器，统计精度和耗时
+ *
+ *   estimators --log raw.csv [--skip-s 秒] [--repeat N] [--out out.csv]
+ *
+ * 记录按固件的方式每个控制周期解算一批样本（FIFO模式为累加平均，数据就绪模式取最后一个样本），
+ * 三种滤波器依次对全部控制周期调用 Attitude_Update。
+ * sim run --sensor-log 记录的最后一列是真实倾角，统计各滤波器相对真实倾角的RMS/最大误差；
+ * 没有该列（真实小车的记录）时改为以卡尔曼滤波的输出为参照。
+ * 前 --skip-s 秒（默认1秒）为滤波器收敛过程，不计入误差；真实倾角超过 MAX_ANGLE（已倒地）的控制周期也不计入。
+ * 耗时为重复 --repeat 次（默认200）的平均主机 ns/次，只用于同一台机器上的相对比较。
+ * --out 输出每个控制周期的 t,truth,kalman,comp,mahony
+ *
+ * 标定一致性检查：把记录中的加速度计原始值按 ESTIMATORS_ACCEL_OFFSET/ESTIMATORS_ACCEL_SCALE 加上零偏和标度误差，
+ * 同时把对应的标定值写入驱动（与六面标定的结果相同），三种滤波器的输出都应与原记录一致；
+ * 任一滤波器偏差超过 ESTIMATORS_CALIB_TOL 时返回非0（例如某个滤波器绕过了驱动的加速度计校正）
+ */
+#include "hal_sim.h"
+#include "mpu6050.h"
+#include "attitude.h"
+#include "parameters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ESTIMATORS_BATCH    (IMU_SAMPLE_RATE_HZ / CONTROL_RATE_HZ)  // 每个控制周期的样本数
+#define ESTIMATORS_CALIB_TOL 0.01   // 标定一致性检查允许的最大偏差（度），只留给原始值取整
+
+// 标定一致性检查注入的加速度计误差：零偏（LSB）和标度误差（校正值 = (原始值 - 零偏) × (1 + 标度误差)）
+static const float estimators_accel_offset[3] = {150.0f, -220.0f, 310.0f};
+static const float estimators_accel_scale[3] = {0.03f, -0.025f, 0.04f};
+
+// 一个控制周期的输入
+typedef struct {
+    double t;
+    float dt;
+    double truth;                   // 真实倾角（度），记录中没有时为NAN
+    MPU6050_HandleTypeDef mpu;      // 解算后的传感器数据
+} Estimators_InputTypeDef;
+
+// 一个滤波器的结果
+typedef struct {
+    float *angle;
+    double ns;
+    double max;
+    double max_t;
+    double sum_sq;
+    size_t count;
+} Estimators_ResultTypeDef;
+
+// estimators不运行固件main()，只链接被测模块
+int Firmware_Main(void) {
+    return 0;
+}
+
+static double Estimators_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void Estimators_PutRaw(uint8_t *buffer, int index, int value) {
+    buffer[index] = (uint8_t)((uint16_t)value >> 8);
+    buffer[index + 1] = (uint8_t)((uint16_t)value & 0xFF);
+}
+
+// 加速度计原始值加上注入的误差（校正的逆运算），取整并限幅到16位
+static int Estimators_Distort(int raw, int axis) {
+    double value = raw / (1.0 + estimators_accel_scale[axis]) + estimators_accel_offset[axis];
+    value = floor(value + 0.5);
+    if (value > 32767.0) return 32767;
+    if (value < -32768.0) return -32768;
+    return (int)value;
+}
+
+// 读取原始传感器记录并按控制周期分批解算，返回控制周期数
+// distort非0时加速度计原始值注入标定误差，驱动写入对应的标定值
+static size_t Estimators_LoadLog(const char *path, Estimators_InputTypeDef **inputs, int *have_truth, int distort) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    MPU6050_HandleTypeDef hmpu;
+    memset(&hmpu, 0, sizeof(hmpu));
+    if (distort) {
+        for (int i = 0; i < 3; i++) {
+            hmpu.accelOffset[i] = estimators_accel_offset[i];
+            hmpu.accelScaleError[i] = estimators_accel_scale[i];
+        }
+    }
+
+    size_t count = 0;
+    size_t capacity = 0;
+    *inputs = NULL;
+    *have_truth = 1;
+
+    char line[128];
+    unsigned long long t_us;
+    int raw[6];
+    double truth;
+    int32_t sum[6] = {0};
+    uint8_t buffer[MPU6050_BURST_SIZE];
+    int batch = 0;
+    double last_t = -1.0;
+
+    memset(buffer, 0, sizeof(buffer));
+    while (fgets(line, sizeof(line), file) != NULL) {
+        int fields = sscanf(line, "%llu,%d,%d,%d,%d,%d,%d,%lf", &t_us,
+                            &raw[0], &raw[1], &raw[2], &raw[3], &raw[4], &raw[5], &truth);
+        if (fields < 7) {
+            continue;   // 表头
+        }
+        if (fields < 8) {
+            *have_truth = 0;
+        }
+        if (distort) {
+            for (int i = 0; i < 3; i++) {
+                raw[i] = Estimators_Distort(raw[i], i);
+            }
+        }
+
+        for (int i = 0; i < 6; i++) {
+            sum[i] += raw[i];
+        }
+        for (int i = 0; i < 3; i++) {
+            Estimators_PutRaw(buffer, 2 * i, raw[i]);
+            Estimators_PutRaw(buffer, 8 + 2 * i, raw[3 + i]);
+        }
+        if (++batch < ESTIMATORS_BATCH) {
+            continue;
+        }
+
+#if IMU_FIFO_MODE
+        MPU6050_ProcessSum(&hmpu, sum, (uint8_t)batch);
+#else
+        MPU6050_ProcessRaw(&hmpu, buffer);
+#endif
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            *inputs = realloc(*inputs, capacity * sizeof(**inputs));
+        }
+        double t = t_us * 1e-6;
+        Estimators_InputTypeDef *in = &(*inputs)[count++];
+        in->t = t;
+        in->dt = (float)(last_t < 0.0 ? (double)ESTIMATORS_BATCH / IMU_SAMPLE_RATE_HZ : t - last_t);
+        in->truth = (fields == 8) ? truth : NAN;
+        in->mpu = hmpu;
+        last_t = t;
+        memset(sum, 0, sizeof(sum));
+        batch = 0;
+    }
+    fclose(file);
+    return count;
+}
+
+// 一个滤波器跑完整段记录，angle为NULL时只计时
+static void Estimators_Process(Attitude_FilterTypeDef filter, const Estimators_InputTypeDef *inputs, size_t count,
+                               float *angle) {
+    Attitude_HandleTypeDef hatt;
+    Attitude_Init(&hatt, filter);
+
+    for (size_t i = 0; i < count; i++) {
+        float a = Attitude_Update(&hatt, &inputs[i].mpu, inputs[i].dt);
+        if (angle != NULL) {
+            angle[i] = a;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *log_path = NULL;
+    const char *out_path = NULL;
+    double skip_s = 1.0;
+    long repeat = 200;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--skip-s") == 0 && i + 1 < argc) {
+            skip_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "用法: %s --log raw.csv [--skip-s 秒] [--repeat N] [--out out.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (log_path == NULL) {
+        fprintf(stderr, "缺少 --log\n");
+        return 1;
+    }
+
+    Estimators_InputTypeDef *inputs = NULL;
+    int have_truth;
+    size_t count = Estimators_LoadLog(log_path, &inputs, &have_truth, 0);
+    if (count == 0) {
+        fprintf(stderr, "%s: 没有可用的传感器数据\n", log_path);
+        free(inputs);
+        return 1;
+    }
+
+    Estimators_ResultTypeDef results[ATTITUDE_COUNT];
+    memset(results, 0, sizeof(results));
+    for (int f = 0; f < ATTITUDE_COUNT; f++) {
+        results[f].angle = calloc(count, sizeof(float));
+        Estimators_Process((Attitude_FilterTypeDef)f, inputs, count, results[f].angle);
+
+        double t0 = Estimators_Now();
+        for (long r = 0; r < repeat; r++) {
+            Estimators_Process((Attitude_FilterTypeDef)f, inputs, count, NULL);
+        }
+        results[f].ns = repeat > 0 ? (Estimators_Now() - t0) / ((double)repeat * count) : 0.0;
+    }
+
+    // 误差：相对真实倾角，没有真实倾角时相对卡尔曼滤波
+    double t_start = inputs[0].t + skip_s;
+    for (size_t i = 0; i < count; i++) {
+        if (inputs[i].t < t_start) {
+            continue;
+        }
+        double ref = have_truth ? inputs[i].truth : results[ATTITUDE_KALMAN].angle[i];
+        if (fabs(ref) > MAX_ANGLE) {
+            continue;
+        }
+        for (int f = 0; f < ATTITUDE_COUNT; f++) {
+            double d = fabs(results[f].angle[i] - ref);
+            if (d > results[f].max) {
+                results[f].max = d;
+                results[f].max_t = inputs[i].t;
+            }
+            results[f].sum_sq += d * d;
+            results[f].count++;
+        }
+    }
+
+    printf("%zu 个控制周期（%s），误差参照: %s，跳过前 %.1f 秒，统计 %zu 个\n", count,
+           IMU_FIFO_MODE ? "FIFO累加" : "最新样本", have_truth ? "真实倾角" : "卡尔曼滤波", skip_s, results[0].count);
+    printf("%-10s %10s %12s %12s %10s\n", "滤波器", "ns/次", "RMS误差(°)", "最大误差(°)", "时刻(s)");
+    for (int f = 0; f < ATTITUDE_COUNT; f++) {
+        const Estimators_ResultTypeDef *res = &results[f];
+        double rms = res->count > 0 ? sqrt(res->sum_sq / res->count) : 0.0;
+        printf("%-10s %10.1f %12.4f %12.4f %10.3f\n", Attitude_GetName((Attitude_FilterTypeDef)f),
+               res->ns, rms, res->max, res->max_t);
+    }
+
+    // 标定一致性：注入误差并写入标定值后重新解算，与原记录的滤波输出比较
+    Estimators_InputTypeDef *distorted = NULL;
+    int distorted_truth;
+    int result = 0;
+    size_t distorted_count = Estimators_LoadLog(log_path, &distorted, &distorted_truth, 1);
+    float *angle = calloc(count, sizeof(float));
+    printf("标定一致性（加速度计零偏 %.0f/%.0f/%.0f LSB，标度误差 %+.3f/%+.3f/%+.3f，容差 %.3f°）:\n",
+           estimators_accel_offset[0], estimators_accel_offset[1], estimators_accel_offset[2],
+           estimators_accel_scale[0], estimators_accel_scale[1], estimators_accel_scale[2], ESTIMATORS_CALIB_TOL);
+    for (int f = 0; f < ATTITUDE_COUNT && distorted_count == count; f++) {
+        Estimators_Process((Attitude_FilterTypeDef)f, distorted, count, angle);
+        double max = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double d = fabs(angle[i] - results[f].angle[i]);
+            if (d > max) {
+                max = d;
+            }
+        }
+        int pass = max <= ESTIMATORS_CALIB_TOL;
+        printf("%-10s 最大偏差 %10.4f°  %s\n", Attitude_GetName((Attitude_FilterTypeDef)f), max, pass ? "通过" : "失败");
+        if (!pass) {
+            result = 1;
+        }
+    }
+    if (distorted_count != count) {
+        fprintf(stderr, "标定一致性: 重新解算得到 %zu 个控制周期，应为 %zu\n", distorted_count, count);
+        result = 1;
+    }
+    free(angle);
+    free(distorted);
+
+    if (out_path != NULL) {
+        FILE *out = fopen(out_path, "w");
+        if (out == NULL) {
+            perror(out_path);
+            result = 1;
+        } else {
+            fprintf(out, "t,truth,kalman,comp,mahony\n");
+            for (size_t i = 0; i < count; i++) {
+                fprintf(out, "%.6f,%.4f,%.4f,%.4f,%.4f\n", inputs[i].t, inputs[i].truth,
+                        results[ATTITUDE_KALMAN].angle[i], results[ATTITUDE_COMPLEMENTARY].angle[i],
+                        results[ATTITUDE_MAHONY].angle[i]);
+            }
+            fclose(out);
+        }
+    }
+
+    for (int f = 0; f < ATTITUDE_COUNT; f++) {
+        free(results[f].angle);
+    }
+    free(inputs);
+    return result;
+}
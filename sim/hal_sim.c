@@ -0,0 +1,985 @@
+#include "hal_sim.h"
+#include "mpu6050_sim.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+// 外设寄存器实例
+GPIO_TypeDef SIM_GPIOA, SIM_GPIOB, SIM_GPIOC;
+TIM_TypeDef SIM_TIM1, SIM_TIM2, SIM_TIM3, SIM_TIM4;
+I2C_TypeDef SIM_I2C1;
+USART_TypeDef SIM_USART1;
+DMA_Channel_TypeDef SIM_DMA1_Channel1, SIM_DMA1_Channel4, SIM_DMA1_Channel5, SIM_DMA1_Channel7;
+ADC_TypeDef SIM_ADC1;
+DWT_Type SIM_DWT;
+CoreDebug_Type SIM_CoreDebug;
+
+uint32_t SystemCoreClock = 72000000;
+
+// 开启更新/比较中断的定时器（中断使能看 DIER：UIE=bit0，CC1IE~CC4IE=bit1~4）
+typedef struct {
+    TIM_HandleTypeDef *htim;
+    uint32_t period_us;
+    uint32_t elapsed_us;
+} SIM_TimerTypeDef;
+
+// 进行中的I2C传输（DMA读取或中断方式写入）：读取开始时锁存寄存器数据，完成时写入目标缓冲区；
+// 写入开始时即写入传感器，完成时只调用回调
+typedef struct {
+    I2C_HandleTypeDef *hi2c;
+    uint8_t write;
+    uint8_t *dest;
+    uint16_t size;
+    uint64_t done_us;
+    uint8_t data[256];
+} SIM_I2CTransferTypeDef;
+
+// 进行中的UART DMA发送：完成时才从源缓冲区取数据（与DMA逐字节读取一样，发送期间源数据不能改动）
+typedef struct {
+    UART_HandleTypeDef *huart;
+    const uint8_t *data;
+    uint16_t size;
+    uint64_t done_us;
+} SIM_UARTTransferTypeDef;
+
+#define SIM_GPIO_MODE_IT      0x10000000U    // GPIO模式中的外部中断标志位
+#define SIM_UART_CAPTURE_SIZE 65536
+#define SIM_TIMER_COUNT       4
+#define SIM_TIMER_CLOCK_MHZ   72
+#define SIM_FIRMWARE_STACK    (256 * 1024)
+#define SIM_FLASH_SIZE        (64 * 1024)   // STM32F103C8
+#define SIM_FLASH_ERASE_US    20000         // 页擦除时间（数据手册典型值）
+#define SIM_FLASH_PROGRAM_US  52            // 半字编程时间
+#define SIM_ADC_CHANNELS      18
+#define SIM_ADC_CLOCK_KHZ     12000         // PCLK2 / 6
+#define SIM_ADC_VREF          3.3
+
+// 固件运行在独立的上下文中，虚拟时间到达截止点后切回仿真侧，下次可继续运行
+static ucontext_t host_context;
+static ucontext_t firmware_context;
+static uint8_t firmware_stack[SIM_FIRMWARE_STACK];
+
+// 仿真状态
+static struct {
+    uint64_t now_us;                // 虚拟时间（微秒）
+    uint32_t tick;                  // HAL毫秒计数
+    uint32_t tick_remainder_us;     // 不足1ms的部分
+
+    SIM_StepHook hook;
+    uint32_t hook_period_us;
+    uint32_t hook_elapsed_us;
+
+    SIM_TimerTypeDef timers[SIM_TIMER_COUNT];
+    uint8_t in_isr;                 // 中断回调执行中，不再嵌套触发
+
+    // 外部中断：配置为中断模式的引脚，以及等待响应的引脚
+    uint16_t exti_mask;
+    uint16_t exti_pending;
+
+    SIM_I2CTransferTypeDef i2c_dma;
+    SIM_UARTTransferTypeDef uart_dma;
+
+    // ADC连续转换：输入电压、循环DMA缓冲区及写入位置、每次转换时间（纳秒）和未满一次转换的时间
+    double adc_input[SIM_ADC_CHANNELS];
+    uint32_t adc_channel;
+    uint32_t adc_sampling;
+    uint16_t *adc_dest;
+    uint32_t adc_length;
+    uint32_t adc_pos;
+    uint32_t adc_conversion_ns;
+    uint64_t adc_elapsed_ns;
+    uint32_t adc_noise;
+
+    // 固件运行状态
+    uint8_t started;
+    uint8_t running;
+    uint64_t stop_us;
+
+    // UART
+    UART_HandleTypeDef *rx_huart;   // 循环DMA接收，rx_pos为DMA写入位置
+    uint16_t rx_pos;
+    SIM_UARTSink tx_sink;
+    char tx_capture[SIM_UART_CAPTURE_SIZE];
+    size_t tx_head, tx_tail;
+
+    SIM_StatsTypeDef stats;
+} sim;
+
+// 片上闪存：不随SIM_Reset清除（与芯片复位一样保留内容）
+static uint8_t *flash_memory = NULL;
+static uint8_t flash_locked = 1;
+
+// ---------------------------------------------------------------- 虚拟时钟
+void SIM_Reset(void) {
+    memset(&sim, 0, sizeof(sim));
+    memset(&SIM_GPIOA, 0, sizeof(SIM_GPIOA));
+    memset(&SIM_GPIOB, 0, sizeof(SIM_GPIOB));
+    memset(&SIM_GPIOC, 0, sizeof(SIM_GPIOC));
+    memset(&SIM_TIM1, 0, sizeof(SIM_TIM1));
+    memset(&SIM_TIM2, 0, sizeof(SIM_TIM2));
+    memset(&SIM_TIM3, 0, sizeof(SIM_TIM3));
+    memset(&SIM_TIM4, 0, sizeof(SIM_TIM4));
+    memset(&SIM_DMA1_Channel1, 0, sizeof(SIM_DMA1_Channel1));
+    memset(&SIM_DMA1_Channel4, 0, sizeof(SIM_DMA1_Channel4));
+    memset(&SIM_DMA1_Channel5, 0, sizeof(SIM_DMA1_Channel5));
+    memset(&SIM_DMA1_Channel7, 0, sizeof(SIM_DMA1_Channel7));
+    memset(&SIM_ADC1, 0, sizeof(SIM_ADC1));
+    memset(&SIM_DWT, 0, sizeof(SIM_DWT));
+    memset(&SIM_CoreDebug, 0, sizeof(SIM_CoreDebug));
+    SIM_MPU6050_Reset();
+}
+
+uint64_t SIM_GetTimeUs(void) {
+    return sim.now_us;
+}
+
+uint32_t SIM_HostCycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    return (uint32_t)(ns * (SystemCoreClock / 1000000U) / 1000U);
+}
+
+void SIM_SetStepHook(SIM_StepHook hook, uint32_t period_us) {
+    sim.hook = hook;
+    sim.hook_period_us = period_us;
+    sim.hook_elapsed_us = 0;
+}
+
+// 比较通道在周期内的触发时刻，未开中断或不在周期内返回0
+static uint32_t SIM_TIM_CompareUs(const SIM_TimerTypeDef *t, uint32_t ch) {
+    TIM_TypeDef *tim = t->htim->Instance;
+    if (!(tim->DIER & (1U << (ch + 1)))) {
+        return 0;
+    }
+    uint32_t ccr = *SIM_TIM_CCR(tim, ch * 4);
+    uint32_t cc_us = (uint32_t)((uint64_t)(tim->PSC + 1) * ccr / SIM_TIMER_CLOCK_MHZ);
+    return cc_us < t->period_us ? cc_us : 0;
+}
+
+// 距离下一个定时事件（步进回调、DMA完成或定时器更新）的时间
+static uint32_t SIM_NextEvent(uint32_t limit) {
+    uint32_t next = limit;
+    if (sim.i2c_dma.hi2c != NULL && !sim.in_isr && sim.i2c_dma.done_us - sim.now_us < next) {
+        next = (uint32_t)(sim.i2c_dma.done_us - sim.now_us);
+    }
+    if (sim.uart_dma.huart != NULL && !sim.in_isr && sim.uart_dma.done_us - sim.now_us < next) {
+        next = (uint32_t)(sim.uart_dma.done_us - sim.now_us);
+    }
+    if (sim.hook != NULL && sim.hook_period_us - sim.hook_elapsed_us < next) {
+        next = sim.hook_period_us - sim.hook_elapsed_us;
+    }
+    for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+        SIM_TimerTypeDef *t = &sim.timers[i];
+        if (t->htim == NULL) {
+            continue;
+        }
+        if (t->period_us - t->elapsed_us < next) {
+            next = t->period_us - t->elapsed_us;
+        }
+        for (uint32_t ch = 0; ch < 4; ch++) {
+            uint32_t cc_us = SIM_TIM_CompareUs(t, ch);
+            if (cc_us > t->elapsed_us && cc_us - t->elapsed_us < next) {
+                next = cc_us - t->elapsed_us;
+            }
+        }
+    }
+    return next;
+}
+
+static void SIM_UART_Emit(const uint8_t *data, uint16_t size);
+static void SIM_ADC_Convert(uint32_t us);
+
+static void SIM_ServiceInterrupts(void) {
+    sim.in_isr = 1;
+
+    while (sim.exti_pending != 0) {
+        uint16_t pin = sim.exti_pending & (uint16_t)-sim.exti_pending;
+        sim.exti_pending &= ~pin;
+        HAL_GPIO_EXTI_Callback(pin);
+    }
+
+    if (sim.i2c_dma.hi2c != NULL && sim.now_us >= sim.i2c_dma.done_us) {
+        I2C_HandleTypeDef *hi2c = sim.i2c_dma.hi2c;
+        sim.i2c_dma.hi2c = NULL;
+        if (sim.i2c_dma.write) {
+            HAL_I2C_MemTxCpltCallback(hi2c);
+        } else {
+            memcpy(sim.i2c_dma.dest, sim.i2c_dma.data, sim.i2c_dma.size);
+            HAL_I2C_MemRxCpltCallback(hi2c);
+        }
+    }
+
+    if (sim.uart_dma.huart != NULL && sim.now_us >= sim.uart_dma.done_us) {
+        UART_HandleTypeDef *huart = sim.uart_dma.huart;
+        sim.uart_dma.huart = NULL;
+        SIM_UART_Emit(sim.uart_dma.data, sim.uart_dma.size);
+        HAL_UART_TxCpltCallback(huart);
+    }
+
+    sim.in_isr = 0;
+}
+
+void SIM_Advance(uint32_t us) {
+    while (us > 0) {
+        uint32_t step = SIM_NextEvent(us);
+
+        sim.now_us += step;
+        us -= step;
+
+        sim.tick_remainder_us += step;
+        while (sim.tick_remainder_us >= 1000) {
+            sim.tick_remainder_us -= 1000;
+            sim.tick++;
+        }
+
+        if ((SIM_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (SIM_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+            SIM_DWT.CYCCNT += step * (SystemCoreClock / 1000000U);
+        }
+
+        // ADC转换不产生中断，不影响步进
+        SIM_ADC_Convert(step);
+
+        // 先更新传感器/物理模型，再触发定时器中断
+        if (sim.hook != NULL) {
+            sim.hook_elapsed_us += step;
+            if (sim.hook_elapsed_us >= sim.hook_period_us) {
+                sim.hook_elapsed_us = 0;
+                sim.hook(sim.now_us, sim.hook_period_us);
+            }
+        }
+
+        // 外部中断和DMA完成中断优先级高于定时器
+        if (!sim.in_isr) {
+            SIM_ServiceInterrupts();
+        }
+
+        for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+            SIM_TimerTypeDef *t = &sim.timers[i];
+            if (t->htim == NULL) {
+                continue;
+            }
+            uint32_t before = t->elapsed_us;
+            t->elapsed_us += step;
+            for (uint32_t ch = 0; ch < 4; ch++) {
+                uint32_t cc_us = SIM_TIM_CompareUs(t, ch);
+                if (cc_us > before && cc_us <= t->elapsed_us && !sim.in_isr) {
+                    sim.in_isr = 1;
+                    t->htim->Channel = (HAL_TIM_ActiveChannel)(1U << ch);
+                    HAL_TIM_OC_DelayElapsedCallback(t->htim);
+                    t->htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+                    sim.in_isr = 0;
+                }
+            }
+            if (t->elapsed_us >= t->period_us) {
+                t->elapsed_us = 0;
+                if ((t->htim->Instance->DIER & 1U) && !sim.in_isr) {
+                    sim.in_isr = 1;
+                    HAL_TIM_PeriodElapsedCallback(t->htim);
+                    sim.in_isr = 0;
+                }
+            }
+        }
+    }
+
+    // 只在固件上下文中挂起，仿真侧调用时直接返回
+    if (sim.running && sim.now_us >= sim.stop_us) {
+        sim.running = 0;
+        swapcontext(&firmware_context, &host_context);
+    }
+}
+
+// ---------------------------------------------------------------- FLASH
+// 在FLASH_BASE处映射闪存，固件按地址直接读取；只在用到时映射（qemu-arm下运行的工具不需要）
+static void SIM_FlashMap(void) {
+    if (flash_memory != NULL) {
+        return;
+    }
+    void *p = mmap((void *)FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != (void *)FLASH_BASE) {
+        fprintf(stderr, "无法在0x%08lx处映射仿真闪存\n", (unsigned long)FLASH_BASE);
+        exit(1);
+    }
+    flash_memory = p;
+    memset(flash_memory, 0xFF, SIM_FLASH_SIZE);
+}
+
+static uint8_t SIM_FlashInRange(uint32_t address, uint32_t size) {
+    return address >= FLASH_BASE && address - FLASH_BASE + size <= SIM_FLASH_SIZE;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    SIM_FlashMap();
+    flash_locked = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    flash_locked = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) {
+    *PageError = 0xFFFFFFFFU;
+    if (flash_locked || pEraseInit->TypeErase != FLASH_TYPEERASE_PAGES ||
+        pEraseInit->PageAddress % FLASH_PAGE_SIZE != 0 ||
+        !SIM_FlashInRange(pEraseInit->PageAddress, pEraseInit->NbPages * FLASH_PAGE_SIZE)) {
+        *PageError = pEraseInit->PageAddress;
+        return HAL_ERROR;
+    }
+    memset(&flash_memory[pEraseInit->PageAddress - FLASH_BASE], 0xFF, pEraseInit->NbPages * FLASH_PAGE_SIZE);
+    SIM_Advance(pEraseInit->NbPages * SIM_FLASH_ERASE_US);
+    return HAL_OK;
+}
+
+// 与芯片一样只能写入已擦除（0xFFFF）的半字，写0除外
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) {
+    if (flash_locked || TypeProgram != FLASH_TYPEPROGRAM_HALFWORD || Address % 2 != 0 ||
+        !SIM_FlashInRange(Address, 2)) {
+        return HAL_ERROR;
+    }
+    uint8_t *p = &flash_memory[Address - FLASH_BASE];
+    uint16_t value = (uint16_t)Data;
+    if ((p[0] != 0xFF || p[1] != 0xFF) && value != 0) {
+        return HAL_ERROR;
+    }
+    memcpy(p, &value, 2);
+    SIM_Advance(SIM_FLASH_PROGRAM_US);
+    return HAL_OK;
+}
+
+int SIM_Flash_Load(const char *path) {
+    SIM_FlashMap();
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    size_t n = fread(flash_memory, 1, SIM_FLASH_SIZE, file);
+    fclose(file);
+    return n > 0;
+}
+
+int SIM_Flash_Save(const char *path) {
+    SIM_FlashMap();
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return 0;
+    }
+    size_t n = fwrite(flash_memory, 1, SIM_FLASH_SIZE, file);
+    fclose(file);
+    return n == SIM_FLASH_SIZE;
+}
+
+// ---------------------------------------------------------------- 固件运行
+static void SIM_FirmwareEntry(void) {
+    Firmware_Main();
+    // main()不应返回；若返回则停在此处，后续运行只推进时间
+    for (;;) {
+        SIM_Advance(1000);
+    }
+}
+
+void SIM_RunFirmware(uint64_t duration_us) {
+    if (!sim.started) {
+        SIM_FlashMap();
+        getcontext(&firmware_context);
+        firmware_context.uc_stack.ss_sp = firmware_stack;
+        firmware_context.uc_stack.ss_size = sizeof(firmware_stack);
+        firmware_context.uc_link = &host_context;
+        makecontext(&firmware_context, SIM_FirmwareEntry, 0);
+        sim.started = 1;
+    }
+
+    sim.stop_us = sim.now_us + duration_us;
+    sim.running = 1;
+    swapcontext(&host_context, &firmware_context);
+    sim.running = 0;
+}
+
+// 等待到下一个中断：定时事件或SysTick（1ms）
+void SIM_WaitForInterrupt(void) {
+    SIM_Advance(SIM_NextEvent(1000 - sim.tick_remainder_us));
+}
+
+const SIM_StatsTypeDef *SIM_GetStats(void) {
+    return &sim.stats;
+}
+
+// ---------------------------------------------------------------- 内核
+__attribute__((weak)) void HAL_MspInit(void) {
+}
+
+HAL_StatusTypeDef HAL_Init(void) {
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void) {
+    return sim.tick;
+}
+
+void HAL_Delay(uint32_t Delay) {
+    SIM_Advance(Delay * 1000U);
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    (void)IRQn;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    (void)IRQn;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct) {
+    (void)RCC_OscInitStruct;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency) {
+    (void)RCC_ClkInitStruct;
+    (void)FLatency;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit) {
+    (void)PeriphClkInit;
+    return HAL_OK;
+}
+
+// ---------------------------------------------------------------- GPIO
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+    // 上拉输入默认读为高电平
+    if (GPIO_Init->Mode == GPIO_MODE_INPUT && GPIO_Init->Pull == GPIO_PULLUP) {
+        GPIOx->IDR |= GPIO_Init->Pin;
+    }
+    if (GPIO_Init->Mode & SIM_GPIO_MODE_IT) {
+        sim.exti_mask |= (uint16_t)GPIO_Init->Pin;
+    }
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState == GPIO_PIN_SET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+uint8_t SIM_GPIO_Read(GPIO_TypeDef *port, uint16_t pin) {
+    return (port->ODR & pin) ? 1 : 0;
+}
+
+__attribute__((weak)) void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    (void)GPIO_Pin;
+}
+
+// 外部中断线只按引脚号区分（与STM32一致，不同端口的同号引脚共用一条线）
+void SIM_GPIO_EXTI(uint16_t pin) {
+    if (sim.exti_mask & pin) {
+        sim.exti_pending |= pin;
+        sim.stats.exti_events++;
+    }
+}
+
+// ---------------------------------------------------------------- I2C
+__attribute__((weak)) void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
+    (void)hi2c;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c) {
+    HAL_I2C_MspInit(hi2c);
+    return HAL_OK;
+}
+
+// 复位外设会中止进行中的DMA传输
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c) {
+    if (sim.i2c_dma.hi2c == hi2c) {
+        sim.i2c_dma.hi2c = NULL;
+    }
+    return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    (void)hi2c;
+}
+
+__attribute__((weak)) void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    (void)hi2c;
+}
+
+__attribute__((weak)) void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    (void)hi2c;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                          uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    if (hi2c == NULL || hi2c->Instance != I2C1) {
+        return HAL_ERROR;
+    }
+    if (sim.i2c_dma.hi2c == hi2c) {
+        return HAL_BUSY;
+    }
+    sim.stats.i2c_transfers++;
+    if ((DevAddress >> 1) == SIM_MPU6050_ADDR) {
+        return SIM_MPU6050_Write(pData, Size);
+    }
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                         uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    if (hi2c == NULL || hi2c->Instance != I2C1) {
+        return HAL_ERROR;
+    }
+    if (sim.i2c_dma.hi2c == hi2c) {
+        return HAL_BUSY;
+    }
+    sim.stats.i2c_transfers++;
+    if ((DevAddress >> 1) == SIM_MPU6050_ADDR) {
+        return SIM_MPU6050_Read(pData, Size);
+    }
+    return HAL_ERROR;
+}
+
+// 传输时间：设备地址(写) + 寄存器地址 + 重复起始后设备地址(读) + 数据，每字节9位
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    (void)MemAddSize;
+    if (hi2c == NULL || hi2c->Instance != I2C1 || hi2c->hdmarx == NULL ||
+        Size > sizeof(sim.i2c_dma.data)) {
+        return HAL_ERROR;
+    }
+    if (sim.i2c_dma.hi2c != NULL) {
+        return HAL_BUSY;
+    }
+    if ((DevAddress >> 1) != SIM_MPU6050_ADDR) {
+        return HAL_ERROR;
+    }
+
+    uint8_t reg = (uint8_t)MemAddress;
+    SIM_MPU6050_Write(&reg, 1);
+    SIM_MPU6050_Read(sim.i2c_dma.data, Size);
+
+    uint32_t clock = hi2c->Init.ClockSpeed ? hi2c->Init.ClockSpeed : 100000U;
+    uint32_t bits = (3U + Size) * 9U + 3U;
+    uint32_t duration_us = (uint32_t)(((uint64_t)bits * 1000000U + clock - 1) / clock);
+
+    sim.i2c_dma.hi2c = hi2c;
+    sim.i2c_dma.write = 0;
+    sim.i2c_dma.dest = pData;
+    sim.i2c_dma.size = Size;
+    sim.i2c_dma.done_us = sim.now_us + duration_us;
+    sim.stats.i2c_transfers++;
+    sim.stats.i2c_dma_transfers++;
+    return HAL_OK;
+}
+
+// 传输时间：设备地址(写) + 寄存器地址 + 数据，每字节9位
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData, uint16_t Size) {
+    (void)MemAddSize;
+    if (hi2c == NULL || hi2c->Instance != I2C1 || Size + 1U > sizeof(sim.i2c_dma.data)) {
+        return HAL_ERROR;
+    }
+    if (sim.i2c_dma.hi2c != NULL) {
+        return HAL_BUSY;
+    }
+    if ((DevAddress >> 1) != SIM_MPU6050_ADDR) {
+        return HAL_ERROR;
+    }
+
+    sim.i2c_dma.data[0] = (uint8_t)MemAddress;
+    memcpy(&sim.i2c_dma.data[1], pData, Size);
+    SIM_MPU6050_Write(sim.i2c_dma.data, (uint16_t)(Size + 1U));
+
+    uint32_t clock = hi2c->Init.ClockSpeed ? hi2c->Init.ClockSpeed : 100000U;
+    uint32_t bits = (2U + Size) * 9U + 2U;
+    uint32_t duration_us = (uint32_t)(((uint64_t)bits * 1000000U + clock - 1) / clock);
+
+    sim.i2c_dma.hi2c = hi2c;
+    sim.i2c_dma.write = 1;
+    sim.i2c_dma.dest = NULL;
+    sim.i2c_dma.size = Size;
+    sim.i2c_dma.done_us = sim.now_us + duration_us;
+    sim.stats.i2c_transfers++;
+    return HAL_OK;
+}
+
+// ---------------------------------------------------------------- DMA
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+    hdma->Instance->CCR = hdma->Init.Direction | hdma->Init.MemInc | hdma->Init.Mode | hdma->Init.Priority;
+    return HAL_OK;
+}
+
+// ---------------------------------------------------------------- ADC
+__attribute__((weak)) void HAL_ADC_MspInit(ADC_HandleTypeDef *hadc) {
+    (void)hadc;
+}
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc) {
+    HAL_ADC_MspInit(hadc);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig) {
+    if (sConfig->Channel >= SIM_ADC_CHANNELS) {
+        return HAL_ERROR;
+    }
+    hadc->Instance->SQR3 = sConfig->Channel;
+    sim.adc_channel = sConfig->Channel;
+    sim.adc_sampling = sConfig->SamplingTime;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc) {
+    (void)hadc;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length) {
+    // 采样周期（ADC时钟数 × 2，对应 SMPx 编码 0~7）
+    static const uint32_t sample_half_cycles[8] = { 3, 15, 27, 57, 83, 111, 143, 479 };
+    if (hadc->DMA_Handle == NULL || pData == NULL || Length == 0) {
+        return HAL_ERROR;
+    }
+    uint32_t half_cycles = sample_half_cycles[sim.adc_sampling & 7U] + 25U;
+    sim.adc_conversion_ns = (uint32_t)((uint64_t)half_cycles * 1000000U / (2U * SIM_ADC_CLOCK_KHZ));
+    sim.adc_dest = (uint16_t *)pData;
+    sim.adc_length = Length;
+    sim.adc_pos = 0;
+    sim.adc_elapsed_ns = 0;
+    sim.adc_noise = 1;
+    return HAL_OK;
+}
+
+void SIM_ADC_SetInput(uint32_t channel, double volts) {
+    if (channel < SIM_ADC_CHANNELS) {
+        sim.adc_input[channel] = volts;
+    }
+}
+
+// 推进us微秒内完成的转换：12位量化加±1LSB噪声，依次写入循环缓冲区（超过一圈的部分只保留最后一圈）
+static void SIM_ADC_Convert(uint32_t us) {
+    if (sim.adc_dest == NULL) {
+        return;
+    }
+    sim.adc_elapsed_ns += (uint64_t)us * 1000U;
+    uint64_t count = sim.adc_elapsed_ns / sim.adc_conversion_ns;
+    sim.adc_elapsed_ns -= count * sim.adc_conversion_ns;
+    if (count > sim.adc_length) {
+        sim.adc_pos = (uint32_t)((sim.adc_pos + count - sim.adc_length) % sim.adc_length);
+        count = sim.adc_length;
+    }
+
+    double code = sim.adc_input[sim.adc_channel] / SIM_ADC_VREF * 4095.0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint32_t s = sim.adc_noise;
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        sim.adc_noise = s;
+        long value = lrint(code) + (long)(s % 3U) - 1;
+        if (value < 0) value = 0;
+        if (value > 4095) value = 4095;
+        sim.adc_dest[sim.adc_pos] = (uint16_t)value;
+        SIM_ADC1.DR = (uint32_t)value;
+        if (++sim.adc_pos >= sim.adc_length) {
+            sim.adc_pos = 0;
+        }
+    }
+}
+
+// ---------------------------------------------------------------- TIM
+__IO uint32_t *SIM_TIM_CCR(TIM_TypeDef *tim, uint32_t channel) {
+    switch (channel) {
+        case TIM_CHANNEL_2: return &tim->CCR2;
+        case TIM_CHANNEL_3: return &tim->CCR3;
+        case TIM_CHANNEL_4: return &tim->CCR4;
+        default:            return &tim->CCR1;
+    }
+}
+
+__attribute__((weak)) void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+static void SIM_TIM_ApplyBase(TIM_HandleTypeDef *htim) {
+    htim->Instance->PSC = htim->Init.Prescaler;
+    htim->Instance->ARR = htim->Init.Period;
+}
+
+__attribute__((weak)) void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+__attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim) {
+    HAL_TIM_Base_MspInit(htim);
+    SIM_TIM_ApplyBase(htim);
+    return HAL_OK;
+}
+
+// 定时器时钟72MHz，更新周期 = (PSC+1)(ARR+1) / 72MHz；已在运行的定时器保持当前计数
+static HAL_StatusTypeDef SIM_TIM_StartIT(TIM_HandleTypeDef *htim, uint32_t dier) {
+    for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+        SIM_TimerTypeDef *t = &sim.timers[i];
+        if (t->htim == htim) {
+            htim->Instance->DIER |= dier;
+            return HAL_OK;
+        }
+    }
+    for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+        SIM_TimerTypeDef *t = &sim.timers[i];
+        if (t->htim == NULL) {
+            uint64_t ticks = (uint64_t)(htim->Instance->PSC + 1) * (htim->Instance->ARR + 1);
+            t->htim = htim;
+            t->period_us = (uint32_t)(ticks / SIM_TIMER_CLOCK_MHZ);
+            t->elapsed_us = 0;
+            htim->Instance->CR1 |= 1U;
+            htim->Instance->DIER |= dier;
+            return HAL_OK;
+        }
+    }
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim) {
+    return SIM_TIM_StartIT(htim, 1U);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim) {
+    htim->Instance->DIER &= ~1U;
+    if (htim->Instance->DIER == 0) {
+        for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+            if (sim.timers[i].htim == htim) {
+                sim.timers[i].htim = NULL;
+            }
+        }
+        htim->Instance->CR1 &= ~1U;
+    }
+    return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef *htim) {
+    SIM_TIM_ApplyBase(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig,
+                                           uint32_t Channel) {
+    *SIM_TIM_CCR(htim->Instance, Channel) = sConfig->Pulse;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    return SIM_TIM_StartIT(htim, 1U << (Channel / 4 + 1));
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim) {
+    HAL_TIM_PWM_MspInit(htim);
+    SIM_TIM_ApplyBase(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig,
+                                            uint32_t Channel) {
+    *SIM_TIM_CCR(htim->Instance, Channel) = sConfig->Pulse;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void)Channel;
+    htim->Instance->CR1 |= 1U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim,
+                                            TIM_ClockConfigTypeDef *sClockSourceConfig) {
+    (void)htim;
+    (void)sClockSourceConfig;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        TIM_MasterConfigTypeDef *sMasterConfig) {
+    (void)htim;
+    (void)sMasterConfig;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef *htim,
+                                                TIM_BreakDeadTimeConfigTypeDef *sBreakDeadTimeConfig) {
+    (void)htim;
+    (void)sBreakDeadTimeConfig;
+    return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_TIM_Encoder_MspInit(TIM_HandleTypeDef *htim) {
+    (void)htim;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *sConfig) {
+    (void)sConfig;
+    HAL_TIM_Encoder_MspInit(htim);
+    SIM_TIM_ApplyBase(htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void)Channel;
+    htim->Instance->CR1 |= 1U;
+    return HAL_OK;
+}
+
+// ---------------------------------------------------------------- UART
+__attribute__((weak)) void HAL_UART_MspInit(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    (void)huart;
+    (void)Size;
+}
+
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    HAL_UART_MspInit(huart);
+    return HAL_OK;
+}
+
+// 发送的数据进入捕获缓冲区，并交给输出回调
+static void SIM_UART_Emit(const uint8_t *data, uint16_t size) {
+    for (uint16_t i = 0; i < size; i++) {
+        sim.tx_capture[sim.tx_head] = (char)data[i];
+        sim.tx_head = (sim.tx_head + 1) % SIM_UART_CAPTURE_SIZE;
+        if (sim.tx_head == sim.tx_tail) {
+            sim.tx_tail = (sim.tx_tail + 1) % SIM_UART_CAPTURE_SIZE; // 满则丢弃最旧数据
+        }
+    }
+    if (sim.tx_sink != NULL) {
+        sim.tx_sink(data, size);
+    }
+    sim.stats.uart_tx_bytes += size;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout) {
+    (void)Timeout;
+    if (huart == NULL) {
+        return HAL_ERROR;
+    }
+    SIM_UART_Emit(pData, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    if (huart == NULL || huart->hdmatx == NULL || Size == 0) {
+        return HAL_ERROR;
+    }
+    if (sim.uart_dma.huart != NULL) {
+        return HAL_BUSY;
+    }
+
+    uint32_t baud = huart->Init.BaudRate ? huart->Init.BaudRate : 115200U;
+    uint32_t duration_us = (uint32_t)(((uint64_t)Size * 10U * 1000000U + baud - 1) / baud);
+
+    sim.uart_dma.huart = huart;
+    sim.uart_dma.data = pData;
+    sim.uart_dma.size = Size;
+    sim.uart_dma.done_us = sim.now_us + duration_us;
+    sim.stats.uart_dma_transfers++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    if (huart == NULL || huart->hdmarx == NULL || pData == NULL || Size == 0) {
+        return HAL_ERROR;
+    }
+    if (huart->RxState == HAL_UART_STATE_BUSY_RX) {
+        return HAL_BUSY;
+    }
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    sim.rx_huart = huart;
+    sim.rx_pos = 0;
+    return HAL_OK;
+}
+
+// 注入的字节一次性到达，随后线路空闲
+void SIM_UART_Inject(const char *str) {
+    UART_HandleTypeDef *huart = sim.rx_huart;
+    if (huart == NULL || huart->RxState != HAL_UART_STATE_BUSY_RX) {
+        return; // 固件未启动接收，丢弃（相当于溢出）
+    }
+    uint16_t size = huart->RxXferSize;
+    uint8_t circular = (huart->hdmarx->Init.Mode == DMA_CIRCULAR);
+
+    while (*str != '\0') {
+        huart->pRxBuffPtr[sim.rx_pos++] = (uint8_t)*str++;
+        sim.stats.uart_rx_bytes++;
+        if (sim.rx_pos == size / 2) {
+            HAL_UARTEx_RxEventCallback(huart, sim.rx_pos);     // 半满
+        } else if (sim.rx_pos == size) {
+            sim.rx_pos = 0;
+            if (!circular) {
+                huart->RxState = HAL_UART_STATE_READY;
+            }
+            HAL_UARTEx_RxEventCallback(huart, size);            // 全满
+            if (!circular) {
+                return;
+            }
+        }
+    }
+    // 空闲线（刚好在全满处结束时剩余计数等于缓冲区长度，HAL不上报）
+    if (sim.rx_pos != 0) {
+        HAL_UARTEx_RxEventCallback(huart, sim.rx_pos);
+    }
+}
+
+void SIM_UART_SetSink(SIM_UARTSink sink) {
+    sim.tx_sink = sink;
+}
+
+size_t SIM_UART_Read(char *buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && sim.tx_tail != sim.tx_head) {
+        buffer[n++] = sim.tx_capture[sim.tx_tail];
+        sim.tx_tail = (sim.tx_tail + 1) % SIM_UART_CAPTURE_SIZE;
+    }
+    return n;
+}
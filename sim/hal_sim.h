@@ -0,0 +1,56 @@
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include "stm32f1xx_hal.h"
+#include <stdio.h>
+
+// 仿真步进回调（传感器脚本、物理模型等），按固定周期调用
+typedef void (*SIM_StepHook)(uint64_t now_us, uint32_t dt_us);
+
+// 仿真统计
+typedef struct {
+    uint32_t i2c_transfers;         // I2C传输次数
+    uint32_t i2c_dma_transfers;     // 其中DMA读取次数
+    uint32_t exti_events;           // 外部中断次数
+    uint32_t uart_tx_bytes;         // UART发送字节数
+    uint32_t uart_dma_transfers;    // UART DMA发送次数
+    uint32_t uart_rx_bytes;         // UART注入字节数
+} SIM_StatsTypeDef;
+
+// 虚拟时钟
+void SIM_Reset(void);
+uint64_t SIM_GetTimeUs(void);
+void SIM_Advance(uint32_t us);
+void SIM_SetStepHook(SIM_StepHook hook, uint32_t period_us);
+
+// 运行固件main()（编译时被重命名为Firmware_Main），虚拟时间推进duration_us后返回；
+// 再次调用从挂起处继续运行，两次调用之间可注入串口数据或修改传感器状态
+void SIM_RunFirmware(uint64_t duration_us);
+
+// UART发送数据的输出回调（每次发送完成调用一次）
+typedef void (*SIM_UARTSink)(const uint8_t *data, size_t size);
+
+// UART：注入接收数据，捕获发送数据
+void SIM_UART_Inject(const char *str);
+void SIM_UART_SetSink(SIM_UARTSink sink);
+size_t SIM_UART_Read(char *buffer, size_t size);
+
+// 片上闪存镜像：从文件载入（文件不存在时返回0，闪存保持擦除状态）/保存到文件，可在多次运行之间保留校准数据
+int SIM_Flash_Load(const char *path);
+int SIM_Flash_Save(const char *path);
+
+// GPIO输出状态
+uint8_t SIM_GPIO_Read(GPIO_TypeDef *port, uint16_t pin);
+
+// ADC输入电压（伏，0~3.3），连续转换时按此值量化写入DMA缓冲区
+void SIM_ADC_SetInput(uint32_t channel, double volts);
+
+// 外部中断输入（引脚已配置为中断模式时，在下一个仿真步调用 HAL_GPIO_EXTI_Callback）
+void SIM_GPIO_EXTI(uint16_t pin);
+
+const SIM_StatsTypeDef *SIM_GetStats(void);
+
+// 固件入口（main.c 以 -Dmain=Firmware_Main 编译）
+int Firmware_Main(void);
+
+#endif
@@ -0,0 +1,384 @@
+/*
+ * 控制链路核心函数基准测试（性能回归门限）
+ *
+ *   kernels [--log raw.csv] [--iterations N] [--only 名称]
+ *           [--save base.txt] [--check base.txt] [--tolerance 比例]
+ *
+ * 输入：默认为合成数据（带噪声的±0.9×MAX_ANGLE摆动，不触发倒地停机），--log 使用 sim run --sensor-log 记录的原始传感器数据，
+ * 输入序列循环使用。每个核心函数连续调用N次，输出 ns/次、吞吐量（百万次/秒）和主机周期/次：
+ *
+ *   MPU6050_ProcessRaw     原始数据 → 倾角/角速度
+ *   Kalman_UpdateDt        卡尔曼滤波（KALMAN_STEADY_STATE=1 时为稳态增益）
+ *   Kalman_FullUpdate      卡尔曼滤波，关闭稳态增益，每次完整递推协方差
+ *   Attitude_Comp          互补滤波（Attitude_Update，ATTITUDE_COMPLEMENTARY）
+ *   Attitude_Mahony        Mahony四元数滤波（Attitude_Update，ATTITUDE_MAHONY）
+ *   PID_CalculateDt        直立环PID
+ *   Motor_UpdateEncoders   编码器采样与测速
+ *   Control_Step           串级控制（直立/速度/转向，含写PWM）
+ *   Telemetry_EncodeState  遥测帧编码（定点缩放 + CRC16）
+ *   control_loop           以上各级串联，对应一次控制中断（姿态估计为 ATTITUDE_FILTER 选择的滤波器）
+ *
+ * --save 把结果写入基线文件；--check 与基线比较，任何一项 ns/次 超过基线 (1+比例) 倍时返回1。
+ * --only 只运行一项，make kernels-qemu 用它在QEMU下按两种迭代次数的指令数之差得到每次调用的指令数。
+ * 耗时为主机测量值，只用于同一台机器上的前后对比。
+ */
+#include "hal_sim.h"
+#include "mpu6050.h"
+#include "attitude.h"
+#include "pid.h"
+#include "motor.h"
+#include "control.h"
+#include "telemetry.h"
+#include "parameters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KERNELS_INPUTS      4096
+#define KERNELS_MAX         12
+#define KERNELS_DT          (1.0f / CONTROL_RATE_HZ)
+#define RAD_TO_DEG_D        (180.0 / M_PI)
+
+// 一个采样周期的输入
+typedef struct {
+    uint8_t raw[MPU6050_BURST_SIZE];
+    MPU6050_HandleTypeDef mpu;      // 解算后的传感器数据（姿态滤波器的输入）
+    float angle;
+    float rate;
+    uint16_t encoder_left;
+    uint16_t encoder_right;
+} Kernels_InputTypeDef;
+
+// 一项的测量结果
+typedef struct {
+    const char *name;
+    double ns;
+    double cycles;
+} Kernels_ResultTypeDef;
+
+// 被测模块引用的定时器句柄（固件中定义在main.c）
+TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+
+// kernels不运行固件main()，只链接被测模块
+int Firmware_Main(void) {
+    return 0;
+}
+
+static volatile float sink_f;
+static volatile uint16_t sink_u16;
+
+static Kernels_InputTypeDef inputs[KERNELS_INPUTS];
+static int input_count;
+
+static Kernels_ResultTypeDef results[KERNELS_MAX];
+static int result_count;
+static const char *only;
+
+static MPU6050_HandleTypeDef hmpu;
+static Kalman_HandleTypeDef hkalman;
+static Kalman_HandleTypeDef hkalman_full;
+static Attitude_HandleTypeDef hattitude;
+static Attitude_HandleTypeDef hcomp;
+static Attitude_HandleTypeDef hmahony;
+static PID_HandleTypeDef hpid;
+static Motor_HandleTypeDef hmotor;
+static Control_HandleTypeDef hcontrol;
+static Telemetry_SampleTypeDef sample;
+static uint8_t frame[TELEMETRY_MAX_FRAME];
+
+static double Kernels_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t Kernels_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void Kernels_PutRaw(uint8_t *buffer, int index, int value) {
+    buffer[index] = (uint8_t)((uint16_t)value >> 8);
+    buffer[index + 1] = (uint8_t)((uint16_t)value & 0xFF);
+}
+
+// 原始数据解算出倾角/角速度，编码器按角速度积分，供后级函数使用
+static void Kernels_Prepare(void) {
+    MPU6050_HandleTypeDef h;
+    uint16_t left = 0;
+    uint16_t right = 0;
+
+    memset(&h, 0, sizeof(h));
+    for (int i = 0; i < input_count; i++) {
+        MPU6050_ProcessRaw(&h, inputs[i].raw);
+        inputs[i].mpu = h;
+        inputs[i].angle = h.angleX;
+        inputs[i].rate = h.gyroX;
+        left += (uint16_t)(int16_t)(h.gyroX * 0.1f);
+        right += (uint16_t)(int16_t)(h.gyroX * 0.1f + 1.0f);
+        inputs[i].encoder_left = left;
+        inputs[i].encoder_right = right;
+    }
+}
+
+// 合成输入：±0.9×MAX_ANGLE 摆动叠加加速度计/陀螺仪噪声
+// 不超过倒地判定角，Control_Step始终处于平衡状态（倒地后直接返回，测不到控制开销）
+static void Kernels_Synthesize(void) {
+    const double amplitude = 0.9 * MAX_ANGLE;
+    srand(1);
+    for (int i = 0; i < KERNELS_INPUTS; i++) {
+        double t = (double)i / CONTROL_RATE_HZ;
+        double angle = amplitude * sin(2.0 * M_PI * 0.7 * t);
+        double rate = amplitude * 2.0 * M_PI * 0.7 * cos(2.0 * M_PI * 0.7 * t);
+        double a = angle / RAD_TO_DEG_D;
+        uint8_t *raw = inputs[i].raw;
+
+        memset(raw, 0, MPU6050_BURST_SIZE);
+        Kernels_PutRaw(raw, 0, rand() % 200 - 100);
+        Kernels_PutRaw(raw, 2, (int)lrint(sin(a) * 16384.0) + rand() % 200 - 100);
+        Kernels_PutRaw(raw, 4, (int)lrint(cos(a) * 16384.0) + rand() % 200 - 100);
+        Kernels_PutRaw(raw, 8, (int)lrint(rate * 131.0) + rand() % 20 - 10);
+    }
+    input_count = KERNELS_INPUTS;
+}
+
+// 读取 sim run --sensor-log 记录，返回样本数
+static int Kernels_LoadLog(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    char line[128];
+    unsigned long long t_us;
+    int raw[6];
+    input_count = 0;
+    while (input_count < KERNELS_INPUTS && fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%llu,%d,%d,%d,%d,%d,%d", &t_us,
+                   &raw[0], &raw[1], &raw[2], &raw[3], &raw[4], &raw[5]) != 7) {
+            continue;   // 表头
+        }
+        uint8_t *buffer = inputs[input_count++].raw;
+        memset(buffer, 0, MPU6050_BURST_SIZE);
+        for (int i = 0; i < 3; i++) {
+            Kernels_PutRaw(buffer, 2 * i, raw[i]);
+            Kernels_PutRaw(buffer, 8 + 2 * i, raw[3 + i]);
+        }
+    }
+    fclose(file);
+    return input_count;
+}
+
+// 每项开始前重置被测状态，保证各次运行一致
+static void Kernels_Reset(void) {
+    memset(&hmpu, 0, sizeof(hmpu));
+    Kalman_Init(&hkalman);
+    Kalman_Init(&hkalman_full);
+    Kalman_SetSteadyState(&hkalman_full, 0);
+    Attitude_Init(&hattitude, (Attitude_FilterTypeDef)ATTITUDE_FILTER);
+    Attitude_Init(&hcomp, ATTITUDE_COMPLEMENTARY);
+    Attitude_Init(&hmahony, ATTITUDE_MAHONY);
+    PID_Init(&hpid, PID_KP, PID_KI, PID_KD);
+    __HAL_TIM_SET_COUNTER(&htim2, 0);
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    Motor_Init(&hmotor, &htim1);
+    Control_Init(&hcontrol, &hmotor);
+    memset(&sample, 0, sizeof(sample));
+}
+
+static void Kernels_Report(const char *name, double ns, uint64_t cycles, long iterations) {
+    double per = ns / iterations;
+
+    if (cycles != 0) {
+        printf("%-24s %10.1f %12.2f %12.1f\n", name, per, 1e3 / per, (double)cycles / iterations);
+    } else {
+        printf("%-24s %10.1f %12.2f %12s\n", name, per, 1e3 / per, "-");
+    }
+    if (result_count < KERNELS_MAX) {
+        results[result_count].name = name;
+        results[result_count].ns = per;
+        results[result_count].cycles = (double)cycles / iterations;
+        result_count++;
+    }
+}
+
+#define KERNELS_RUN(name, iterations, body)                        \
+    do {                                                           \
+        if (only != NULL && strcmp(only, name) != 0) {             \
+            break;                                                 \
+        }                                                          \
+        Kernels_Reset();                                           \
+        int i = 0;                                                 \
+        double t0_ = Kernels_Now();                                \
+        uint64_t c0_ = Kernels_Cycles();                           \
+        for (long n = 0; n < (iterations); n++) {                  \
+            const Kernels_InputTypeDef *in = &inputs[i];           \
+            (void)in;                                              \
+            body;                                                  \
+            if (++i == input_count) {                              \
+                i = 0;                                             \
+            }                                                      \
+        }                                                          \
+        uint64_t c1_ = Kernels_Cycles();                           \
+        Kernels_Report(name, Kernels_Now() - t0_, c1_ - c0_, (iterations)); \
+    } while (0)
+
+// 与固件 Control_Loop 相同的一次控制周期
+static void Kernels_ControlLoop(const Kernels_InputTypeDef *in) {
+    MPU6050_ProcessRaw(&hmpu, in->raw);
+    float angle = Attitude_Update(&hattitude, &hmpu, KERNELS_DT);
+    htim2.Instance->CNT = in->encoder_left;
+    htim3.Instance->CNT = in->encoder_right;
+    Motor_UpdateEncoders(&hmotor, KERNELS_DT);
+    Control_Step(&hcontrol, angle, KERNELS_DT);
+
+    sample.angle = angle;
+    sample.rate = Attitude_GetRate(&hattitude);
+    PID_GetTerms(&hcontrol.angle, &sample.p_term, &sample.i_term, &sample.d_term);
+    sample.output = hcontrol.balance_output;
+    sample.duty_left = hmotor.speed_left;
+    sample.duty_right = hmotor.speed_right;
+    sink_u16 = Telemetry_EncodeState(&sample, 0, frame);
+}
+
+static void Kernels_Timing(long iterations) {
+    printf("%-24s %10s %12s %12s\n", "函数", "ns/次", "百万次/秒", "主机周期/次");
+    KERNELS_RUN("MPU6050_ProcessRaw", iterations,
+                (MPU6050_ProcessRaw(&hmpu, in->raw), sink_f = hmpu.angleX));
+    KERNELS_RUN("Kalman_UpdateDt", iterations,
+                sink_f = Kalman_UpdateDt(&hkalman, in->angle, in->rate, KERNELS_DT));
+    KERNELS_RUN("Kalman_FullUpdate", iterations,
+                sink_f = Kalman_UpdateDt(&hkalman_full, in->angle, in->rate, KERNELS_DT));
+    KERNELS_RUN("Attitude_Comp", iterations,
+                sink_f = Attitude_Update(&hcomp, &in->mpu, KERNELS_DT));
+    KERNELS_RUN("Attitude_Mahony", iterations,
+                sink_f = Attitude_Update(&hmahony, &in->mpu, KERNELS_DT));
+    KERNELS_RUN("PID_CalculateDt", iterations,
+                sink_f = PID_CalculateDt(&hpid, 0.0f, in->angle, KERNELS_DT));
+    KERNELS_RUN("Motor_UpdateEncoders", iterations,
+                (htim2.Instance->CNT = in->encoder_left, htim3.Instance->CNT = in->encoder_right,
+                 Motor_UpdateEncoders(&hmotor, KERNELS_DT), sink_f = Motor_GetVelocityLeft(&hmotor)));
+    KERNELS_RUN("Control_Step", iterations,
+                (Control_Step(&hcontrol, in->angle, KERNELS_DT), sink_f = hcontrol.balance_output));
+    KERNELS_RUN("Telemetry_EncodeState", iterations,
+                (sample.angle = in->angle, sample.rate = in->rate,
+                 sink_u16 = Telemetry_EncodeState(&sample, (uint16_t)n, frame)));
+    KERNELS_RUN("control_loop", iterations, Kernels_ControlLoop(in));
+}
+
+static int Kernels_Save(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    for (int k = 0; k < result_count; k++) {
+        fprintf(file, "%s %.3f\n", results[k].name, results[k].ns);
+    }
+    fclose(file);
+    return 0;
+}
+
+// 与基线比较，超出容差返回1；基线中没有的项只打印不判定
+static int Kernels_Check(const char *path, double tolerance) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    char line[128];
+    char name[64];
+    double base_ns;
+    int failed = 0;
+
+    printf("\n与基线 %s 比较（容差 +%.0f%%）\n", path, tolerance * 100.0);
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%63s %lf", name, &base_ns) != 2) {
+            continue;
+        }
+        for (int k = 0; k < result_count; k++) {
+            if (strcmp(results[k].name, name) != 0) {
+                continue;
+            }
+            double ratio = results[k].ns / base_ns;
+            int slow = ratio > 1.0 + tolerance;
+            printf("%-24s %10.1f -> %10.1f  %+6.1f%%%s\n", name, base_ns, results[k].ns,
+                   (ratio - 1.0) * 100.0, slow ? "  变慢" : "");
+            failed |= slow;
+        }
+    }
+    fclose(file);
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    long iterations = 2000000;
+    const char *log_path = NULL;
+    const char *save_path = NULL;
+    const char *check_path = NULL;
+    double tolerance = 0.25;
+
+    for (int i = 1; i < argc; i++) {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val != NULL && strcmp(argv[i], "--iterations") == 0) {
+            iterations = atol(val);
+        } else if (val != NULL && strcmp(argv[i], "--log") == 0) {
+            log_path = val;
+        } else if (val != NULL && strcmp(argv[i], "--only") == 0) {
+            only = val;
+        } else if (val != NULL && strcmp(argv[i], "--save") == 0) {
+            save_path = val;
+        } else if (val != NULL && strcmp(argv[i], "--check") == 0) {
+            check_path = val;
+        } else if (val != NULL && strcmp(argv[i], "--tolerance") == 0) {
+            tolerance = atof(val);
+        } else {
+            fprintf(stderr, "用法: %s [--log raw.csv] [--iterations N] [--only 名称] "
+                    "[--save base.txt] [--check base.txt] [--tolerance 比例]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (iterations <= 0) {
+        fprintf(stderr, "--iterations 必须大于0\n");
+        return 1;
+    }
+
+    htim1.Instance = TIM1;
+    htim2.Instance = TIM2;
+    htim3.Instance = TIM3;
+    SIM_Reset();
+
+    if (log_path != NULL) {
+        if (Kernels_LoadLog(log_path) == 0) {
+            fprintf(stderr, "%s: 没有可用的传感器数据\n", log_path);
+            return 1;
+        }
+    } else {
+        Kernels_Synthesize();
+    }
+    Kernels_Prepare();
+
+    printf("输入: %s（%d 个样本循环使用），%ld 次，USE_FAST_MATH=%d，CONTROL_FIXED_POINT=%d\n",
+           log_path != NULL ? log_path : "合成数据", input_count, iterations,
+           USE_FAST_MATH, CONTROL_FIXED_POINT);
+    Kernels_Timing(iterations);
+
+    if (save_path != NULL && Kernels_Save(save_path) != 0) {
+        return 1;
+    }
+    if (check_path != NULL) {
+        return Kernels_Check(check_path, tolerance);
+    }
+    return 0;
+}
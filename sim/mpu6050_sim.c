@@ -0,0 +1,143 @@
+#include "mpu6050_sim.h"
+#include "hal_sim.h"
+#include "pins.h"
+#include <string.h>
+
+#define REG_FIFO_EN      0x23
+#define REG_INT_PIN_CFG  0x37
+#define REG_INT_ENABLE   0x38
+#define REG_INT_STATUS   0x3A
+#define REG_ACCEL_XOUT_H 0x3B
+#define REG_TEMP_OUT_H   0x41
+#define REG_GYRO_XOUT_H  0x43
+#define REG_USER_CTRL    0x6A
+#define REG_PWR_MGMT_1   0x6B
+#define REG_FIFO_COUNTH  0x72
+#define REG_FIFO_COUNTL  0x73
+#define REG_FIFO_R_W     0x74
+#define REG_WHO_AM_I     0x75
+
+#define FIFO_SIZE        1024
+#define USER_CTRL_FIFO_EN    0x40
+#define USER_CTRL_FIFO_RESET 0x04
+#define INT_FIFO_OFLOW       0x10
+
+static uint8_t regs[128];
+static uint8_t reg_ptr;
+
+// 片上FIFO：满后覆盖最旧数据
+static uint8_t fifo[FIFO_SIZE];
+static uint16_t fifo_head, fifo_count;
+
+static void SIM_MPU6050_Put16(uint8_t reg, int16_t value) {
+    regs[reg] = (uint8_t)((uint16_t)value >> 8);
+    regs[reg + 1] = (uint8_t)((uint16_t)value & 0xFF);
+}
+
+void SIM_MPU6050_Reset(void) {
+    memset(regs, 0, sizeof(regs));
+    reg_ptr = 0;
+    fifo_head = 0;
+    fifo_count = 0;
+    regs[REG_WHO_AM_I] = SIM_MPU6050_ADDR;
+    regs[REG_PWR_MGMT_1] = 0x40; // 上电处于睡眠状态
+    SIM_MPU6050_Put16(REG_TEMP_OUT_H, 0); // 约36.5°C
+}
+
+static void SIM_MPU6050_FifoPush(uint8_t reg, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) {
+        fifo[(fifo_head + fifo_count) % FIFO_SIZE] = regs[reg + i];
+        if (fifo_count < FIFO_SIZE) {
+            fifo_count++;
+        } else {
+            fifo_head = (fifo_head + 1) % FIFO_SIZE;
+            regs[REG_INT_STATUS] |= INT_FIFO_OFLOW;
+        }
+    }
+}
+
+static uint8_t SIM_MPU6050_FifoPop(void) {
+    if (fifo_count == 0) {
+        return 0xFF;
+    }
+    uint8_t value = fifo[fifo_head];
+    fifo_head = (fifo_head + 1) % FIFO_SIZE;
+    fifo_count--;
+    return value;
+}
+
+void SIM_MPU6050_SetRaw(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy, int16_t gz) {
+    SIM_MPU6050_Put16(REG_ACCEL_XOUT_H, ax);
+    SIM_MPU6050_Put16(REG_ACCEL_XOUT_H + 2, ay);
+    SIM_MPU6050_Put16(REG_ACCEL_XOUT_H + 4, az);
+    SIM_MPU6050_Put16(REG_GYRO_XOUT_H, gx);
+    SIM_MPU6050_Put16(REG_GYRO_XOUT_H + 2, gy);
+    SIM_MPU6050_Put16(REG_GYRO_XOUT_H + 4, gz);
+
+    // 按FIFO_EN选择的传感器写入FIFO，顺序与寄存器地址一致
+    if (regs[REG_USER_CTRL] & USER_CTRL_FIFO_EN) {
+        uint8_t en = regs[REG_FIFO_EN];
+        if (en & 0x08) SIM_MPU6050_FifoPush(REG_ACCEL_XOUT_H, 6);
+        if (en & 0x80) SIM_MPU6050_FifoPush(REG_TEMP_OUT_H, 2);
+        if (en & 0x40) SIM_MPU6050_FifoPush(REG_GYRO_XOUT_H, 2);
+        if (en & 0x20) SIM_MPU6050_FifoPush(REG_GYRO_XOUT_H + 2, 2);
+        if (en & 0x10) SIM_MPU6050_FifoPush(REG_GYRO_XOUT_H + 4, 2);
+    }
+    
+    // 数据就绪：置位中断状态，INT引脚产生脉冲
+    if (regs[REG_INT_ENABLE] & 0x01) {
+        regs[REG_INT_STATUS] |= 0x01;
+        SIM_GPIO_EXTI(MPU6050_INT_PIN);
+    }
+}
+
+uint8_t SIM_MPU6050_GetReg(uint8_t reg) {
+    return regs[reg & 0x7F];
+}
+
+// 第一个字节为寄存器地址，其后为顺序写入的数据
+HAL_StatusTypeDef SIM_MPU6050_Write(const uint8_t *data, uint16_t size) {
+    if (size == 0) {
+        return HAL_ERROR;
+    }
+    reg_ptr = data[0] & 0x7F;
+    for (uint16_t i = 1; i < size; i++) {
+        if (reg_ptr == REG_USER_CTRL && (data[i] & USER_CTRL_FIFO_RESET)) {
+            fifo_head = 0;
+            fifo_count = 0;
+            regs[reg_ptr] = data[i] & ~USER_CTRL_FIFO_RESET; // 复位位自动清零
+        } else if (reg_ptr != REG_WHO_AM_I) {
+            regs[reg_ptr] = data[i];
+        }
+        reg_ptr = (reg_ptr + 1) & 0x7F;
+    }
+    return HAL_OK;
+}
+
+// 从当前寄存器地址开始连续读取（地址自动递增）
+// INT_RD_CLEAR置位时任意读取清除中断状态，否则只有读INT_STATUS才清除；
+// 连续读FIFO_R_W时地址不递增，依次弹出FIFO数据
+HAL_StatusTypeDef SIM_MPU6050_Read(uint8_t *data, uint16_t size) {
+    uint8_t clear = 0;
+    for (uint16_t i = 0; i < size; i++) {
+        if (reg_ptr == REG_FIFO_R_W) {
+            data[i] = SIM_MPU6050_FifoPop();
+            continue;
+        }
+        if (reg_ptr == REG_INT_STATUS) {
+            clear = 1;
+        }
+        if (reg_ptr == REG_FIFO_COUNTH) {
+            data[i] = (uint8_t)(fifo_count >> 8);
+        } else if (reg_ptr == REG_FIFO_COUNTL) {
+            data[i] = (uint8_t)(fifo_count & 0xFF);
+        } else {
+            data[i] = regs[reg_ptr];
+        }
+        reg_ptr = (reg_ptr + 1) & 0x7F;
+    }
+    if (clear || (size > 0 && (regs[REG_INT_PIN_CFG] & 0x10))) {
+        regs[REG_INT_STATUS] = 0;
+    }
+    return HAL_OK;
+}
@@ -0,0 +1,17 @@
+#ifndef MPU6050_SIM_H
+#define MPU6050_SIM_H
+
+#include "stm32f1xx_hal.h"
+
+#define SIM_MPU6050_ADDR 0x68
+
+// 仿真MPU6050寄存器模型
+void SIM_MPU6050_Reset(void);
+void SIM_MPU6050_SetRaw(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy, int16_t gz);
+uint8_t SIM_MPU6050_GetReg(uint8_t reg);
+
+// I2C总线接口（由 hal_sim.c 调用）
+HAL_StatusTypeDef SIM_MPU6050_Write(const uint8_t *data, uint16_t size);
+HAL_StatusTypeDef SIM_MPU6050_Read(uint8_t *data, uint16_t size);
+
+#endif
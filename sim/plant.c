@@ -0,0 +1,242 @@
+#include "plant.h"
+#include "hal_sim.h"
+#include "mpu6050_sim.h"
+#include "pins.h"
+#include "parameters.h"
+#include <math.h>
+#include <string.h>
+
+#define GRAVITY 9.80665
+
+// 默认参数：N20减速电机（1:30）+ 约400g车体
+void Plant_DefaultParams(Plant_ParamsTypeDef *params) {
+    params->body_mass = 0.30;
+    params->base_mass = 0.10;
+    params->com_height = 0.05;
+    params->body_inertia = 4.0e-4;
+    params->sensor_height = 0.03;
+    params->track_width = 0.15;
+    params->yaw_inertia = 1.0e-3;
+
+    params->wheel_radius = 0.0325;
+    params->wheel_inertia = 1.0e-5;
+    params->traction_gain = 40.0;
+    params->friction_coeff = 0.8;
+
+    params->battery_voltage = 7.4;
+    params->battery_resistance = 0.4;
+    params->resistance = 10.0;
+    params->torque_constant = 0.09;     // 0.003 N·m/A × 30
+    params->gear_inertia = 1.0e-5;
+    params->gear_friction = 2.0e-4;
+    params->backlash = 2.0 * M_PI / 180.0;
+    params->gear_stiffness = 3.0;
+    params->gear_damping = 0.004;
+    params->encoder_cpr = 13.0 * 4.0 * 30.0;
+
+    params->accel_noise = 0.006;
+    params->gyro_noise = 0.08;
+    params->gyro_bias = 1.0;
+
+    params->fall_angle = 80.0 * M_PI / 180.0;
+}
+
+void Plant_Init(Plant_HandleTypeDef *plant, const Plant_ParamsTypeDef *params, double theta0, uint32_t seed) {
+    memset(plant, 0, sizeof(*plant));
+    plant->params = *params;
+    plant->theta = theta0;
+    plant->battery_voltage = params->battery_voltage;
+    plant->rng = seed ? seed : 1;
+}
+
+// xorshift32 + Box-Muller，保证同一种子结果可复现
+static double Plant_Gaussian(Plant_HandleTypeDef *plant) {
+    double u[2];
+    for (int i = 0; i < 2; i++) {
+        uint32_t s = plant->rng;
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        plant->rng = s;
+        u[i] = (s + 0.5) / 4294967296.0;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
+
+// 读取桥臂输出电压：占空比 × 电池端电压，IN1/IN2决定极性（PWM低电平期间短路制动，平均电压按占空比计）
+// IN1、IN2同为高时短路制动（0V）；同为低时桥臂高阻，返回0并把*connected清零
+static double Plant_MotorVoltage(const Plant_HandleTypeDef *plant, uint32_t ccr, uint16_t in1_pin,
+                                 uint16_t in2_pin, int *connected) {
+    uint8_t in1 = SIM_GPIO_Read(MOTOR_DIR_PORT, in1_pin);
+    uint8_t in2 = SIM_GPIO_Read(MOTOR_DIR_PORT, in2_pin);
+    *connected = in1 || in2;
+    if (in1 == in2) {
+        return 0.0;
+    }
+    
+    double duty = (double)ccr / (double)(TIM1->ARR + 1);
+    if (duty > 1.0) {
+        duty = 1.0;
+    }
+    double voltage = duty * plant->battery_voltage;
+    return in1 ? voltage : -voltage;
+}
+
+// 单侧电机/齿轮间隙/车轮/地面摩擦，返回作用在车体上的反力矩
+// connected为0时电枢开路，没有电流（忽略反电动势超过电池电压时经体二极管的回馈）
+static double Plant_StepWheel(Plant_HandleTypeDef *plant, Plant_WheelTypeDef *w, double voltage,
+                              int connected, double ground_speed, double dt) {
+    const Plant_ParamsTypeDef *p = &plant->params;
+
+    // 电机电磁力矩（反电动势与转矩常数相同）
+    double current = connected ? (voltage - p->torque_constant * w->motor_speed) / p->resistance : 0.0;
+    double motor_torque = p->torque_constant * current - p->gear_friction * w->motor_speed;
+    w->current = current;
+
+    // 齿轮间隙：间隙内不传递力矩，接触后为弹簧阻尼
+    double half_gap = 0.5 * p->backlash;
+    double deflection = w->motor_angle - w->wheel_angle;
+    double contact = 0.0;
+    if (deflection > half_gap) {
+        contact = p->gear_stiffness * (deflection - half_gap);
+    } else if (deflection < -half_gap) {
+        contact = p->gear_stiffness * (deflection + half_gap);
+    }
+    if (contact != 0.0) {
+        contact += p->gear_damping * (w->motor_speed - w->wheel_speed);
+    }
+    w->contact_torque = contact;
+
+    // 轮胎打滑：摩擦力与滑移速度成正比，超过最大静摩擦后饱和
+    double traction = 0.0;
+    if (!plant->held) {
+        double normal = 0.5 * (p->body_mass + p->base_mass) * GRAVITY;
+        double slip = (w->wheel_speed + plant->omega) * p->wheel_radius - ground_speed;
+        double limit = p->friction_coeff * normal;
+        traction = -p->traction_gain * slip;
+        if (traction > limit) traction = limit;
+        if (traction < -limit) traction = -limit;
+    }
+    w->traction = -traction; // 地面对底盘的推力与车轮受力相反
+
+    // 转动惯量均以车体为参考系，减去车体角加速度
+    w->motor_speed += ((motor_torque - contact) / p->gear_inertia - plant->alpha) * dt;
+    w->wheel_speed += ((contact + traction * p->wheel_radius) / p->wheel_inertia - plant->alpha) * dt;
+    w->motor_angle += w->motor_speed * dt;
+    w->wheel_angle += w->wheel_speed * dt;
+
+    return motor_torque;
+}
+
+static void Plant_UpdateEncoder(Plant_WheelTypeDef *w, TIM_TypeDef *tim, double cpr) {
+    int32_t count = (int32_t)floor(w->motor_angle / (2.0 * M_PI) * cpr);
+    int32_t delta = count - w->encoder_count;
+    w->encoder_count = count;
+    tim->CNT = (tim->CNT + (uint32_t)delta) & 0xFFFFU;
+}
+
+void Plant_Step(Plant_HandleTypeDef *plant, double dt) {
+    const Plant_ParamsTypeDef *p = &plant->params;
+    double half_track = 0.5 * p->track_width;
+
+    double v_left = plant->v - plant->yaw_rate * half_track;
+    double v_right = plant->v + plant->yaw_rate * half_track;
+
+    int connected_left, connected_right;
+    double voltage_left = Plant_MotorVoltage(plant, TIM1->CCR1, MOTOR_A_IN1_PIN, MOTOR_A_IN2_PIN, &connected_left);
+    double voltage_right = Plant_MotorVoltage(plant, TIM1->CCR4, MOTOR_B_IN1_PIN, MOTOR_B_IN2_PIN, &connected_right);
+    double torque = Plant_StepWheel(plant, &plant->left, voltage_left, connected_left, v_left, dt);
+    torque += Plant_StepWheel(plant, &plant->right, voltage_right, connected_right, v_right, dt);
+
+    // 电池：桥臂输出功率折算为电池电流（反电动势大于输出电压时回馈为负），端电压用于下一步
+    plant->battery_current = (voltage_left * plant->left.current + voltage_right * plant->right.current) /
+                             plant->battery_voltage;
+    plant->battery_voltage = p->battery_voltage - p->battery_resistance * plant->battery_current;
+
+    Plant_UpdateEncoder(&plant->left, TIM2, p->encoder_cpr);
+    Plant_UpdateEncoder(&plant->right, TIM3, p->encoder_cpr);
+
+    if (plant->held || plant->fallen) {
+        plant->accel = 0.0;
+        plant->alpha = 0.0;
+        return;
+    }
+
+    // 底盘平动与车体俯仰耦合方程：
+    //   (M+m)ẍ + ml·cosθ·θ̈ = F + ml·sinθ·θ̇²
+    //   ml·cosθ·ẍ + (I+ml²)θ̈ = mgl·sinθ - τ
+    double force = plant->left.traction + plant->right.traction;
+    double m = p->body_mass;
+    double l = p->com_height;
+    double c = cos(plant->theta);
+    double s = sin(plant->theta);
+
+    double a11 = p->base_mass + m;
+    double a12 = m * l * c;
+    double a22 = p->body_inertia + m * l * l;
+    double b1 = force + m * l * s * plant->omega * plant->omega;
+    double b2 = m * GRAVITY * l * s - torque;
+    double det = a11 * a22 - a12 * a12;
+
+    plant->accel = (b1 * a22 - a12 * b2) / det;
+    plant->alpha = (a11 * b2 - a12 * b1) / det;
+
+    plant->v += plant->accel * dt;
+    plant->x += plant->v * dt;
+    plant->omega += plant->alpha * dt;
+    plant->theta += plant->omega * dt;
+
+    // 转向：左右推力差产生偏航力矩
+    double yaw_torque = (plant->right.traction - plant->left.traction) * half_track;
+    plant->yaw_rate += (yaw_torque / p->yaw_inertia - 0.5 * plant->yaw_rate) * dt;
+    plant->yaw += plant->yaw_rate * dt;
+
+    // 倒地：车体贴地不再转动，底盘停止
+    if (fabs(plant->theta) >= p->fall_angle) {
+        plant->theta = copysign(p->fall_angle, plant->theta);
+        plant->omega = 0.0;
+        plant->v = 0.0;
+        plant->yaw_rate = 0.0;
+        plant->fallen = 1;
+    }
+}
+
+static int16_t Plant_Saturate(double value) {
+    if (value > 32767.0) return 32767;
+    if (value < -32768.0) return -32768;
+    return (int16_t)lrint(value);
+}
+
+// 传感器安装方向：Y轴指向车头，Z轴沿车体向上，X轴为俯仰轴；
+// 固件解算的 angleX = atan2(accelY, accelZ) 在车体前倾时为负
+void Plant_WriteSensors(Plant_HandleTypeDef *plant) {
+    const Plant_ParamsTypeDef *p = &plant->params;
+    double c = cos(plant->theta);
+    double s = sin(plant->theta);
+    double h = p->sensor_height;
+
+    // 传感器处的加速度（世界坐标，x向前，z向上）
+    double ax = plant->accel + h * (plant->alpha * c - plant->omega * plant->omega * s);
+    double az = -h * (plant->alpha * s + plant->omega * plant->omega * c);
+
+    // 比力投影到车体坐标
+    double f_forward = ax * c - (az + GRAVITY) * s;
+    double f_up = ax * s + (az + GRAVITY) * c;
+
+    double accel_y = f_forward / GRAVITY + p->accel_noise * Plant_Gaussian(plant);
+    double accel_z = f_up / GRAVITY + p->accel_noise * Plant_Gaussian(plant);
+    double accel_x = p->accel_noise * Plant_Gaussian(plant);
+
+    double gyro_x = -plant->omega * 180.0 / M_PI + p->gyro_bias + p->gyro_noise * Plant_Gaussian(plant);
+    double gyro_y = p->gyro_noise * Plant_Gaussian(plant);
+    double gyro_z = plant->yaw_rate * 180.0 / M_PI + p->gyro_noise * Plant_Gaussian(plant);
+
+    SIM_ADC_SetInput(BATTERY_ADC_CHANNEL, plant->battery_voltage / BATTERY_DIVIDER);
+
+    SIM_MPU6050_SetRaw(Plant_Saturate(accel_x * 16384.0),
+                       Plant_Saturate(accel_y * 16384.0),
+                       Plant_Saturate(accel_z * 16384.0),
+                       Plant_Saturate(gyro_x * 131.0),
+                       Plant_Saturate(gyro_y * 131.0),
+                       Plant_Saturate(gyro_z * 131.0));
+}
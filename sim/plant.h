@@ -0,0 +1,90 @@
+#ifndef PLANT_H
+#define PLANT_H
+
+#include <stdint.h>
+
+/*
+ * 两轮倒立摆物理模型
+ *
+ * 输入：TIM1 CCR1/CCR4 占空比与TB6612的IN1/IN2引脚（即 Motor_SetSpeed/Motor_Stop 的输出）
+ * 输出：MPU6050 加速度计/陀螺仪寄存器、TIM2/TIM3 编码器计数、电池分压后的ADC输入电压
+ *
+ * 车体为绕轮轴转动的摆杆，底盘在地面平动/转向。每个电机包含
+ * 电枢电阻、反电动势、齿轮间隙（弹簧阻尼接触）和轮胎打滑（限幅摩擦）。
+ * 电池为开路电压加内阻，端电压随两个电机从电池取的电流下降。
+ */
+
+// 模型参数
+typedef struct {
+    // 车体
+    double body_mass;           // 摆杆（车体）质量 kg
+    double base_mass;           // 底盘+车轮质量 kg
+    double com_height;          // 车体质心到轮轴距离 m
+    double body_inertia;        // 车体绕质心转动惯量 kg·m²
+    double sensor_height;       // MPU6050到轮轴距离 m
+    double track_width;         // 轮距 m
+    double yaw_inertia;         // 绕竖直轴转动惯量 kg·m²
+
+    // 车轮与地面
+    double wheel_radius;        // 轮半径 m
+    double wheel_inertia;       // 单轮转动惯量 kg·m²
+    double traction_gain;       // 打滑速度→摩擦力 N/(m/s)
+    double friction_coeff;      // 最大静摩擦系数
+
+    // 电机（参数均折算到减速器输出轴）
+    double battery_voltage;     // 电池开路电压 V
+    double battery_resistance;  // 电池内阻（含导线和驱动桥）Ω
+    double resistance;          // 电枢电阻 Ω
+    double torque_constant;     // 转矩常数 N·m/A（输出轴）
+    double gear_inertia;        // 电机转子折算惯量 kg·m²
+    double gear_friction;       // 减速器粘滞摩擦 N·m·s/rad
+    double backlash;            // 齿轮间隙（总量）rad
+    double gear_stiffness;      // 齿轮接触刚度 N·m/rad
+    double gear_damping;        // 齿轮接触阻尼 N·m·s/rad
+    double encoder_cpr;         // 输出轴每转编码器计数（四倍频后）
+
+    // 传感器
+    double accel_noise;         // 加速度计噪声标准差 g
+    double gyro_noise;          // 陀螺仪噪声标准差 °/s
+    double gyro_bias;           // X轴陀螺仪零偏 °/s
+
+    double fall_angle;          // 车体触地角度 rad
+} Plant_ParamsTypeDef;
+
+// 单侧电机/车轮状态
+typedef struct {
+    double motor_angle;         // 减速器输出轴相对车体转角 rad
+    double motor_speed;         // 减速器输出轴相对车体角速度 rad/s
+    double wheel_angle;         // 车轮相对车体转角 rad
+    double wheel_speed;         // 车轮相对车体角速度 rad/s
+    double traction;            // 地面摩擦力 N
+    double contact_torque;      // 齿轮传递力矩 N·m
+    double current;             // 电枢电流 A
+    int32_t encoder_count;      // 已写入编码器的整数计数
+} Plant_WheelTypeDef;
+
+// 模型状态
+typedef struct {
+    Plant_ParamsTypeDef params;
+
+    double x, v;                // 底盘位置/速度 m, m/s
+    double theta, omega;        // 车体倾角/角速度 rad, rad/s（向前倾为正）
+    double yaw, yaw_rate;       // 航向角/角速度 rad, rad/s
+    double accel;               // 底盘加速度 m/s²
+    double alpha;               // 车体角加速度 rad/s²
+    double battery_voltage;     // 电池端电压 V
+    double battery_current;     // 电池输出电流 A
+
+    Plant_WheelTypeDef left, right;
+
+    uint8_t held;               // 非零时车体被手扶住，不参与动力学
+    uint8_t fallen;             // 车体已触地
+    uint32_t rng;               // 噪声随机数状态
+} Plant_HandleTypeDef;
+
+void Plant_DefaultParams(Plant_ParamsTypeDef *params);
+void Plant_Init(Plant_HandleTypeDef *plant, const Plant_ParamsTypeDef *params, double theta0, uint32_t seed);
+void Plant_Step(Plant_HandleTypeDef *plant, double dt);
+void Plant_WriteSensors(Plant_HandleTypeDef *plant);
+
+#endif
@@ -0,0 +1,365 @@
+/*
+ * 传感器记录回放：把记录的原始MPU6050数据送入固件的解算、滤波和控制代码，逐控制周期输出计算结果
+ *
+ *   replay --log raw.csv [--out out.csv] [--start-us T] [--gyro-offset 度/秒] [--filter kalman|comp|mahony]
+ *   replay --blackbox uart.bin [--out out.csv] [--gyro-offset 度/秒] [--filter 名称] [--warmup N] [--tolerance 度]
+ *
+ * --log      : sim run --sensor-log 格式的CSV（t_us,ax,ay,az,gx,gy,gz[,angle]，IMU采样率）。按控制周期分批，
+ *              与固件FIFO模式相同地用 MPU6050_ProcessSum 解算每批的累加值（数据就绪模式取每批最后一个样本）；
+ *              --start-us 之前的样本跳过（对应固件初始化期间，控制循环尚未启动）
+ * --blackbox : 串口原始字节（含 get blackbox 导出的记录帧），每条记录即一个控制周期。
+ *              头帧给出陀螺仪零偏校准值（--gyro-offset 可覆盖X轴）和姿态滤波器（--filter 可覆盖）；记录中的原始寄存器经 MPU6050_ProcessRaw 解算，
+ *              编码器增量写入TIM2/TIM3计数器。第一条记录只用于给出滤波器的角度和零偏初值，
+ *              此后每条的输出与记录中的角度、PID项、占空比比较，跳过前 --warmup 条后
+ *              角度最大偏差超过 --tolerance 时返回1。P项与占空比只统计偏差、不作判定：环形记录区回绕后
+ *              导出从运行中途开始，此前的速度环（给出直立环目标角）、转向环和直立环积分状态以及外环的
+ *              分频相位都不在记录中，回放从清零状态开始，目标角不同使P项和占空比偏离记录；
+ *              用第一条记录的P/I项反推这些状态也不能消除（速度环积分仍未知），运行中修改的PID参数同样不在记录中
+ * --filter   : 姿态滤波器（Attitude_ParseName 的名称），--log 默认 ATTITUDE_FILTER
+ *
+ * 两种输入都逐行/逐块流式处理，内存占用与记录长度无关。时间全部取自记录的时间戳，
+ * 不经过 HAL_GetTick，同一份记录每次回放的输出完全相同。
+ * 输出CSV：t_us,dt,angle,rate,bias,p_term,i_term,d_term,output,duty_left,duty_right,speed,turn
+ */
+#include "hal_sim.h"
+#include "mpu6050.h"
+#include "attitude.h"
+#include "pid.h"
+#include "motor.h"
+#include "control.h"
+#include "telemetry.h"
+#include "telemetry_stream.h"
+#include "parameters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_PERIOD_US    (1000000 / CONTROL_RATE_HZ)
+#define REPLAY_SETTLE_STEPS 100000  // 恢复协方差时最多运行的滤波步数
+
+// 一项偏差统计
+typedef struct {
+    double max;
+    double sum_sq;
+} Replay_DiffTypeDef;
+
+// 回放状态
+typedef struct {
+    MPU6050_HandleTypeDef hmpu;
+    Attitude_HandleTypeDef hattitude;
+    Motor_HandleTypeDef hmotor;
+    Control_HandleTypeDef hcontrol;
+    float gyro_offset[3];
+    int gyro_offset_set;            // 命令行给出了X轴零偏，不用头帧中的值
+    Attitude_FilterTypeDef filter;
+    int filter_set;                 // 命令行给出了滤波器，不用头帧中的值
+    FILE *out;
+    uint32_t cycles;                // 已回放的控制周期数
+
+    // --blackbox：与记录比较
+    uint32_t warmup;
+    uint32_t compared;
+    uint32_t dumps;
+    Replay_DiffTypeDef angle;
+    Replay_DiffTypeDef p_term;
+    Replay_DiffTypeDef duty;
+} Replay_StateTypeDef;
+
+// 被测模块引用的定时器句柄（固件中定义在main.c）
+TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+
+// replay不运行固件main()，只链接被测模块
+int Firmware_Main(void) {
+    return 0;
+}
+
+// 重新开始：滤波器、控制器和编码器回到上电后的状态
+static void Replay_Reset(Replay_StateTypeDef *state) {
+    memset(&state->hmpu, 0, sizeof(state->hmpu));
+    state->hmpu.gyroXoffset = state->gyro_offset[0];
+    state->hmpu.gyroYoffset = state->gyro_offset[1];
+    state->hmpu.gyroZoffset = state->gyro_offset[2];
+    Attitude_Init(&state->hattitude, state->filter);
+    __HAL_TIM_SET_COUNTER(&htim2, 0);
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    Motor_Init(&state->hmotor, &htim1);
+    Control_Init(&state->hcontrol, &state->hmotor);
+}
+
+// 一个控制周期：与固件 Control_Loop 相同的滤波和控制链路（传感器数据已解算到hmpu）
+static void Replay_Control(Replay_StateTypeDef *state, uint64_t t_us, float dt) {
+    float angle = Attitude_Update(&state->hattitude, &state->hmpu, dt);
+    Motor_UpdateEncoders(&state->hmotor, dt);
+    Control_Step(&state->hcontrol, angle, dt);
+    state->cycles++;
+
+    if (state->out == NULL) {
+        return;
+    }
+    float p_term, i_term, d_term;
+    PID_GetTerms(&state->hcontrol.angle, &p_term, &i_term, &d_term);
+    fprintf(state->out, "%llu,%.6f,%.4f,%.3f,%.4f,%.2f,%.2f,%.2f,%.2f,%d,%d,%.4f,%.4f\n",
+            (unsigned long long)t_us, dt, angle, Attitude_GetRate(&state->hattitude), Attitude_GetBias(&state->hattitude),
+            p_term, i_term, d_term, state->hcontrol.balance_output,
+            state->hmotor.speed_left, state->hmotor.speed_right, state->hcontrol.speed, state->hcontrol.turn);
+}
+
+// CSV记录：按控制周期分批回放，返回回放的控制周期数，打不开文件返回-1
+static long Replay_Csv(Replay_StateTypeDef *state, const char *path, uint64_t start_us) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char line[128];
+    unsigned long long t_us;
+    int raw[6];
+    int32_t sum[6] = {0};
+    uint8_t buffer[MPU6050_BURST_SIZE];
+    uint8_t samples = 0;
+    uint64_t batch = 0;
+    uint64_t batch_t = 0;
+    uint64_t last_t = 0;
+
+    memset(buffer, 0, sizeof(buffer));
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%llu,%d,%d,%d,%d,%d,%d", &t_us,
+                   &raw[0], &raw[1], &raw[2], &raw[3], &raw[4], &raw[5]) != 7) {
+            continue;   // 表头
+        }
+        if (t_us < start_us) {
+            continue;
+        }
+
+        // 进入下一个控制周期：回放上一批
+        if (samples > 0 && t_us / REPLAY_PERIOD_US != batch) {
+#if IMU_FIFO_MODE
+            MPU6050_ProcessSum(&state->hmpu, sum, samples);
+#else
+            MPU6050_ProcessRaw(&state->hmpu, buffer);
+#endif
+            float dt = (last_t == 0) ? REPLAY_PERIOD_US * 1e-6f : (float)((batch_t - last_t) * 1e-6);
+            Replay_Control(state, batch_t, dt);
+            last_t = batch_t;
+            memset(sum, 0, sizeof(sum));
+            samples = 0;
+        }
+
+        batch = t_us / REPLAY_PERIOD_US;
+        batch_t = t_us;
+        for (int i = 0; i < 6; i++) {
+            sum[i] += raw[i];
+        }
+        samples++;
+        for (int i = 0; i < 3; i++) {
+            buffer[2 * i] = (uint8_t)((uint16_t)raw[i] >> 8);
+            buffer[2 * i + 1] = (uint8_t)raw[i];
+            buffer[8 + 2 * i] = (uint8_t)((uint16_t)raw[3 + i] >> 8);
+            buffer[8 + 2 * i + 1] = (uint8_t)raw[3 + i];
+        }
+    }
+    fclose(file);
+    return (long)state->cycles;
+}
+
+static void Replay_Diff(Replay_DiffTypeDef *diff, double value) {
+    if (fabs(value) > diff->max) {
+        diff->max = fabs(value);
+    }
+    diff->sum_sq += value * value;
+}
+
+// 黑匣子导出：头帧给出零偏校准值和滤波器，序号为0的记录开始一次新的回放
+static void Replay_Frame(const uint8_t *frame, uint16_t len, void *ctx) {
+    Replay_StateTypeDef *state = ctx;
+    Telemetry_BlackboxInfoTypeDef info;
+    Telemetry_RecordTypeDef r;
+    uint16_t index;
+    uint32_t t_us;
+
+    if (Telemetry_DecodeBlackboxInfo(frame, len, &info)) {
+        if (info.rate_hz != CONTROL_RATE_HZ) {
+            fprintf(stderr, "警告: 记录的控制频率为 %u Hz，回放使用 %d Hz\n", info.rate_hz, CONTROL_RATE_HZ);
+        }
+        if (!state->gyro_offset_set) {
+            state->gyro_offset[0] = info.gyro_offset[0];
+        }
+        state->gyro_offset[1] = info.gyro_offset[1];
+        state->gyro_offset[2] = info.gyro_offset[2];
+        if (!state->filter_set && info.filter < ATTITUDE_COUNT) {
+            state->filter = (Attitude_FilterTypeDef)info.filter;
+        }
+        return;
+    }
+    if (!Telemetry_DecodeRecord(frame, len, &r, &index, &t_us)) {
+        return;     // 状态帧等其他类型
+    }
+
+    uint8_t buffer[MPU6050_BURST_SIZE];
+    memset(buffer, 0, sizeof(buffer));
+    for (int i = 0; i < 3; i++) {
+        buffer[2 * i] = (uint8_t)((uint16_t)r.accel[i] >> 8);
+        buffer[2 * i + 1] = (uint8_t)r.accel[i];
+        buffer[8 + 2 * i] = (uint8_t)((uint16_t)r.gyro[i] >> 8);
+        buffer[8 + 2 * i + 1] = (uint8_t)r.gyro[i];
+    }
+
+    // 第一条记录已是滤波后的结果，只取它的状态作为初值
+    // 卡尔曼滤波的协方差递推与测量值无关，只由dt和噪声参数决定，且P[1][1]从0开始单调增大：
+    // 用零输入递推到P[1][1]达到记录值，即得到与记录时刻一致的P和卡尔曼增益
+    if (index == 0) {
+        float p00, p11;
+        Replay_Reset(state);
+        state->dumps++;
+        for (int i = 0; state->filter == ATTITUDE_KALMAN && i < REPLAY_SETTLE_STEPS; i++) {
+            Kalman_GetCovariance(&state->hattitude.kalman, &p00, &p11);
+            if (p11 >= r.p11 / TELEMETRY_COV_SCALE) {
+                break;
+            }
+            Kalman_UpdateDt(&state->hattitude.kalman, 0.0f, 0.0f, r.dt_us * 1e-6f);
+        }
+        Attitude_SetAngle(&state->hattitude, r.angle / TELEMETRY_ANGLE_SCALE);
+        Attitude_SetBias(&state->hattitude, r.bias / TELEMETRY_BIAS_SCALE);
+        return;
+    }
+    if (state->dumps == 0) {
+        return;     // 没有收到这次导出的开头
+    }
+
+    __HAL_TIM_SET_COUNTER(&htim2, (uint16_t)(__HAL_TIM_GET_COUNTER(&htim2) + r.encoder_left));
+    __HAL_TIM_SET_COUNTER(&htim3, (uint16_t)(__HAL_TIM_GET_COUNTER(&htim3) + r.encoder_right));
+    MPU6050_ProcessRaw(&state->hmpu, buffer);
+    Replay_Control(state, t_us, r.dt_us * 1e-6f);
+
+    if (index < state->warmup) {
+        return;
+    }
+    float p_term, i_term, d_term;
+    PID_GetTerms(&state->hcontrol.angle, &p_term, &i_term, &d_term);
+    Replay_Diff(&state->angle, Attitude_GetAngle(&state->hattitude) - r.angle / TELEMETRY_ANGLE_SCALE);
+    Replay_Diff(&state->p_term, p_term - r.p_term / TELEMETRY_PID_SCALE);
+    Replay_Diff(&state->duty, state->hmotor.speed_left - r.duty_left);
+    state->compared++;
+}
+
+// 串口字节流中的黑匣子记录：回放并与记录比较，超出容差返回1
+static int Replay_Blackbox(Replay_StateTypeDef *state, const char *path, double tolerance) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    TelemetryStream_HandleTypeDef stream;
+    TelemetryStream_Init(&stream, Replay_Frame, NULL, state);
+
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        TelemetryStream_Feed(&stream, buffer, n);
+    }
+    fclose(file);
+
+    fprintf(stderr, "导出 %u 次，回放 %u 条记录，比较 %u 条（跳过每次导出的前 %u 条），陀螺仪零偏 %.3f°/s，滤波器 %s\n",
+            state->dumps, state->cycles, state->compared, state->warmup, state->gyro_offset[0],
+            Attitude_GetName(state->filter));
+    if (state->compared == 0) {
+        fprintf(stderr, "%s: 没有可比较的黑匣子记录\n", path);
+        return 1;
+    }
+    double n_cmp = state->compared;
+    fprintf(stderr, "%-10s %12s %12s\n", "量", "最大偏差", "RMS偏差");
+    fprintf(stderr, "%-10s %12.4f %12.4f\n", "angle", state->angle.max, sqrt(state->angle.sum_sq / n_cmp));
+    fprintf(stderr, "%-10s %12.4f %12.4f\n", "p_term", state->p_term.max, sqrt(state->p_term.sum_sq / n_cmp));
+    fprintf(stderr, "%-10s %12.4f %12.4f\n", "duty", state->duty.max, sqrt(state->duty.sum_sq / n_cmp));
+
+    fprintf(stderr, "P项与占空比不作判定：导出前的速度环/转向环和直立环积分状态不在记录中，回放从清零状态开始，"
+            "直立环目标角与记录不同（运行中修改的PID参数同样不在记录中）\n");
+
+    int pass = state->angle.max <= tolerance;
+    fprintf(stderr, "角度最大偏差 %.4f°，容差 %.4f°：%s\n", state->angle.max, tolerance, pass ? "通过" : "不一致");
+    return pass ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    const char *log_path = NULL;
+    const char *blackbox_path = NULL;
+    const char *out_path = NULL;
+    uint64_t start_us = 0;
+    double tolerance = 0.05;
+    static Replay_StateTypeDef state;
+
+    state.warmup = 20;
+    state.filter = (Attitude_FilterTypeDef)ATTITUDE_FILTER;
+
+    for (int i = 1; i < argc; i++) {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val != NULL && strcmp(argv[i], "--log") == 0) {
+            log_path = val;
+        } else if (val != NULL && strcmp(argv[i], "--blackbox") == 0) {
+            blackbox_path = val;
+        } else if (val != NULL && strcmp(argv[i], "--out") == 0) {
+            out_path = val;
+        } else if (val != NULL && strcmp(argv[i], "--start-us") == 0) {
+            start_us = strtoull(val, NULL, 0);
+        } else if (val != NULL && strcmp(argv[i], "--gyro-offset") == 0) {
+            state.gyro_offset[0] = (float)atof(val);
+            state.gyro_offset_set = 1;
+        } else if (val != NULL && strcmp(argv[i], "--filter") == 0) {
+            if (!Attitude_ParseName(val, &state.filter)) {
+                fprintf(stderr, "未知滤波器: %s（kalman/comp/mahony）\n", val);
+                return 1;
+            }
+            state.filter_set = 1;
+        } else if (val != NULL && strcmp(argv[i], "--warmup") == 0) {
+            state.warmup = (uint32_t)strtoul(val, NULL, 0);
+        } else if (val != NULL && strcmp(argv[i], "--tolerance") == 0) {
+            tolerance = atof(val);
+        } else {
+            fprintf(stderr, "用法: %s --log raw.csv | --blackbox uart.bin [--out out.csv] [--start-us T] "
+                    "[--gyro-offset 度/秒] [--filter 名称] [--warmup N] [--tolerance 度]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if ((log_path == NULL) == (blackbox_path == NULL)) {
+        fprintf(stderr, "需要 --log 或 --blackbox 之一\n");
+        return 1;
+    }
+
+    htim1.Instance = TIM1;
+    htim2.Instance = TIM2;
+    htim3.Instance = TIM3;
+    SIM_Reset();
+
+    if (out_path != NULL) {
+        state.out = fopen(out_path, "w");
+        if (state.out == NULL) {
+            perror(out_path);
+            return 1;
+        }
+        fprintf(state.out, "t_us,dt,angle,rate,bias,p_term,i_term,d_term,output,duty_left,duty_right,speed,turn\n");
+    }
+
+    int result;
+    if (log_path != NULL) {
+        Replay_Reset(&state);
+        long cycles = Replay_Csv(&state, log_path, start_us);
+        if (cycles >= 0) {
+            fprintf(stderr, "回放 %ld 个控制周期\n", cycles);
+        }
+        result = (cycles > 0) ? 0 : 1;
+    } else {
+        result = Replay_Blackbox(&state, blackbox_path, tolerance);
+    }
+
+    if (state.out != NULL) {
+        fclose(state.out);
+    }
+    return result;
+}
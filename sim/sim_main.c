@@ -0,0 +1,685 @@
+/*
+ * 平衡小车主机仿真入口
+ *
+ *   sim run     [--seconds N] [--theta0 度] [--kp K] [--ki K] [--kd K] [--cmd "..."]
+ *               [--scenario plant|sine] [--seed N] [--trace out.csv] [--sensor-log raw.csv]
+ *               [--uart-log uart.bin] [--flash flash.bin] [--echo] [--profile] [--after "..."] [--pickup 秒]
+ *               [--battery 伏]
+ *   sim sweep   [--kp 起:止:步长] [--ki ...] [--kd ...] [--theta0 度] [--seconds N]
+ *   sim profile [--iterations N]
+ *
+ * run     : 在虚拟时钟下运行固件main()。默认接入倒立摆物理模型：初始化期间
+ *           车体被扶在theta0倾角静止，固件开始驱动电机（进入平衡）时松手，统计调节时间与超调；
+ *           --kp/--ki/--kd 在此之前（校准期间）下发，--cmd 在松手前下发；车体倒地时（未给 --pickup）返回1
+ * sweep   : 对PID参数网格逐点运行run（每点独立子进程），输出对比表
+ * profile : 直接循环调用 MPU6050_ReadData → Kalman_UpdateDt → Control_Step
+ *           → Communication_SendTelemetry，统计每级主机耗时
+ *
+ * 串口输出：--uart-log 原样记录发送的字节（可用 telemetry_decode 转为CSV）；
+ * --echo 把文本直接打印到终端，遥测帧解码后每帧打印一行；
+ * --profile 运行结束后打印固件各级耗时统计（与 get profile 相同）；
+ * --after 在运行结束后下发命令并继续运行 SIM_AFTER_US（不计入指标），如 --after "get blackbox"
+ * --flash 片上闪存镜像：运行前载入（文件不存在时为擦除状态），运行后写回，校准数据在多次运行之间保留
+ * --pickup 倒地后经过给定秒数把车体扶起到 SIM_PICKUP_ANGLE，扶住 SIM_PICKUP_HOLD_S 后再松手（检验倒地停机和重新平衡）
+ * --battery 电池开路电压（默认为标称电压 BATTERY_NOMINAL_VOLTAGE），物理模型中端电压随电机电流下降，
+ *           经 BATTERY_DIVIDER 分压后送到ADC（检验电压补偿和欠压停机）
+ */
+#include "hal_sim.h"
+#include "mpu6050_sim.h"
+#include "plant.h"
+#include "mpu6050.h"
+#include "kalman.h"
+#include "pid.h"
+#include "motor.h"
+#include "control.h"
+#include "communication.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "telemetry_stream.h"
+#include "pins.h"
+#include "parameters.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define SIM_SENSOR_PERIOD_US (1000000 / IMU_SAMPLE_RATE_HZ)   // 传感器采样周期（与固件配置的MPU6050采样率一致）
+#define SIM_PLANT_STEP_US    50     // 物理模型积分步长
+#define SIM_PLANT_SENSOR_DIV (SIM_SENSOR_PERIOD_US / SIM_PLANT_STEP_US)  // 每次采样之间的积分步数
+#define SIM_INIT_US          3000000 // 固件初始化所需虚拟时间（闪存中没有校准数据时含上电陀螺仪校准）
+#define SIM_INIT_POLL_US     1000   // 初始化期间等待固件状态的检查间隔
+#define SIM_SETTLE_BAND      1.0    // 调节时间判定带宽（度）
+#define SIM_AFTER_US         2000000 // --after 每条命令后继续运行的虚拟时间
+#define SIM_MAX_COMMANDS     8
+#define SIM_PICKUP_ANGLE     3.0    // --pickup 扶起后的倾角（度）
+#define SIM_PICKUP_HOLD_S    1.0    // --pickup 扶住的时间（秒，长于固件的RECOVER_TIME_MS）
+
+// 固件中的外设句柄与初始化函数
+extern I2C_HandleTypeDef hi2c1;
+extern TIM_HandleTypeDef htim1;
+extern UART_HandleTypeDef huart1;
+void MX_I2C1_Init(void);
+void MX_TIM1_Init(void);
+void MX_TIM2_Init(void);
+void MX_TIM3_Init(void);
+void MX_USART1_UART_Init(void);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+// 运行配置
+typedef struct {
+    double seconds;
+    double theta0;              // 初始倾角（度）
+    double pickup_s;            // 倒地后多久扶起，0为不扶起
+    double battery;             // 电池开路电压（伏）
+    double kp, ki, kd;          // 负数表示沿用固件默认值
+    uint32_t seed;
+    int use_plant;
+    int echo;
+    int profile;
+    const char *commands[SIM_MAX_COMMANDS];
+    int command_count;
+    const char *after_commands[SIM_MAX_COMMANDS];
+    int after_count;
+    const char *trace_path;
+    const char *sensor_log_path;
+    const char *uart_log_path;
+    const char *flash_path;
+} Sim_ConfigTypeDef;
+
+// 松手后的响应指标
+typedef struct {
+    double release_s;
+    double last_outside_s;      // 最后一次超出调节带的时间
+    double peak_overshoot;      // 越过零点后反向最大角度（度）
+    double sum_sq;
+    uint32_t samples;
+    double fall_s;              // 倒地时间
+    int fell;
+} Sim_MetricsTypeDef;
+
+static Plant_HandleTypeDef plant;
+static Sim_MetricsTypeDef metrics;
+static int plant_released = 0;
+static double pickup_s = 0.0;
+static double pickup_fallen_s = -1.0;   // 本次倒地的时刻
+static double pickup_release_s = -1.0;  // 扶住后松手的时刻
+static FILE *trace_file = NULL;
+static FILE *sensor_log_file = NULL;
+static FILE *uart_log_file = NULL;
+static int uart_echo = 0;
+static TelemetryStream_HandleTypeDef echo_stream;
+static double theta0_sign = 1.0;
+
+static double Host_Seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 方向列：1正转，-1反转，0为IN1/IN2相同（制动或停止）
+static int Trace_Direction(uint16_t in1_pin, uint16_t in2_pin) {
+    return (int)SIM_GPIO_Read(MOTOR_DIR_PORT, in1_pin) - (int)SIM_GPIO_Read(MOTOR_DIR_PORT, in2_pin);
+}
+
+static void Trace_Write(double t, double angle) {
+    fprintf(trace_file, "%.3f,%.3f,%u,%u,%d,%d,%u,%u\n", t, angle,
+            (unsigned)TIM1->CCR1, (unsigned)TIM1->CCR4,
+            Trace_Direction(MOTOR_A_IN1_PIN, MOTOR_A_IN2_PIN), Trace_Direction(MOTOR_B_IN1_PIN, MOTOR_B_IN2_PIN),
+            (unsigned)TIM2->CNT, (unsigned)TIM3->CNT);
+}
+
+// --echo：遥测帧解码为一行
+static void Echo_Frame(const uint8_t *frame, uint16_t len, void *ctx) {
+    Telemetry_SampleTypeDef sample;
+    uint16_t seq;
+    (void)ctx;
+    Telemetry_RecordTypeDef record;
+    uint32_t t_us;
+    if (Telemetry_DecodeState(frame, len, &sample, &seq)) {
+        printf("[遥测 %5u] t=%.3fs 角度:%.2f 角速度:%.1f P:%.1f I:%.1f D:%.1f 输出:%.1f 电压:%.2fV\n", seq,
+               sample.timestamp_us * 1e-6, sample.angle, sample.rate,
+               sample.p_term, sample.i_term, sample.d_term, sample.output, sample.voltage);
+    } else if (Telemetry_DecodeRecord(frame, len, &record, &seq, &t_us)) {
+        printf("[黑匣子 %4u] t=%.3fs 角度:%.2f 零偏:%.3f 占空比:%d/%d 编码器增量:%d/%d\n", seq,
+               t_us * 1e-6, record.angle / TELEMETRY_ANGLE_SCALE, record.bias / TELEMETRY_BIAS_SCALE,
+               record.duty_left, record.duty_right, record.encoder_left, record.encoder_right);
+    }
+}
+
+static void Echo_Text(uint8_t byte, void *ctx) {
+    (void)ctx;
+    putchar(byte);
+}
+
+// 固件串口发送的数据
+static void Sim_UartSink(const uint8_t *data, size_t size) {
+    if (uart_log_file != NULL) {
+        fwrite(data, 1, size, uart_log_file);
+    }
+    if (uart_echo) {
+        TelemetryStream_Feed(&echo_stream, data, size);
+    }
+}
+
+// 记录传感器寄存器中的原始值（每个采样周期一行），供 equiv 等离线工具回放
+// 最后一列为真实倾角（度，与固件 angleX 同号），供 estimators 统计姿态估计误差
+static void SensorLog_Write(uint64_t now_us, double angle) {
+    int16_t raw[7];
+    for (int i = 0; i < 7; i++) {
+        raw[i] = (int16_t)((SIM_MPU6050_GetReg(MPU6050_RA_ACCEL_XOUT_H + 2 * i) << 8) |
+                            SIM_MPU6050_GetReg(MPU6050_RA_ACCEL_XOUT_H + 2 * i + 1));
+    }
+    // raw[3] 为温度寄存器，不记录
+    fprintf(sensor_log_file, "%llu,%d,%d,%d,%d,%d,%d,%.4f\n", (unsigned long long)now_us,
+            raw[0], raw[1], raw[2], raw[4], raw[5], raw[6], angle);
+}
+
+// 脚本化传感器：倾角按正弦摆动，输出对应的加速度计/陀螺仪原始值
+static void Scripted_Sensor(uint64_t now_us, uint32_t dt_us) {
+    (void)dt_us;
+    const double amplitude = 5.0 * M_PI / 180.0;
+    const double omega = 2.0 * M_PI * 0.5;
+    double t = now_us * 1e-6;
+    double angle = amplitude * sin(omega * t);
+    double rate = amplitude * omega * cos(omega * t);
+
+    int16_t ay = (int16_t)lrint(16384.0 * sin(angle));
+    int16_t az = (int16_t)lrint(16384.0 * cos(angle));
+    int16_t gx = (int16_t)lrint(131.0 * rate * 180.0 / M_PI);
+    SIM_MPU6050_SetRaw(0, ay, az, gx, 0, 0);
+    if (sensor_log_file != NULL) {
+        SensorLog_Write(now_us, angle * 180.0 / M_PI);
+    }
+
+    if (trace_file != NULL && now_us % 10000 == 0) {
+        Trace_Write(t, angle * 180.0 / M_PI);
+    }
+}
+
+// --pickup：倒地一段时间后扶起，扶住一会儿再松手
+static void Plant_Pickup(double t) {
+    if (plant.fallen) {
+        if (pickup_fallen_s < 0.0) {
+            pickup_fallen_s = t;
+        }
+        if (t - pickup_fallen_s < pickup_s) {
+            return;
+        }
+        plant.fallen = 0;
+        plant.held = 1;
+        plant.theta = SIM_PICKUP_ANGLE * M_PI / 180.0;
+        plant.omega = 0.0;
+        plant.v = 0.0;
+        pickup_fallen_s = -1.0;
+        pickup_release_s = t + SIM_PICKUP_HOLD_S;
+        if (uart_echo) {
+            printf("[仿真] t=%.3fs 扶起到 %.1f°\n", t, SIM_PICKUP_ANGLE);
+        }
+    } else if (pickup_release_s >= 0.0 && t >= pickup_release_s) {
+        plant.held = 0;
+        pickup_release_s = -1.0;
+        if (uart_echo) {
+            printf("[仿真] t=%.3fs 松手\n", t);
+        }
+    }
+}
+
+// 物理模型步进，同时统计松手后的响应指标
+static void Plant_Hook(uint64_t now_us, uint32_t dt_us) {
+    static uint32_t sensor_div = 0;
+
+    Plant_Step(&plant, dt_us * 1e-6);
+    if (++sensor_div >= SIM_PLANT_SENSOR_DIV) {
+        sensor_div = 0;
+        Plant_WriteSensors(&plant);
+        if (sensor_log_file != NULL) {
+            // 物理模型向前倾为正，传感器 ay 为 -sinθ，固件解算的倾角为 -θ
+            SensorLog_Write(now_us, -plant.theta * 180.0 / M_PI);
+        }
+    }
+
+    if (!plant_released || now_us % 1000 != 0) {
+        return;
+    }
+
+    double t = now_us * 1e-6;
+    if (pickup_s > 0.0) {
+        Plant_Pickup(t);
+    }
+    double angle = plant.theta * 180.0 / M_PI;
+    if (fabs(angle) > SIM_SETTLE_BAND) {
+        metrics.last_outside_s = t;
+    }
+    if (-theta0_sign * angle > metrics.peak_overshoot) {
+        metrics.peak_overshoot = -theta0_sign * angle;
+    }
+    metrics.sum_sq += angle * angle;
+    metrics.samples++;
+    if (plant.fallen && !metrics.fell) {
+        metrics.fell = 1;
+        metrics.fall_s = t;
+    }
+
+    if (trace_file != NULL && now_us % 10000 == 0) {
+        Trace_Write(t, angle);
+    }
+}
+
+// --profile：固件耗时统计（周期数为主机时间折算）
+static void Sim_PrintProfile(void) {
+    char line[128];
+    Profiler_FormatHeader(line, sizeof(line));
+    printf("%s", line);
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        Profiler_FormatProbe((Profiler_ProbeTypeDef)i, line, sizeof(line));
+        printf("%s", line);
+    }
+}
+
+static int Sim_ParseOptions(Sim_ConfigTypeDef *cfg, int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val != NULL && strcmp(arg, "--seconds") == 0) {
+            cfg->seconds = atof(val);
+        } else if (val != NULL && strcmp(arg, "--theta0") == 0) {
+            cfg->theta0 = atof(val);
+        } else if (val != NULL && strcmp(arg, "--pickup") == 0) {
+            cfg->pickup_s = atof(val);
+        } else if (val != NULL && strcmp(arg, "--battery") == 0) {
+            cfg->battery = atof(val);
+        } else if (val != NULL && strcmp(arg, "--kp") == 0) {
+            cfg->kp = atof(val);
+        } else if (val != NULL && strcmp(arg, "--ki") == 0) {
+            cfg->ki = atof(val);
+        } else if (val != NULL && strcmp(arg, "--kd") == 0) {
+            cfg->kd = atof(val);
+        } else if (val != NULL && strcmp(arg, "--seed") == 0) {
+            cfg->seed = (uint32_t)strtoul(val, NULL, 0);
+        } else if (val != NULL && strcmp(arg, "--scenario") == 0) {
+            cfg->use_plant = strcmp(val, "sine") != 0;
+        } else if (val != NULL && strcmp(arg, "--trace") == 0) {
+            cfg->trace_path = val;
+        } else if (val != NULL && strcmp(arg, "--sensor-log") == 0) {
+            cfg->sensor_log_path = val;
+        } else if (val != NULL && strcmp(arg, "--uart-log") == 0) {
+            cfg->uart_log_path = val;
+        } else if (val != NULL && strcmp(arg, "--flash") == 0) {
+            cfg->flash_path = val;
+        } else if (val != NULL && strcmp(arg, "--cmd") == 0 && cfg->command_count < SIM_MAX_COMMANDS) {
+            cfg->commands[cfg->command_count++] = val;
+        } else if (val != NULL && strcmp(arg, "--after") == 0 && cfg->after_count < SIM_MAX_COMMANDS) {
+            cfg->after_commands[cfg->after_count++] = val;
+        } else if (strcmp(arg, "--echo") == 0) {
+            cfg->echo = 1;
+            continue;
+        } else if (strcmp(arg, "--profile") == 0) {
+            cfg->profile = 1;
+            continue;
+        } else {
+            fprintf(stderr, "未知参数: %s\n", arg);
+            return -1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+static void Sim_DefaultConfig(Sim_ConfigTypeDef *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->seconds = 10.0;
+    cfg->theta0 = 5.0;
+    cfg->battery = BATTERY_NOMINAL_VOLTAGE;
+    cfg->kp = cfg->ki = cfg->kd = -1.0;
+    cfg->seed = 1;
+    cfg->use_plant = 1;
+}
+
+static void Sim_Inject(const char *cmd) {
+    char line[80];
+    snprintf(line, sizeof(line), "%s\r", cmd);
+    SIM_UART_Inject(line);
+    SIM_RunFirmware(20000);
+}
+
+// 固件已发送启动信息：串口DMA接收已启动，可以下发命令
+static int Sim_UartReady(void) {
+    return SIM_GetStats()->uart_tx_bytes > 0;
+}
+
+// 固件开始驱动电机（校准结束、进入平衡）
+static int Sim_MotorsDriven(void) {
+    return Trace_Direction(MOTOR_A_IN1_PIN, MOTOR_A_IN2_PIN) != 0 ||
+           Trace_Direction(MOTOR_B_IN1_PIN, MOTOR_B_IN2_PIN) != 0;
+}
+
+// 运行固件直到条件成立，最长 SIM_INIT_US
+static void Sim_RunUntil(int (*done)(void)) {
+    for (uint64_t waited = 0; waited < SIM_INIT_US && !done(); waited += SIM_INIT_POLL_US) {
+        SIM_RunFirmware(SIM_INIT_POLL_US);
+    }
+}
+
+// 运行一次闭环仿真，返回松手后的指标
+static void Sim_Execute(const Sim_ConfigTypeDef *cfg) {
+    SIM_Reset();
+    memset(&metrics, 0, sizeof(metrics));
+    plant_released = 0;
+    pickup_s = cfg->pickup_s;
+    pickup_fallen_s = -1.0;
+    pickup_release_s = -1.0;
+    theta0_sign = (cfg->theta0 < 0.0) ? -1.0 : 1.0;
+    if (cfg->flash_path != NULL) {
+        SIM_Flash_Load(cfg->flash_path);
+    }
+
+    if (cfg->use_plant) {
+        Plant_ParamsTypeDef params;
+        Plant_DefaultParams(&params);
+        params.battery_voltage = cfg->battery;
+        Plant_Init(&plant, &params, cfg->theta0 * M_PI / 180.0, cfg->seed);
+        plant.held = 1;
+        SIM_SetStepHook(Plant_Hook, SIM_PLANT_STEP_US);
+    } else {
+        SIM_SetStepHook(Scripted_Sensor, SIM_SENSOR_PERIOD_US);
+        SIM_ADC_SetInput(BATTERY_ADC_CHANNEL, cfg->battery / BATTERY_DIVIDER);
+    }
+    uart_echo = cfg->echo;
+    if (uart_echo) {
+        TelemetryStream_Init(&echo_stream, Echo_Frame, Echo_Text, NULL);
+    }
+    if (uart_echo || uart_log_file != NULL) {
+        SIM_UART_SetSink(Sim_UartSink);
+    }
+
+    // 物理模型：PID参数在固件开始平衡前（校准期间）下发，固件开始驱动电机时松手。
+    // 悬空的车轮在扶住期间空转，速度环积分会在松手前饱和，因此松手时刻与固件进入平衡对齐
+    if (cfg->use_plant) {
+        Sim_RunUntil(Sim_UartReady);
+    } else {
+        SIM_RunFirmware(SIM_INIT_US);
+    }
+    char line[64];
+    if (cfg->kp >= 0.0) {
+        snprintf(line, sizeof(line), "set kp %g", cfg->kp);
+        Sim_Inject(line);
+    }
+    if (cfg->ki >= 0.0) {
+        snprintf(line, sizeof(line), "set ki %g", cfg->ki);
+        Sim_Inject(line);
+    }
+    if (cfg->kd >= 0.0) {
+        snprintf(line, sizeof(line), "set kd %g", cfg->kd);
+        Sim_Inject(line);
+    }
+    if (cfg->use_plant) {
+        Sim_RunUntil(Sim_MotorsDriven);
+    }
+    for (int i = 0; i < cfg->command_count; i++) {
+        Sim_Inject(cfg->commands[i]);
+    }
+
+    plant.held = 0;
+    plant_released = 1;
+    metrics.release_s = SIM_GetTimeUs() * 1e-6;
+    metrics.last_outside_s = metrics.release_s;
+    SIM_RunFirmware((uint64_t)(cfg->seconds * 1e6));
+
+    // 运行结束后的命令（如导出黑匣子），给足串口发送时间
+    plant_released = 0;
+    for (int i = 0; i < cfg->after_count; i++) {
+        Sim_Inject(cfg->after_commands[i]);
+        SIM_RunFirmware(SIM_AFTER_US);
+    }
+
+    if (cfg->flash_path != NULL && !SIM_Flash_Save(cfg->flash_path)) {
+        fprintf(stderr, "无法写入闪存镜像 %s\n", cfg->flash_path);
+    }
+}
+
+static void Sim_PrintMetricsHeader(void) {
+    printf("%8s %8s %8s %10s %10s %10s %10s\n", "kp", "ki", "kd", "调节时间s", "超调°", "RMS°", "倒地时间s");
+}
+
+static void Sim_PrintMetrics(const Sim_ConfigTypeDef *cfg) {
+    double settle = metrics.last_outside_s - metrics.release_s;
+    double rms = metrics.samples ? sqrt(metrics.sum_sq / metrics.samples) : 0.0;
+    char settle_text[16];
+    if (metrics.fell || metrics.last_outside_s >= metrics.release_s + cfg->seconds - 0.001) {
+        snprintf(settle_text, sizeof(settle_text), "-");
+    } else {
+        snprintf(settle_text, sizeof(settle_text), "%.3f", settle);
+    }
+    char fall_text[16];
+    if (metrics.fell) {
+        snprintf(fall_text, sizeof(fall_text), "%.3f", metrics.fall_s - metrics.release_s);
+    } else {
+        snprintf(fall_text, sizeof(fall_text), "-");
+    }
+    printf("%8.3f %8.3f %8.3f %10s %10.2f %10.2f %10s\n",
+           cfg->kp >= 0.0 ? cfg->kp : PID_KP, cfg->ki >= 0.0 ? cfg->ki : PID_KI,
+           cfg->kd >= 0.0 ? cfg->kd : PID_KD, settle_text, metrics.peak_overshoot, rms, fall_text);
+}
+
+static int Sim_Run(int argc, char **argv) {
+    Sim_ConfigTypeDef cfg;
+    Sim_DefaultConfig(&cfg);
+    if (Sim_ParseOptions(&cfg, argc, argv) != 0) {
+        return 1;
+    }
+
+    if (cfg.trace_path != NULL) {
+        trace_file = fopen(cfg.trace_path, "w");
+        if (trace_file == NULL) {
+            perror("trace");
+            return 1;
+        }
+        fprintf(trace_file, "t,angle,ccr1,ccr4,dir_a,dir_b,enc_a,enc_b\n");
+    }
+    if (cfg.sensor_log_path != NULL) {
+        sensor_log_file = fopen(cfg.sensor_log_path, "w");
+        if (sensor_log_file == NULL) {
+            perror("sensor-log");
+            return 1;
+        }
+        fprintf(sensor_log_file, "t_us,ax,ay,az,gx,gy,gz,angle\n");
+    }
+    if (cfg.uart_log_path != NULL) {
+        uart_log_file = fopen(cfg.uart_log_path, "wb");
+        if (uart_log_file == NULL) {
+            perror("uart-log");
+            return 1;
+        }
+    }
+
+    double host_start = Host_Seconds();
+    Sim_Execute(&cfg);
+    double host_elapsed = Host_Seconds() - host_start;
+
+    const SIM_StatsTypeDef *stats = SIM_GetStats();
+    double virtual_elapsed = SIM_GetTimeUs() * 1e-6;
+    printf("虚拟时间: %.3f s, 主机耗时: %.3f s, 加速比: %.0fx\n",
+           virtual_elapsed, host_elapsed, virtual_elapsed / host_elapsed);
+    printf("I2C传输: %u (DMA %u), 数据就绪中断: %u, UART发送: %u 字节 (DMA %u 次), UART接收: %u 字节\n",
+           stats->i2c_transfers, stats->i2c_dma_transfers, stats->exti_events,
+           stats->uart_tx_bytes, stats->uart_dma_transfers, stats->uart_rx_bytes);
+    if (cfg.use_plant) {
+        Sim_PrintMetricsHeader();
+        Sim_PrintMetrics(&cfg);
+    }
+    if (cfg.profile) {
+        Sim_PrintProfile();
+    }
+
+    if (trace_file != NULL) {
+        fclose(trace_file);
+    }
+    if (sensor_log_file != NULL) {
+        fclose(sensor_log_file);
+    }
+    if (uart_log_file != NULL) {
+        fclose(uart_log_file);
+    }
+    // --pickup 检验的就是倒地停机和重新平衡，倒地不算失败
+    if (cfg.use_plant && metrics.fell && cfg.pickup_s <= 0.0) {
+        fprintf(stderr, "车体在松手后 %.3f 秒倒地\n", metrics.fall_s - metrics.release_s);
+        return 1;
+    }
+    return 0;
+}
+
+// 解析 "起:止:步长" 或单个数值
+static int Sweep_ParseRange(const char *text, double range[3]) {
+    int n = sscanf(text, "%lf:%lf:%lf", &range[0], &range[1], &range[2]);
+    if (n == 1) {
+        range[1] = range[0];
+        range[2] = 1.0;
+    } else if (n != 3 || range[2] <= 0.0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int Sim_Sweep(int argc, char **argv) {
+    Sim_ConfigTypeDef cfg;
+    Sim_DefaultConfig(&cfg);
+    cfg.seconds = 5.0;
+
+    double kp[3] = {PID_KP, PID_KP, 1.0};
+    double ki[3] = {PID_KI, PID_KI, 1.0};
+    double kd[3] = {PID_KD, PID_KD, 1.0};
+    for (int i = 0; i + 1 < argc; i += 2) {
+        int err = 0;
+        if (strcmp(argv[i], "--kp") == 0) {
+            err = Sweep_ParseRange(argv[i + 1], kp);
+        } else if (strcmp(argv[i], "--ki") == 0) {
+            err = Sweep_ParseRange(argv[i + 1], ki);
+        } else if (strcmp(argv[i], "--kd") == 0) {
+            err = Sweep_ParseRange(argv[i + 1], kd);
+        } else if (Sim_ParseOptions(&cfg, 2, argv + i) != 0) {
+            return 1;
+        }
+        if (err) {
+            fprintf(stderr, "范围格式应为 起:止:步长\n");
+            return 1;
+        }
+    }
+
+    Sim_PrintMetricsHeader();
+    fflush(stdout);
+    for (double p = kp[0]; p <= kp[1] + 1e-9; p += kp[2]) {
+        for (double i = ki[0]; i <= ki[1] + 1e-9; i += ki[2]) {
+            for (double d = kd[0]; d <= kd[1] + 1e-9; d += kd[2]) {
+                // 固件全局状态只能初始化一次，每个参数点在子进程中运行
+                pid_t pid = fork();
+                if (pid == 0) {
+                    cfg.kp = p;
+                    cfg.ki = i;
+                    cfg.kd = d;
+                    Sim_Execute(&cfg);
+                    Sim_PrintMetrics(&cfg);
+                    fflush(stdout);
+                    _exit(0);
+                }
+                if (pid < 0) {
+                    perror("fork");
+                    return 1;
+                }
+                waitpid(pid, NULL, 0);
+            }
+        }
+    }
+    return 0;
+}
+
+static int Sim_Profile(int argc, char **argv) {
+    long iterations = 1000000;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        }
+    }
+
+    static MPU6050_HandleTypeDef hmpu;
+    static Kalman_HandleTypeDef hkalman;
+    static Motor_HandleTypeDef hmotor;
+    static Control_HandleTypeDef hcontrol;
+    static Communication_HandleTypeDef hcomm;
+
+    SIM_Reset();
+    SIM_SetStepHook(Scripted_Sensor, SIM_SENSOR_PERIOD_US);
+    MX_I2C1_Init();
+    MX_TIM1_Init();
+    MX_TIM2_Init();
+    MX_TIM3_Init();
+    MX_USART1_UART_Init();
+    MPU6050_Init(&hmpu, &hi2c1);
+    Kalman_Init(&hkalman);
+    Motor_Init(&hmotor, &htim1);
+    Control_Init(&hcontrol, &hmotor);
+    Communication_Init(&hcomm, &huart1);
+
+    static const char *stage_names[] = {
+        "MPU6050_ReadData", "Kalman_UpdateDt", "Control_Step", "Communication_SendTelemetry"
+    };
+    double stage_ns[4] = {0};
+    char drain[256];
+    const float dt = 1.0f / CONTROL_RATE_HZ;
+    Telemetry_SampleTypeDef sample;
+    memset(&sample, 0, sizeof(sample));
+
+    for (long n = 0; n < iterations; n++) {
+        SIM_Advance(1000000 / CONTROL_RATE_HZ);
+
+        double t0 = Host_Seconds();
+        MPU6050_ReadData(&hmpu);
+        double t1 = Host_Seconds();
+        float angle = Kalman_UpdateDt(&hkalman, hmpu.angleX, hmpu.gyroX, dt);
+        double t2 = Host_Seconds();
+        Control_Step(&hcontrol, angle, dt);
+        double t3 = Host_Seconds();
+        sample.angle = angle;
+        sample.rate = Kalman_GetRate(&hkalman);
+        PID_GetTerms(&hcontrol.angle, &sample.p_term, &sample.i_term, &sample.d_term);
+        sample.output = hcontrol.balance_output;
+        Communication_SendTelemetry(&sample);
+        double t4 = Host_Seconds();
+
+        stage_ns[0] += (t1 - t0) * 1e9;
+        stage_ns[1] += (t2 - t1) * 1e9;
+        stage_ns[2] += (t3 - t2) * 1e9;
+        stage_ns[3] += (t4 - t3) * 1e9;
+
+        while (SIM_UART_Read(drain, sizeof(drain)) > 0) {
+        }
+    }
+
+    double total = 0.0;
+    printf("%-28s %12s\n", "阶段", "ns/次");
+    for (int i = 0; i < 4; i++) {
+        printf("%-28s %12.1f\n", stage_names[i], stage_ns[i] / iterations);
+        total += stage_ns[i];
+    }
+    printf("%-28s %12.1f\n", "合计", total / iterations);
+    printf("迭代次数: %ld, 覆盖虚拟时间: %.1f 小时\n", iterations,
+           iterations / (3600.0 * CONTROL_RATE_HZ));
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        return Sim_Run(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "sweep") == 0) {
+        return Sim_Sweep(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "profile") == 0) {
+        return Sim_Profile(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "用法: %s run|sweep|profile [选项]\n", argv[0]);
+    return 1;
+}
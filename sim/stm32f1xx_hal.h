@@ -0,0 +1,638 @@
+#ifndef STM32F1XX_HAL_H
+#define STM32F1XX_HAL_H
+
+/*
+ * 主机仿真用的HAL替身头文件
+ *
+ * 只声明固件源码实际用到的类型、宏和函数，行为由 hal_sim.c 实现：
+ * - 虚拟时钟（HAL_GetTick/HAL_Delay 推进仿真时间，不占用真实时间）
+ * - I2C总线后面挂一个可脚本化的MPU6050寄存器模型（阻塞读写和DMA读取）
+ * - TIM寄存器（CNT/ARR/CCRx）是普通内存，仿真侧可直接读取占空比
+ * - UART发送被捕获，接收可由仿真侧注入
+ * - ADC连续转换按采样时间把仿真侧给定的输入电压写入DMA循环缓冲区
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 状态码
+typedef enum {
+    HAL_OK       = 0x00U,
+    HAL_ERROR    = 0x01U,
+    HAL_BUSY     = 0x02U,
+    HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY      0xFFFFFFFFU
+
+#define __IO volatile
+
+// ---------------------------------------------------------------- 内核外设
+typedef enum {
+    SysTick_IRQn         = -1,
+    EXTI0_IRQn           = 6,
+    DMA1_Channel4_IRQn   = 14,
+    DMA1_Channel5_IRQn   = 15,
+    DMA1_Channel7_IRQn   = 17,
+    EXTI9_5_IRQn         = 23,
+    TIM2_IRQn     = 28,
+    TIM3_IRQn     = 29,
+    TIM4_IRQn     = 30,
+    I2C1_EV_IRQn  = 31,
+    I2C1_ER_IRQn  = 32,
+    USART1_IRQn   = 37
+} IRQn_Type;
+
+extern uint32_t SystemCoreClock;
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+// DWT周期计数器：仿真中按虚拟时间 × SystemCoreClock 计数
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+typedef struct {
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+
+extern DWT_Type SIM_DWT;
+extern CoreDebug_Type SIM_CoreDebug;
+#define DWT         (&SIM_DWT)
+#define CoreDebug   (&SIM_CoreDebug)
+
+// 分段耗时统计（profiler.h）的周期计数：仿真中DWT只随虚拟时间前进，测不到代码本身的耗时，
+// 改用主机单调时钟按SystemCoreClock折算。只用于在主机上比较优化前后，不等于Cortex-M3周期数
+uint32_t SIM_HostCycles(void);
+#define PROFILER_CYCLES()  SIM_HostCycles()
+
+// 仿真中 __WFI 推进虚拟时间到下一个中断事件；中断回调不会打断仿真侧代码，开关中断为空操作
+void SIM_WaitForInterrupt(void);
+#define __WFI()          SIM_WaitForInterrupt()
+#define __disable_irq()  do { } while (0)
+#define __enable_irq()   do { } while (0)
+
+// ---------------------------------------------------------------- 外设寄存器
+typedef struct {
+    __IO uint32_t CRL;
+    __IO uint32_t CRH;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t SR1;
+} I2C_TypeDef;
+
+typedef struct {
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t BRR;
+    __IO uint32_t CR1;
+} USART_TypeDef;
+
+typedef struct {
+    __IO uint32_t CCR;
+    __IO uint32_t CNDTR;
+    __IO uint32_t CPAR;
+    __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    __IO uint32_t SR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SQR3;
+    __IO uint32_t DR;
+} ADC_TypeDef;
+
+extern GPIO_TypeDef SIM_GPIOA, SIM_GPIOB, SIM_GPIOC;
+extern TIM_TypeDef SIM_TIM1, SIM_TIM2, SIM_TIM3, SIM_TIM4;
+extern I2C_TypeDef SIM_I2C1;
+extern USART_TypeDef SIM_USART1;
+extern DMA_Channel_TypeDef SIM_DMA1_Channel1, SIM_DMA1_Channel4, SIM_DMA1_Channel5, SIM_DMA1_Channel7;
+extern ADC_TypeDef SIM_ADC1;
+
+#define GPIOA   (&SIM_GPIOA)
+#define GPIOB   (&SIM_GPIOB)
+#define GPIOC   (&SIM_GPIOC)
+#define TIM1    (&SIM_TIM1)
+#define TIM2    (&SIM_TIM2)
+#define TIM3    (&SIM_TIM3)
+#define TIM4    (&SIM_TIM4)
+#define I2C1    (&SIM_I2C1)
+#define USART1  (&SIM_USART1)
+#define ADC1    (&SIM_ADC1)
+#define DMA1_Channel1 (&SIM_DMA1_Channel1)
+#define DMA1_Channel4 (&SIM_DMA1_Channel4)
+#define DMA1_Channel5 (&SIM_DMA1_Channel5)
+#define DMA1_Channel7 (&SIM_DMA1_Channel7)
+
+// ---------------------------------------------------------------- GPIO
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0    ((uint16_t)0x0001)
+#define GPIO_PIN_1    ((uint16_t)0x0002)
+#define GPIO_PIN_2    ((uint16_t)0x0004)
+#define GPIO_PIN_3    ((uint16_t)0x0008)
+#define GPIO_PIN_4    ((uint16_t)0x0010)
+#define GPIO_PIN_5    ((uint16_t)0x0020)
+#define GPIO_PIN_6    ((uint16_t)0x0040)
+#define GPIO_PIN_7    ((uint16_t)0x0080)
+#define GPIO_PIN_8    ((uint16_t)0x0100)
+#define GPIO_PIN_9    ((uint16_t)0x0200)
+#define GPIO_PIN_10   ((uint16_t)0x0400)
+#define GPIO_PIN_11   ((uint16_t)0x0800)
+#define GPIO_PIN_12   ((uint16_t)0x1000)
+#define GPIO_PIN_13   ((uint16_t)0x2000)
+#define GPIO_PIN_14   ((uint16_t)0x4000)
+#define GPIO_PIN_15   ((uint16_t)0x8000)
+
+#define GPIO_MODE_INPUT          0x00000000U
+#define GPIO_MODE_OUTPUT_PP      0x00000001U
+#define GPIO_MODE_OUTPUT_OD      0x00000011U
+#define GPIO_MODE_AF_PP          0x00000002U
+#define GPIO_MODE_AF_OD          0x00000012U
+#define GPIO_MODE_ANALOG         0x00000003U
+#define GPIO_MODE_IT_RISING      0x10110000U
+#define GPIO_MODE_IT_FALLING     0x10210000U
+
+#define GPIO_NOPULL              0x00000000U
+#define GPIO_PULLUP              0x00000001U
+#define GPIO_PULLDOWN            0x00000002U
+
+#define GPIO_SPEED_FREQ_LOW      0x00000002U
+#define GPIO_SPEED_FREQ_MEDIUM   0x00000001U
+#define GPIO_SPEED_FREQ_HIGH     0x00000003U
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+// ---------------------------------------------------------------- RCC
+typedef struct {
+    uint32_t PLLState;
+    uint32_t PLLSource;
+    uint32_t PLLMUL;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+    uint32_t OscillatorType;
+    uint32_t HSEState;
+    uint32_t HSEPredivValue;
+    uint32_t LSEState;
+    uint32_t HSIState;
+    uint32_t HSICalibrationValue;
+    uint32_t LSIState;
+    RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+    uint32_t ClockType;
+    uint32_t SYSCLKSource;
+    uint32_t AHBCLKDivider;
+    uint32_t APB1CLKDivider;
+    uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_HSE   0x00000001U
+#define RCC_HSE_ON               0x00010000U
+#define RCC_HSE_PREDIV_DIV1      0x00000000U
+#define RCC_PLL_ON               0x00000002U
+#define RCC_PLLSOURCE_HSE        0x00010000U
+#define RCC_PLL_MUL9             0x001C0000U
+#define RCC_CLOCKTYPE_SYSCLK     0x00000001U
+#define RCC_CLOCKTYPE_HCLK       0x00000002U
+#define RCC_CLOCKTYPE_PCLK1      0x00000004U
+#define RCC_CLOCKTYPE_PCLK2      0x00000008U
+#define RCC_SYSCLKSOURCE_PLLCLK  0x00000002U
+#define RCC_SYSCLK_DIV1          0x00000000U
+#define RCC_HCLK_DIV1            0x00000000U
+#define RCC_HCLK_DIV2            0x00000400U
+#define FLASH_LATENCY_2          0x00000002U
+
+// 外设时钟（ADC预分频）
+typedef struct {
+    uint32_t PeriphClockSelection;
+    uint32_t RTCClockSelection;
+    uint32_t AdcClockSelection;
+    uint32_t UsbClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_PERIPHCLK_ADC        0x00000002U
+#define RCC_ADCPCLK2_DIV6        0x00008000U
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit);
+
+// 时钟使能宏在仿真中无实际作用
+#define __HAL_RCC_GPIOA_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_AFIO_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_PWR_CLK_ENABLE()     do { } while (0)
+#define __HAL_RCC_I2C1_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_TIM1_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_TIM3_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_TIM4_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_USART1_CLK_ENABLE()  do { } while (0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_ADC1_CLK_ENABLE()    do { } while (0)
+
+// ---------------------------------------------------------------- DMA
+// 仿真中DMA只作为外设句柄的附属对象，传输由对应外设的仿真实现完成
+typedef struct {
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef *Instance;
+    DMA_InitTypeDef Init;
+    void *Parent;
+} DMA_HandleTypeDef;
+
+#define DMA_PERIPH_TO_MEMORY       0x00000000U
+#define DMA_MEMORY_TO_PERIPH       0x00000010U
+#define DMA_PINC_DISABLE           0x00000000U
+#define DMA_MINC_ENABLE            0x00000080U
+#define DMA_PDATAALIGN_BYTE        0x00000000U
+#define DMA_PDATAALIGN_HALFWORD    0x00000100U
+#define DMA_MDATAALIGN_BYTE        0x00000000U
+#define DMA_MDATAALIGN_HALFWORD    0x00000400U
+#define DMA_NORMAL                 0x00000000U
+#define DMA_CIRCULAR               0x00000020U
+#define DMA_PRIORITY_LOW           0x00000000U
+#define DMA_PRIORITY_MEDIUM        0x00001000U
+#define DMA_PRIORITY_HIGH          0x00002000U
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do { \
+        (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); \
+        (__DMA_HANDLE__).Parent = (__HANDLE__); \
+    } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+
+// ---------------------------------------------------------------- I2C
+typedef struct {
+    uint32_t ClockSpeed;
+    uint32_t DutyCycle;
+    uint32_t OwnAddress1;
+    uint32_t AddressingMode;
+    uint32_t DualAddressMode;
+    uint32_t OwnAddress2;
+    uint32_t GeneralCallMode;
+    uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct {
+    I2C_TypeDef *Instance;
+    I2C_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+} I2C_HandleTypeDef;
+
+#define I2C_DUTYCYCLE_2            0x00000000U
+#define I2C_ADDRESSINGMODE_7BIT    0x00004000U
+#define I2C_DUALADDRESS_DISABLE    0x00000000U
+#define I2C_GENERALCALL_DISABLE    0x00000000U
+#define I2C_NOSTRETCH_DISABLE      0x00000000U
+#define I2C_MEMADD_SIZE_8BIT       0x00000001U
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                          uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                         uint8_t *pData, uint16_t Size, uint32_t Timeout);
+// DMA读取在按总线时钟计算的传输时间后完成，完成时写入目标缓冲区并调用 HAL_I2C_MemRxCpltCallback
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+// 中断方式写入：数据立即写入传感器，传输时间后调用 HAL_I2C_MemTxCpltCallback
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+// ---------------------------------------------------------------- TIM
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef enum {
+    HAL_TIM_ACTIVE_CHANNEL_1       = 0x01U,
+    HAL_TIM_ACTIVE_CHANNEL_2       = 0x02U,
+    HAL_TIM_ACTIVE_CHANNEL_3       = 0x04U,
+    HAL_TIM_ACTIVE_CHANNEL_4       = 0x08U,
+    HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef struct {
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+    HAL_TIM_ActiveChannel Channel;
+} TIM_HandleTypeDef;
+
+typedef struct {
+    uint32_t ClockSource;
+    uint32_t ClockPolarity;
+    uint32_t ClockPrescaler;
+    uint32_t ClockFilter;
+} TIM_ClockConfigTypeDef;
+
+typedef struct {
+    uint32_t MasterOutputTrigger;
+    uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+typedef struct {
+    uint32_t OCMode;
+    uint32_t Pulse;
+    uint32_t OCPolarity;
+    uint32_t OCNPolarity;
+    uint32_t OCFastMode;
+    uint32_t OCIdleState;
+    uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct {
+    uint32_t OffStateRunMode;
+    uint32_t OffStateIDLEMode;
+    uint32_t LockLevel;
+    uint32_t DeadTime;
+    uint32_t BreakState;
+    uint32_t BreakPolarity;
+    uint32_t AutomaticOutput;
+} TIM_BreakDeadTimeConfigTypeDef;
+
+typedef struct {
+    uint32_t EncoderMode;
+    uint32_t IC1Polarity;
+    uint32_t IC1Selection;
+    uint32_t IC1Prescaler;
+    uint32_t IC1Filter;
+    uint32_t IC2Polarity;
+    uint32_t IC2Selection;
+    uint32_t IC2Prescaler;
+    uint32_t IC2Filter;
+} TIM_Encoder_InitTypeDef;
+
+#define TIM_CHANNEL_1                  0x00000000U
+#define TIM_CHANNEL_2                  0x00000004U
+#define TIM_CHANNEL_3                  0x00000008U
+#define TIM_CHANNEL_4                  0x0000000CU
+#define TIM_CHANNEL_ALL                0x0000003CU
+
+#define TIM_COUNTERMODE_UP             0x00000000U
+#define TIM_CLOCKDIVISION_DIV1         0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE  0x00000080U
+#define TIM_CLOCKSOURCE_INTERNAL       0x00001000U
+#define TIM_TRGO_RESET                 0x00000000U
+#define TIM_MASTERSLAVEMODE_DISABLE    0x00000000U
+#define TIM_OCMODE_TIMING              0x00000000U
+#define TIM_OCMODE_PWM1                0x00000060U
+#define TIM_OCPOLARITY_HIGH            0x00000000U
+#define TIM_OCNPOLARITY_HIGH           0x00000000U
+#define TIM_OCFAST_DISABLE             0x00000000U
+#define TIM_OCIDLESTATE_RESET          0x00000000U
+#define TIM_OCNIDLESTATE_RESET         0x00000000U
+#define TIM_OSSR_DISABLE               0x00000000U
+#define TIM_OSSI_DISABLE               0x00000000U
+#define TIM_LOCKLEVEL_OFF              0x00000000U
+#define TIM_BREAK_DISABLE              0x00000000U
+#define TIM_BREAKPOLARITY_HIGH         0x00002000U
+#define TIM_AUTOMATICOUTPUT_DISABLE    0x00000000U
+#define TIM_ENCODERMODE_TI12           0x00000003U
+#define TIM_ICPOLARITY_RISING          0x00000000U
+#define TIM_ICSELECTION_DIRECTTI       0x00000001U
+#define TIM_ICPSC_DIV1                 0x00000000U
+
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+    (*SIM_TIM_CCR((__HANDLE__)->Instance, (__CHANNEL__)) = (uint32_t)(__COMPARE__))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__) \
+    (*SIM_TIM_CCR((__HANDLE__)->Instance, (__CHANNEL__)))
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__) \
+    ((__HANDLE__)->Instance->CNT = (uint32_t)(__COUNTER__))
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)    ((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__) ((__HANDLE__)->Instance->ARR)
+
+__IO uint32_t *SIM_TIM_CCR(TIM_TypeDef *tim, uint32_t channel);
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim);
+void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+// 输出比较中断在计数值到达CCRx时触发 HAL_TIM_OC_DelayElapsedCallback
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig,
+                                           uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel);
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim);
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim);
+void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig,
+                                            uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim,
+                                            TIM_ClockConfigTypeDef *sClockSourceConfig);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        TIM_MasterConfigTypeDef *sMasterConfig);
+HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef *htim,
+                                                TIM_BreakDeadTimeConfigTypeDef *sBreakDeadTimeConfig);
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *sConfig);
+void HAL_TIM_Encoder_MspInit(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+
+// ---------------------------------------------------------------- ADC
+typedef enum {
+    DISABLE = 0,
+    ENABLE = !DISABLE
+} FunctionalState;
+
+typedef struct {
+    uint32_t DataAlign;
+    uint32_t ScanConvMode;
+    FunctionalState ContinuousConvMode;
+    uint32_t NbrOfConversion;
+    FunctionalState DiscontinuousConvMode;
+    uint32_t NbrOfDiscConversion;
+    uint32_t ExternalTrigConv;
+} ADC_InitTypeDef;
+
+typedef struct {
+    uint32_t Channel;
+    uint32_t Rank;
+    uint32_t SamplingTime;
+} ADC_ChannelConfTypeDef;
+
+typedef struct {
+    ADC_TypeDef *Instance;
+    ADC_InitTypeDef Init;
+    DMA_HandleTypeDef *DMA_Handle;
+    uint32_t State;
+    uint32_t ErrorCode;
+} ADC_HandleTypeDef;
+
+#define ADC_DATAALIGN_RIGHT          0x00000000U
+#define ADC_SCAN_DISABLE             0x00000000U
+#define ADC_SOFTWARE_START           0x000E0000U
+#define ADC_REGULAR_RANK_1           0x00000001U
+#define ADC_CHANNEL_0                0x00000000U
+#define ADC_CHANNEL_1                0x00000001U
+#define ADC_CHANNEL_2                0x00000002U
+#define ADC_CHANNEL_3                0x00000003U
+#define ADC_CHANNEL_4                0x00000004U
+#define ADC_CHANNEL_5                0x00000005U
+#define ADC_CHANNEL_6                0x00000006U
+#define ADC_CHANNEL_7                0x00000007U
+#define ADC_CHANNEL_8                0x00000008U
+#define ADC_CHANNEL_9                0x00000009U
+#define ADC_SAMPLETIME_1CYCLE_5      0x00000000U
+#define ADC_SAMPLETIME_55CYCLES_5    0x00000005U
+#define ADC_SAMPLETIME_239CYCLES_5   0x00000007U
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc);
+void HAL_ADC_MspInit(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc);
+// 连续转换 + 循环DMA：每次转换时间为（采样周期 + 12.5）个ADC时钟（12MHz），结果依次写入pData（按半字），
+// 到末尾后回到开头；输入电压由 SIM_ADC_SetInput 给出
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length);
+
+// ---------------------------------------------------------------- UART
+typedef struct {
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    uint8_t *pRxBuffPtr;
+    uint16_t RxXferSize;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    uint32_t RxState;
+    uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+#define HAL_UART_STATE_READY      0x00000020U
+#define HAL_UART_STATE_BUSY_RX    0x00000022U
+
+#define UART_WORDLENGTH_8B        0x00000000U
+#define UART_STOPBITS_1           0x00000000U
+#define UART_PARITY_NONE          0x00000000U
+#define UART_MODE_TX_RX           0x0000000CU
+#define UART_HWCONTROL_NONE       0x00000000U
+#define UART_OVERSAMPLING_16      0x00000000U
+#define UART_FLAG_ORE             0x00000008U
+#define HAL_UART_ERROR_DMA        0x00000010U
+
+#define __HAL_UART_CLEAR_FLAG(__HANDLE__, __FLAG__) \
+    ((__HANDLE__)->Instance->SR = ~(uint32_t)(__FLAG__))
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+void HAL_UART_MspInit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout);
+// DMA发送按波特率（每字节10位）计算传输时间，完成时输出数据并调用 HAL_UART_TxCpltCallback
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+// 循环DMA接收：SIM_UART_Inject写入接收缓冲区，在半满、全满和每次注入结束（空闲线）时
+// 调用 HAL_UARTEx_RxEventCallback，Size为DMA在缓冲区中的写入位置
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+// ---------------------------------------------------------------- FLASH
+// 片上闪存映射到主机进程中同一地址（0x08000000起64KB，首次运行固件时映射，擦除状态为0xFF），
+// 固件可以像在芯片上一样直接按地址读取；擦除和编程经HAL函数完成，并推进相应的虚拟时间
+#define FLASH_BASE                 0x08000000UL
+#define FLASH_PAGE_SIZE            0x400U
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t PageAddress;
+    uint32_t NbPages;
+} FLASH_EraseInitTypeDef;
+
+#define FLASH_TYPEERASE_PAGES      0x00U
+#define FLASH_BANK_1               0x01U
+#define FLASH_TYPEPROGRAM_HALFWORD 0x01U
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+
+// ---------------------------------------------------------------- 内核
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_MspInit(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
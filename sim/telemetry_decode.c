@@ -0,0 +1,151 @@
+/*
+ * 遥测流解码：读取串口原始字节（文件或标准输入），输出CSV
+ *
+ *   telemetry_decode [raw.bin] [--text] [--blackbox records.csv]
+ *
+ * 每个有效状态帧输出一行：
+ *   seq,t_us,angle,rate,p_term,i_term,d_term,output,duty_left,duty_right,encoder_left,encoder_right,voltage
+ * 帧数、校验失败次数和序号缺口（丢帧）统计输出到stderr；
+ * --text 同时把帧之间的文本（命令回应等）原样输出到stderr；
+ * --blackbox 把黑匣子记录帧（get blackbox 导出）按物理量写入另一个CSV：
+ *   index,t_us,dt_us,ax,ay,az,gx,gy,gz,angle,bias,p00,p11,p_term,i_term,d_term,duty_left,duty_right,enc_left,enc_right
+ *
+ * 原始字节可由 sim run --uart-log raw.bin 记录，或从真实串口转存
+ */
+#include "telemetry_stream.h"
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// 解码状态
+typedef struct {
+    int show_text;
+    int have_seq;
+    uint16_t last_seq;
+    uint32_t seq_gaps;          // 序号不连续次数
+    uint32_t lost_frames;       // 按序号推算的丢帧数
+    uint32_t other_frames;      // 其他类型帧
+    FILE *blackbox;             // 黑匣子记录输出（NULL时不输出）
+    uint32_t blackbox_records;
+} Decode_StateTypeDef;
+
+static void Decode_Record(Decode_StateTypeDef *state, const uint8_t *frame, uint16_t len) {
+    Telemetry_RecordTypeDef r;
+    uint16_t index;
+    uint32_t t_us;
+
+    if (!Telemetry_DecodeRecord(frame, len, &r, &index, &t_us)) {
+        state->other_frames++;
+        return;
+    }
+    state->blackbox_records++;
+    if (state->blackbox == NULL) {
+        return;
+    }
+    fprintf(state->blackbox, "%u,%lu,%u,%d,%d,%d,%d,%d,%d,%.2f,%.3f,%.5f,%.5f,%.1f,%.1f,%.1f,%d,%d,%d,%d\n",
+            index, (unsigned long)t_us, r.dt_us, r.accel[0], r.accel[1], r.accel[2], r.gyro[0], r.gyro[1], r.gyro[2],
+            r.angle / TELEMETRY_ANGLE_SCALE, r.bias / TELEMETRY_BIAS_SCALE,
+            r.p00 / TELEMETRY_COV_SCALE, r.p11 / TELEMETRY_COV_SCALE,
+            r.p_term / TELEMETRY_PID_SCALE, r.i_term / TELEMETRY_PID_SCALE, r.d_term / TELEMETRY_PID_SCALE,
+            r.duty_left, r.duty_right, r.encoder_left, r.encoder_right);
+}
+
+static void Decode_Frame(const uint8_t *frame, uint16_t len, void *ctx) {
+    Decode_StateTypeDef *state = ctx;
+    Telemetry_SampleTypeDef s;
+    uint16_t seq;
+
+    Telemetry_BlackboxInfoTypeDef info;
+    if (Telemetry_DecodeBlackboxInfo(frame, len, &info)) {
+        fprintf(stderr, "黑匣子导出: %u 条记录, 控制频率 %u Hz, 陀螺仪零偏 %.3f/%.3f/%.3f °/s\n", info.records,
+                info.rate_hz, info.gyro_offset[0], info.gyro_offset[1], info.gyro_offset[2]);
+        return;
+    }
+    if (frame[2] == TELEMETRY_TYPE_BLACKBOX) {
+        Decode_Record(state, frame, len);
+        return;
+    }
+    if (!Telemetry_DecodeState(frame, len, &s, &seq)) {
+        state->other_frames++;
+        return;
+    }
+    if (state->have_seq && seq != (uint16_t)(state->last_seq + 1)) {
+        state->seq_gaps++;
+        state->lost_frames += (uint16_t)(seq - state->last_seq - 1);
+    }
+    state->have_seq = 1;
+    state->last_seq = seq;
+
+    printf("%u,%lu,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%d,%u,%u,%.3f\n", seq, (unsigned long)s.timestamp_us,
+           s.angle, s.rate, s.p_term, s.i_term, s.d_term, s.output,
+           s.duty_left, s.duty_right, s.encoder_left, s.encoder_right, s.voltage);
+}
+
+static void Decode_Text(uint8_t byte, void *ctx) {
+    Decode_StateTypeDef *state = ctx;
+    if (state->show_text) {
+        fputc(byte, stderr);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    const char *blackbox_path = NULL;
+    Decode_StateTypeDef state;
+    memset(&state, 0, sizeof(state));
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            state.show_text = 1;
+        } else if (strcmp(argv[i], "--blackbox") == 0 && i + 1 < argc) {
+            blackbox_path = argv[++i];
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "用法: %s [raw.bin] [--text] [--blackbox records.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FILE *input = stdin;
+    if (path != NULL) {
+        input = fopen(path, "rb");
+        if (input == NULL) {
+            perror(path);
+            return 1;
+        }
+    }
+
+    if (blackbox_path != NULL) {
+        state.blackbox = fopen(blackbox_path, "w");
+        if (state.blackbox == NULL) {
+            perror(blackbox_path);
+            return 1;
+        }
+        fprintf(state.blackbox, "index,t_us,dt_us,ax,ay,az,gx,gy,gz,angle,bias,p00,p11,"
+                "p_term,i_term,d_term,duty_left,duty_right,enc_left,enc_right\n");
+    }
+
+    TelemetryStream_HandleTypeDef stream;
+    TelemetryStream_Init(&stream, Decode_Frame, Decode_Text, &state);
+
+    printf("seq,t_us,angle,rate,p_term,i_term,d_term,output,duty_left,duty_right,encoder_left,encoder_right,voltage\n");
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), input)) > 0) {
+        TelemetryStream_Feed(&stream, buffer, n);
+    }
+    if (input != stdin) {
+        fclose(input);
+    }
+
+    if (state.blackbox != NULL) {
+        fclose(state.blackbox);
+    }
+
+    fprintf(stderr, "帧: %u, 校验失败: %u, 序号缺口: %u（丢帧 %u）, 黑匣子记录: %u, 其他类型帧: %u\n",
+            stream.frames, stream.crc_errors, state.seq_gaps, state.lost_frames,
+            state.blackbox_records, state.other_frames);
+    return 0;
+}
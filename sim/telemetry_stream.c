@@ -0,0 +1,74 @@
+#include "telemetry_stream.h"
+#include <string.h>
+
+void TelemetryStream_Init(TelemetryStream_HandleTypeDef *stream, TelemetryStream_FrameCallback on_frame,
+                          TelemetryStream_TextCallback on_text, void *ctx) {
+    memset(stream, 0, sizeof(*stream));
+    stream->on_frame = on_frame;
+    stream->on_text = on_text;
+    stream->ctx = ctx;
+}
+
+static void TelemetryStream_Text(TelemetryStream_HandleTypeDef *stream, uint8_t byte) {
+    if (stream->on_text != NULL) {
+        stream->on_text(byte, stream->ctx);
+    }
+}
+
+// 缓存的第一个字节不是帧头：按文本输出，其余字节重新输入
+static void TelemetryStream_Reject(TelemetryStream_HandleTypeDef *stream) {
+    uint8_t rest[TELEMETRY_MAX_FRAME];
+    uint16_t count = stream->length - 1;
+
+    TelemetryStream_Text(stream, stream->buffer[0]);
+    memcpy(rest, &stream->buffer[1], count);
+    stream->length = 0;
+    TelemetryStream_Feed(stream, rest, count);
+}
+
+static void TelemetryStream_Byte(TelemetryStream_HandleTypeDef *stream, uint8_t byte) {
+    stream->buffer[stream->length++] = byte;
+
+    if (stream->length == 1) {
+        if (byte != TELEMETRY_SYNC0) {
+            stream->length = 0;
+            TelemetryStream_Text(stream, byte);
+        }
+        return;
+    }
+    if (stream->length == 2) {
+        if (byte != TELEMETRY_SYNC1) {
+            TelemetryStream_Reject(stream);
+        }
+        return;
+    }
+    if (stream->length < 4) {
+        return;
+    }
+
+    uint16_t frame_len = Telemetry_FrameLength(stream->buffer);
+    if (frame_len == 0) {
+        TelemetryStream_Reject(stream);
+        return;
+    }
+    if (stream->length < frame_len) {
+        return;
+    }
+
+    if (Telemetry_CheckFrame(stream->buffer, frame_len)) {
+        stream->frames++;
+        stream->length = 0;
+        if (stream->on_frame != NULL) {
+            stream->on_frame(stream->buffer, frame_len, stream->ctx);
+        }
+    } else {
+        stream->crc_errors++;
+        TelemetryStream_Reject(stream);
+    }
+}
+
+void TelemetryStream_Feed(TelemetryStream_HandleTypeDef *stream, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        TelemetryStream_Byte(stream, data[i]);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include "telemetry.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// 串口字节流拆分：遥测帧（同步字 + CRC校验通过）与其余文本
+//
+// 字节可以任意分段输入；同步字后的数据CRC校验失败时，第一个字节按文本输出，
+// 其后的字节重新搜索同步字，因此文本中偶然出现的 0xA5 0x5A 不会吞掉后续数据。
+
+typedef void (*TelemetryStream_FrameCallback)(const uint8_t *frame, uint16_t len, void *ctx);
+typedef void (*TelemetryStream_TextCallback)(uint8_t byte, void *ctx);
+
+typedef struct {
+    TelemetryStream_FrameCallback on_frame;
+    TelemetryStream_TextCallback on_text;
+    void *ctx;
+
+    uint8_t buffer[TELEMETRY_MAX_FRAME];
+    uint16_t length;
+
+    uint32_t frames;            // 有效帧数
+    uint32_t crc_errors;        // 校验失败次数
+} TelemetryStream_HandleTypeDef;
+
+void TelemetryStream_Init(TelemetryStream_HandleTypeDef *stream, TelemetryStream_FrameCallback on_frame,
+                          TelemetryStream_TextCallback on_text, void *ctx);
+void TelemetryStream_Feed(TelemetryStream_HandleTypeDef *stream, const uint8_t *data, size_t size);
+
+#endif
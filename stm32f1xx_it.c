@@ -0,0 +1,57 @@
+#include "main.h"
+#include "stm32f1xx_hal.h"
+
+#include "pins.h"
+
+// 外设句柄定义
+extern I2C_HandleTypeDef hi2c1;
+extern TIM_HandleTypeDef htim4;
+extern UART_HandleTypeDef huart1;
+extern DMA_HandleTypeDef hdma_i2c1_rx;
+extern DMA_HandleTypeDef hdma_usart1_tx;
+extern DMA_HandleTypeDef hdma_usart1_rx;
+
+// 系统滴答定时器中断（HAL_GetTick时基）
+void SysTick_Handler(void) {
+    HAL_IncTick();
+}
+
+// TIM4全局中断（控制循环）
+void TIM4_IRQHandler(void) {
+    HAL_TIM_IRQHandler(&htim4);
+}
+
+// USART1全局中断
+void USART1_IRQHandler(void) {
+    HAL_UART_IRQHandler(&huart1);
+}
+
+// MPU6050数据就绪（PB5）
+void EXTI9_5_IRQHandler(void) {
+    HAL_GPIO_EXTI_IRQHandler(MPU6050_INT_PIN);
+}
+
+// DMA1通道7：I2C1接收完成
+void DMA1_Channel7_IRQHandler(void) {
+    HAL_DMA_IRQHandler(&hdma_i2c1_rx);
+}
+
+// I2C1事件中断
+void I2C1_EV_IRQHandler(void) {
+    HAL_I2C_EV_IRQHandler(&hi2c1);
+}
+
+// I2C1错误中断
+void I2C1_ER_IRQHandler(void) {
+    HAL_I2C_ER_IRQHandler(&hi2c1);
+}
+
+// DMA1通道4：USART1发送完成
+void DMA1_Channel4_IRQHandler(void) {
+    HAL_DMA_IRQHandler(&hdma_usart1_tx);
+}
+
+// DMA1通道5：USART1接收半满/全满
+void DMA1_Channel5_IRQHandler(void) {
+    HAL_DMA_IRQHandler(&hdma_usart1_rx);
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "strconv.h"
+
+#define STRCONV_MAX_DIGITS  9       // 尾数保留的有效数字位数（不超过uint32）
+#define STRCONV_MAX_EXP     99      // 指数部分饱和值（已远超float范围）
+
+// 10的0~10次幂，在float中都是精确值
+static const float strconv_pow10[11] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// 解析十进制浮点数，成功返回1
+uint8_t StrConv_ParseFloat(const char *str, float *value) {
+    const char *p = str;
+    uint32_t mantissa = 0;
+    int16_t digits = 0;         // 已计入尾数的有效数字
+    int16_t exp10 = 0;          // 尾数 × 10^exp10
+    uint8_t seen_digit = 0;
+    uint8_t negative = 0;
+    
+    if (*p == '+' || *p == '-') {
+        negative = (*p == '-');
+        p++;
+    }
+    
+    // 整数部分：超出有效位数的数字只计入指数
+    for (; *p >= '0' && *p <= '9'; p++) {
+        seen_digit = 1;
+        if (digits < STRCONV_MAX_DIGITS) {
+            mantissa = mantissa * 10U + (uint32_t)(*p - '0');
+            digits += (mantissa != 0);
+        } else {
+            exp10++;
+        }
+    }
+    
+    // 小数部分：超出有效位数的数字直接舍去
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            seen_digit = 1;
+            if (digits < STRCONV_MAX_DIGITS) {
+                mantissa = mantissa * 10U + (uint32_t)(*p - '0');
+                digits += (mantissa != 0);
+                exp10--;
+            }
+        }
+    }
+    if (!seen_digit) {
+        return 0;
+    }
+    
+    // 指数部分
+    if (*p == 'e' || *p == 'E') {
+        int16_t exponent = 0;
+        uint8_t exp_negative = 0;
+        p++;
+        if (*p == '+' || *p == '-') {
+            exp_negative = (*p == '-');
+            p++;
+        }
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        for (; *p >= '0' && *p <= '9'; p++) {
+            if (exponent < STRCONV_MAX_EXP) {
+                exponent = (int16_t)(exponent * 10 + (*p - '0'));
+            }
+        }
+        exp10 = (int16_t)(exp10 + (exp_negative ? -exponent : exponent));
+    }
+    if (*p != '\0') {
+        return 0;
+    }
+    
+    // 尾数为0时不必缩放（避免0乘上溢出的10次幂）
+    float result = (float)mantissa;
+    if (mantissa != 0) {
+        while (exp10 >= 10) {
+            result *= strconv_pow10[10];
+            exp10 -= 10;
+        }
+        while (exp10 <= -10) {
+            result /= strconv_pow10[10];
+            exp10 += 10;
+        }
+        result = (exp10 >= 0) ? result * strconv_pow10[exp10] : result / strconv_pow10[-exp10];
+        if (result > 3.40282347e38f) {
+            return 0;   // 上溢为无穷大
+        }
+    }
+    *value = negative ? -result : result;
+    return 1;
+}
+
+// 解析十进制整数，成功返回1
+uint8_t StrConv_ParseInt(const char *str, int32_t *value) {
+    const char *p = str;
+    uint32_t magnitude = 0;
+    uint32_t limit = 2147483647U;
+    uint8_t negative = 0;
+    
+    if (*p == '+' || *p == '-') {
+        negative = (*p == '-');
+        limit += negative;
+        p++;
+    }
+    if (*p == '\0') {
+        return 0;
+    }
+    for (; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        uint32_t digit = (uint32_t)(*p - '0');
+        if (magnitude > (limit - digit) / 10U) {
+            return 0;
+        }
+        magnitude = magnitude * 10U + digit;
+    }
+    *value = negative ? (int32_t)(0U - magnitude) : (int32_t)magnitude;
+    return 1;
+}
+
+// 10的0~9次幂（整数，定点小数缩放用）
+static const uint32_t strconv_scale[10] = {
+    1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U
+};
+
+// 初始化格式化缓冲区（size至少为1）
+void StrConv_Init(StrConv_BufferTypeDef *buf, char *data, uint16_t size) {
+    buf->data = data;
+    buf->size = size;
+    buf->length = 0;
+    data[0] = '\0';
+}
+
+// 追加一个字符，缓冲区满时丢弃
+static void StrConv_AppendChar(StrConv_BufferTypeDef *buf, char c) {
+    if (buf->length + 1U < buf->size) {
+        buf->data[buf->length++] = c;
+        buf->data[buf->length] = '\0';
+    }
+}
+
+// 追加字符串
+void StrConv_AppendString(StrConv_BufferTypeDef *buf, const char *str) {
+    while (*str != '\0' && buf->length + 1U < buf->size) {
+        buf->data[buf->length++] = *str++;
+    }
+    buf->data[buf->length] = '\0';
+}
+
+// 追加字符串，不足width个字符时在右侧补空格（左对齐，相当于%-*s）
+void StrConv_AppendPadded(StrConv_BufferTypeDef *buf, const char *str, uint8_t width) {
+    uint16_t start = buf->length;
+    StrConv_AppendString(buf, str);
+    while (buf->length - start < width && buf->length + 1U < buf->size) {
+        StrConv_AppendChar(buf, ' ');
+    }
+}
+
+// 追加无符号十进制数，不足width位时在左侧补空格（右对齐，相当于%*lu）
+void StrConv_AppendUint(StrConv_BufferTypeDef *buf, uint32_t value, uint8_t width) {
+    char digits[10];
+    uint8_t count = 0;
+    
+    do {
+        digits[count++] = (char)('0' + value % 10U);
+        value /= 10U;
+    } while (value != 0);
+    
+    for (; width > count; width--) {
+        StrConv_AppendChar(buf, ' ');
+    }
+    while (count > 0) {
+        StrConv_AppendChar(buf, digits[--count]);
+    }
+}
+
+// 追加有符号十进制数
+void StrConv_AppendInt(StrConv_BufferTypeDef *buf, int32_t value) {
+    if (value < 0) {
+        StrConv_AppendChar(buf, '-');
+        StrConv_AppendUint(buf, 0U - (uint32_t)value, 0);
+    } else {
+        StrConv_AppendUint(buf, (uint32_t)value, 0);
+    }
+}
+
+// 追加定点小数（四舍五入到decimals位，相当于%.*f），返回小数部分的起始位置
+static uint16_t StrConv_AppendFixed(StrConv_BufferTypeDef *buf, float value, uint8_t decimals) {
+    if (value != value) {
+        StrConv_AppendString(buf, "nan");
+        return buf->length;
+    }
+    if (value < 0.0f) {
+        StrConv_AppendChar(buf, '-');
+        value = -value;
+    }
+    if (value >= 4294967296.0f) {
+        StrConv_AppendString(buf, "inf");
+        return buf->length;
+    }
+    if (decimals > STRCONV_MAX_DECIMALS) {
+        decimals = STRCONV_MAX_DECIMALS;
+    }
+    
+    // 整数部分截断后相减是精确的，小数部分放大后舍入，进位时整数部分加一
+    uint32_t scale = strconv_scale[decimals];
+    uint32_t integer = (uint32_t)value;
+    uint32_t fraction = (uint32_t)((value - (float)integer) * (float)scale + 0.5f);
+    if (fraction >= scale) {
+        fraction -= scale;
+        integer++;
+    }
+    
+    StrConv_AppendUint(buf, integer, 0);
+    uint16_t point = buf->length;
+    if (decimals > 0) {
+        StrConv_AppendChar(buf, '.');
+        for (uint8_t i = decimals; i > 0; i--) {
+            StrConv_AppendChar(buf, (char)('0' + (fraction / strconv_scale[i - 1]) % 10U));
+        }
+    }
+    return point;
+}
+
+// 追加定点小数，decimals位小数（最多STRCONV_MAX_DECIMALS位）
+void StrConv_AppendFloat(StrConv_BufferTypeDef *buf, float value, uint8_t decimals) {
+    StrConv_AppendFixed(buf, value, decimals);
+}
+
+// 追加最短的定点小数：STRCONV_MAX_DECIMALS位小数去掉末尾的0（代替%g，参数回报用）
+void StrConv_AppendFloatCompact(StrConv_BufferTypeDef *buf, float value) {
+    uint16_t point = StrConv_AppendFixed(buf, value, STRCONV_MAX_DECIMALS);
+    
+    // 写满时末尾可能不完整，不再修剪
+    if (point >= buf->length || buf->data[point] != '.' || buf->length + 1U >= buf->size) {
+        return;
+    }
+    while (buf->data[buf->length - 1] == '0') {
+        buf->length--;
+    }
+    if (buf->data[buf->length - 1] == '.') {
+        buf->length--;
+    }
+    buf->data[buf->length] = '\0';
+}
+
+// 追加count个定点小数，以'/'分隔（三轴数据回报用）
+void StrConv_AppendVector(StrConv_BufferTypeDef *buf, const float *values, uint8_t count, uint8_t decimals) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (i > 0) {
+            StrConv_AppendChar(buf, '/');
+        }
+        StrConv_AppendFixed(buf, values[i], decimals);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef STRCONV_H
+#define STRCONV_H
+
+#include <stdint.h>
+
+// 字符串与数值互转：不经过scanf/printf，不引入newlib的浮点格式化代码
+//
+// 解析：整个字符串必须是一个数，前后不能有其他字符（空白由调用者去掉）。
+//   浮点：[+-] 数字 [. 数字] [e|E [+-] 数字]，小数点前后至少一侧有数字；不接受inf/nan和十六进制，
+//         结果超出float范围时失败。只保留前9位有效数字，与strtof相差不超过几个ulp
+//   整数：[+-] 十进制数字，超出int32范围时失败
+//
+// 格式化：向StrConv_BufferTypeDef追加文本，写满后多余的部分丢弃，结果总以'\0'结尾。
+//   浮点按定点小数输出（整数部分与小数部分各用一个uint32），绝对值不小于2^32时输出inf
+
+#define STRCONV_MAX_DECIMALS    6   // 浮点最多输出的小数位数
+
+// 格式化缓冲区
+typedef struct {
+    char *data;
+    uint16_t size;          // data的字节数（含结束符）
+    uint16_t length;        // 已写入的字符数
+} StrConv_BufferTypeDef;
+
+// 函数声明
+uint8_t StrConv_ParseFloat(const char *str, float *value);
+uint8_t StrConv_ParseInt(const char *str, int32_t *value);
+void StrConv_Init(StrConv_BufferTypeDef *buf, char *data, uint16_t size);
+void StrConv_AppendString(StrConv_BufferTypeDef *buf, const char *str);
+void StrConv_AppendPadded(StrConv_BufferTypeDef *buf, const char *str, uint8_t width);
+void StrConv_AppendUint(StrConv_BufferTypeDef *buf, uint32_t value, uint8_t width);
+void StrConv_AppendInt(StrConv_BufferTypeDef *buf, int32_t value);
+void StrConv_AppendFloat(StrConv_BufferTypeDef *buf, float value, uint8_t decimals);
+void StrConv_AppendFloatCompact(StrConv_BufferTypeDef *buf, float value);
+void StrConv_AppendVector(StrConv_BufferTypeDef *buf, const float *values, uint8_t count, uint8_t decimals);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "telemetry.h"
+#include "crc16.h"
+
+// 小端写入
+static void Telemetry_Put16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void Telemetry_Put32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint16_t Telemetry_Get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t Telemetry_Get32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 物理量按系数缩放为int16（四舍五入并饱和）
+int16_t Telemetry_Scale(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled >= 32767.0f) {
+        return 32767;
+    }
+    if (scaled <= -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+// 填写帧头和CRC，返回整帧长度
+static uint16_t Telemetry_Finish(uint8_t *frame, uint8_t type, uint8_t payload_len, uint16_t seq, uint32_t timestamp_us) {
+    frame[0] = TELEMETRY_SYNC0;
+    frame[1] = TELEMETRY_SYNC1;
+    frame[2] = type;
+    frame[3] = payload_len;
+    Telemetry_Put16(&frame[4], seq);
+    Telemetry_Put32(&frame[6], timestamp_us);
+
+    uint16_t crc_offset = TELEMETRY_HEADER_SIZE + payload_len;
+    Telemetry_Put16(&frame[crc_offset], CRC16_Compute(&frame[2], crc_offset - 2));
+    return crc_offset + TELEMETRY_CRC_SIZE;
+}
+
+// 编码状态帧，frame至少 TELEMETRY_STATE_FRAME 字节，返回帧长度
+uint16_t Telemetry_EncodeState(const Telemetry_SampleTypeDef *sample, uint16_t seq, uint8_t *frame) {
+    uint8_t *p = &frame[TELEMETRY_HEADER_SIZE];
+
+    Telemetry_Put16(&p[0], (uint16_t)Telemetry_Scale(sample->angle, TELEMETRY_ANGLE_SCALE));
+    Telemetry_Put16(&p[2], (uint16_t)Telemetry_Scale(sample->rate, TELEMETRY_RATE_SCALE));
+    Telemetry_Put16(&p[4], (uint16_t)Telemetry_Scale(sample->p_term, TELEMETRY_PID_SCALE));
+    Telemetry_Put16(&p[6], (uint16_t)Telemetry_Scale(sample->i_term, TELEMETRY_PID_SCALE));
+    Telemetry_Put16(&p[8], (uint16_t)Telemetry_Scale(sample->d_term, TELEMETRY_PID_SCALE));
+    Telemetry_Put16(&p[10], (uint16_t)Telemetry_Scale(sample->output, TELEMETRY_PID_SCALE));
+    Telemetry_Put16(&p[12], (uint16_t)sample->duty_left);
+    Telemetry_Put16(&p[14], (uint16_t)sample->duty_right);
+    Telemetry_Put16(&p[16], sample->encoder_left);
+    Telemetry_Put16(&p[18], sample->encoder_right);
+    Telemetry_Put16(&p[20], (uint16_t)Telemetry_Scale(sample->voltage, TELEMETRY_VOLTAGE_SCALE));
+
+    return Telemetry_Finish(frame, TELEMETRY_TYPE_STATE, TELEMETRY_STATE_PAYLOAD, seq, sample->timestamp_us);
+}
+
+// 由帧头（至少4字节）得到整帧长度，负载长度非法时返回0
+uint16_t Telemetry_FrameLength(const uint8_t *frame) {
+    if (frame[3] > TELEMETRY_MAX_PAYLOAD) {
+        return 0;
+    }
+    return TELEMETRY_HEADER_SIZE + frame[3] + TELEMETRY_CRC_SIZE;
+}
+
+// 检查同步字、长度和CRC，完整有效返回1
+uint8_t Telemetry_CheckFrame(const uint8_t *frame, uint16_t len) {
+    if (len < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE ||
+        frame[0] != TELEMETRY_SYNC0 || frame[1] != TELEMETRY_SYNC1 ||
+        Telemetry_FrameLength(frame) != len) {
+        return 0;
+    }
+    uint16_t crc_offset = len - TELEMETRY_CRC_SIZE;
+    return CRC16_Compute(&frame[2], crc_offset - 2) == Telemetry_Get16(&frame[crc_offset]);
+}
+
+// 解码状态帧（需先通过Telemetry_CheckFrame），类型不符返回0
+uint8_t Telemetry_DecodeState(const uint8_t *frame, uint16_t len, Telemetry_SampleTypeDef *sample, uint16_t *seq) {
+    if (len != TELEMETRY_STATE_FRAME || frame[2] != TELEMETRY_TYPE_STATE) {
+        return 0;
+    }
+    const uint8_t *p = &frame[TELEMETRY_HEADER_SIZE];
+
+    *seq = Telemetry_Get16(&frame[4]);
+    sample->timestamp_us = Telemetry_Get32(&frame[6]);
+    sample->angle = (int16_t)Telemetry_Get16(&p[0]) / TELEMETRY_ANGLE_SCALE;
+    sample->rate = (int16_t)Telemetry_Get16(&p[2]) / TELEMETRY_RATE_SCALE;
+    sample->p_term = (int16_t)Telemetry_Get16(&p[4]) / TELEMETRY_PID_SCALE;
+    sample->i_term = (int16_t)Telemetry_Get16(&p[6]) / TELEMETRY_PID_SCALE;
+    sample->d_term = (int16_t)Telemetry_Get16(&p[8]) / TELEMETRY_PID_SCALE;
+    sample->output = (int16_t)Telemetry_Get16(&p[10]) / TELEMETRY_PID_SCALE;
+    sample->duty_left = (int16_t)Telemetry_Get16(&p[12]);
+    sample->duty_right = (int16_t)Telemetry_Get16(&p[14]);
+    sample->encoder_left = Telemetry_Get16(&p[16]);
+    sample->encoder_right = Telemetry_Get16(&p[18]);
+    sample->voltage = (int16_t)Telemetry_Get16(&p[20]) / TELEMETRY_VOLTAGE_SCALE;
+    return 1;
+}
+
+// 黑匣子记录的16位字段依次排列（与 Telemetry_RecordTypeDef 的声明顺序一致）
+#define TELEMETRY_RECORD_FIELDS (TELEMETRY_BLACKBOX_PAYLOAD / 2)
+
+// 记录结构体不能有填充，否则负载长度与RAM占用都会变化（编译期检查）
+typedef char Telemetry_RecordSizeCheck[(sizeof(Telemetry_RecordTypeDef) == TELEMETRY_BLACKBOX_PAYLOAD) ? 1 : -1];
+
+// 编码黑匣子记录帧，frame至少 TELEMETRY_BLACKBOX_FRAME 字节，返回帧长度
+uint16_t Telemetry_EncodeRecord(const Telemetry_RecordTypeDef *record, uint16_t seq, uint32_t timestamp_us, uint8_t *frame) {
+    const uint16_t *fields = (const uint16_t *)record;
+    uint8_t *p = &frame[TELEMETRY_HEADER_SIZE];
+
+    for (uint8_t i = 0; i < TELEMETRY_RECORD_FIELDS; i++) {
+        Telemetry_Put16(&p[2 * i], fields[i]);
+    }
+    return Telemetry_Finish(frame, TELEMETRY_TYPE_BLACKBOX, TELEMETRY_BLACKBOX_PAYLOAD, seq, timestamp_us);
+}
+
+// 解码黑匣子记录帧（需先通过Telemetry_CheckFrame），类型不符返回0
+uint8_t Telemetry_DecodeRecord(const uint8_t *frame, uint16_t len, Telemetry_RecordTypeDef *record,
+                               uint16_t *seq, uint32_t *timestamp_us) {
+    if (len != TELEMETRY_BLACKBOX_FRAME || frame[2] != TELEMETRY_TYPE_BLACKBOX) {
+        return 0;
+    }
+    uint16_t *fields = (uint16_t *)record;
+    const uint8_t *p = &frame[TELEMETRY_HEADER_SIZE];
+
+    *seq = Telemetry_Get16(&frame[4]);
+    *timestamp_us = Telemetry_Get32(&frame[6]);
+    for (uint8_t i = 0; i < TELEMETRY_RECORD_FIELDS; i++) {
+        fields[i] = Telemetry_Get16(&p[2 * i]);
+    }
+    return 1;
+}
+
+// 编码黑匣子导出头帧，frame至少 TELEMETRY_INFO_FRAME 字节，返回帧长度
+uint16_t Telemetry_EncodeBlackboxInfo(const Telemetry_BlackboxInfoTypeDef *info, uint8_t *frame) {
+    uint8_t *p = &frame[TELEMETRY_HEADER_SIZE];
+
+    Telemetry_Put16(&p[0], info->records);
+    Telemetry_Put16(&p[2], info->rate_hz);
+    for (uint8_t i = 0; i < 3; i++) {
+        Telemetry_Put16(&p[4 + 2 * i], (uint16_t)Telemetry_Scale(info->gyro_offset[i], TELEMETRY_BIAS_SCALE));
+    }
+    p[10] = info->filter;
+    return Telemetry_Finish(frame, TELEMETRY_TYPE_BLACKBOX_INFO, TELEMETRY_INFO_PAYLOAD, 0, info->timestamp_us);
+}
+
+// 解码黑匣子导出头帧（需先通过Telemetry_CheckFrame），类型不符返回0
+uint8_t Telemetry_DecodeBlackboxInfo(const uint8_t *frame, uint16_t len, Telemetry_BlackboxInfoTypeDef *info) {
+    if (len != TELEMETRY_INFO_FRAME || frame[2] != TELEMETRY_TYPE_BLACKBOX_INFO) {
+        return 0;
+    }
+    const uint8_t *p = &frame[TELEMETRY_HEADER_SIZE];
+
+    info->timestamp_us = Telemetry_Get32(&frame[6]);
+    info->records = Telemetry_Get16(&p[0]);
+    info->rate_hz = Telemetry_Get16(&p[2]);
+    for (uint8_t i = 0; i < 3; i++) {
+        info->gyro_offset[i] = (int16_t)Telemetry_Get16(&p[4 + 2 * i]) / TELEMETRY_BIAS_SCALE;
+    }
+    info->filter = p[10];
+    return 1;
+}
@@ -0,0 +1,108 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// 二进制遥测帧（小端）
+//
+//   偏移  长度  内容
+//   0     2     同步字 0xA5 0x5A
+//   2     1     帧类型
+//   3     1     负载长度 N
+//   4     2     序号（每帧加1，用于发现丢帧）
+//   6     4     时间戳（微秒，Timebase_GetMicros）
+//   10    N     负载
+//   10+N  2     CRC16（CRC-16/CCITT-FALSE，覆盖类型到负载末尾）
+//
+// 状态帧负载（TELEMETRY_TYPE_STATE，22字节）：
+//   角度 int16（0.01°）、角速度 int16（0.1°/s）、P/I/D项与PID输出 int16×4（0.1）、
+//   左右电机占空比 int16×2（PWM计数）、左右编码器计数 uint16×2、电池电压 int16（mV）
+//
+// 黑匣子记录帧负载（TELEMETRY_TYPE_BLACKBOX，36字节，即 Telemetry_RecordTypeDef 各字段依次小端写出）：
+//   序号为记录在导出序列中的位置（0为最早），时间戳为该记录的采样时刻
+//
+// 黑匣子导出头帧（TELEMETRY_TYPE_BLACKBOX_INFO，11字节，在记录帧之前发送，序号0，时间戳为最早记录的时刻）：
+//   记录条数 uint16、控制频率 uint16（Hz）、陀螺仪零偏校准值 int16×3（0.001°/s，X/Y/Z）、
+//   姿态滤波器 uint8（Attitude_FilterTypeDef）
+
+#define TELEMETRY_SYNC0             0xA5
+#define TELEMETRY_SYNC1             0x5A
+#define TELEMETRY_TYPE_STATE        0x01
+#define TELEMETRY_TYPE_BLACKBOX     0x02
+#define TELEMETRY_TYPE_BLACKBOX_INFO 0x03
+
+#define TELEMETRY_HEADER_SIZE       10
+#define TELEMETRY_CRC_SIZE          2
+#define TELEMETRY_MAX_PAYLOAD       64
+#define TELEMETRY_MAX_FRAME         (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + TELEMETRY_CRC_SIZE)
+#define TELEMETRY_STATE_PAYLOAD     22
+#define TELEMETRY_STATE_FRAME       (TELEMETRY_HEADER_SIZE + TELEMETRY_STATE_PAYLOAD + TELEMETRY_CRC_SIZE)
+#define TELEMETRY_BLACKBOX_PAYLOAD  36
+#define TELEMETRY_BLACKBOX_FRAME    (TELEMETRY_HEADER_SIZE + TELEMETRY_BLACKBOX_PAYLOAD + TELEMETRY_CRC_SIZE)
+#define TELEMETRY_INFO_PAYLOAD      11
+#define TELEMETRY_INFO_FRAME        (TELEMETRY_HEADER_SIZE + TELEMETRY_INFO_PAYLOAD + TELEMETRY_CRC_SIZE)
+
+// 定点缩放系数（物理量 × 系数 = 帧中的整数）
+#define TELEMETRY_ANGLE_SCALE       100.0f
+#define TELEMETRY_RATE_SCALE        10.0f
+#define TELEMETRY_PID_SCALE         10.0f
+#define TELEMETRY_BIAS_SCALE        1000.0f
+#define TELEMETRY_COV_SCALE         100000.0f
+#define TELEMETRY_VOLTAGE_SCALE     1000.0f
+
+// 一个控制周期的状态快照
+typedef struct {
+    uint32_t timestamp_us;      // 采样时刻（微秒）
+    float angle;                // 滤波后角度（度）
+    float rate;                 // 去偏后的角速度（度/秒）
+    float p_term;               // PID比例项
+    float i_term;               // PID积分项
+    float d_term;               // PID微分项
+    float output;               // PID输出
+    int16_t duty_left;          // 左电机占空比（带方向）
+    int16_t duty_right;         // 右电机占空比（带方向）
+    uint16_t encoder_left;      // 左编码器计数
+    uint16_t encoder_right;     // 右编码器计数
+    float voltage;              // 电池电压（V）
+} Telemetry_SampleTypeDef;
+
+// 黑匣子记录：每个控制周期一条，全部为16位整数（已按上面的系数缩放），RAM中紧凑存放
+typedef struct {
+    uint16_t dt_us;             // 与上一条记录的间隔（微秒）
+    int16_t accel[3];           // MPU6050加速度计原始值 X/Y/Z
+    int16_t gyro[3];            // MPU6050陀螺仪原始值 X/Y/Z
+    int16_t angle;              // 卡尔曼角度（0.01°）
+    int16_t bias;               // 卡尔曼零偏估计（0.001°/s）
+    int16_t p00;                // 协方差P[0][0]（×1e5）
+    int16_t p11;                // 协方差P[1][1]（×1e5）
+    int16_t p_term;             // 直立环P/I/D项（0.1）
+    int16_t i_term;
+    int16_t d_term;
+    int16_t duty_left;          // 左右电机占空比（带方向）
+    int16_t duty_right;
+    int16_t encoder_left;       // 本周期左右编码器增量
+    int16_t encoder_right;
+} Telemetry_RecordTypeDef;
+
+// 黑匣子导出头：回放记录时需要的固件配置
+typedef struct {
+    uint32_t timestamp_us;      // 最早一条记录的时刻
+    uint16_t records;           // 随后的记录条数
+    uint16_t rate_hz;           // 控制频率
+    float gyro_offset[3];       // 陀螺仪零偏校准值（°/s，calibration.c得到）
+    uint8_t filter;             // 记录时使用的姿态滤波器（Attitude_FilterTypeDef）
+} Telemetry_BlackboxInfoTypeDef;
+
+// 函数声明
+int16_t Telemetry_Scale(float value, float scale);
+uint16_t Telemetry_EncodeState(const Telemetry_SampleTypeDef *sample, uint16_t seq, uint8_t *frame);
+uint16_t Telemetry_FrameLength(const uint8_t *frame);
+uint8_t Telemetry_CheckFrame(const uint8_t *frame, uint16_t len);
+uint8_t Telemetry_DecodeState(const uint8_t *frame, uint16_t len, Telemetry_SampleTypeDef *sample, uint16_t *seq);
+uint16_t Telemetry_EncodeRecord(const Telemetry_RecordTypeDef *record, uint16_t seq, uint32_t timestamp_us, uint8_t *frame);
+uint16_t Telemetry_EncodeBlackboxInfo(const Telemetry_BlackboxInfoTypeDef *info, uint8_t *frame);
+uint8_t Telemetry_DecodeBlackboxInfo(const uint8_t *frame, uint16_t len, Telemetry_BlackboxInfoTypeDef *info);
+uint8_t Telemetry_DecodeRecord(const uint8_t *frame, uint16_t len, Telemetry_RecordTypeDef *record,
+                               uint16_t *seq, uint32_t *timestamp_us);
+
+#endif
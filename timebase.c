@@ -0,0 +1,38 @@
+#include "timebase.h"
+
+// 微秒计数累加状态
+static uint32_t micros_last_cycles = 0;
+static uint32_t micros_count = 0;
+static uint32_t micros_remainder = 0;   // 不足1微秒的周期数
+
+// 使能DWT周期计数器
+void Timebase_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    micros_last_cycles = 0;
+    micros_count = 0;
+    micros_remainder = 0;
+}
+
+// 计算距上次时间戳的间隔（秒）并更新时间戳；无符号相减自动处理回绕
+float Timebase_Delta(uint32_t *last_cycles) {
+    uint32_t now = DWT->CYCCNT;
+    uint32_t elapsed = now - *last_cycles;
+    *last_cycles = now;
+    return (float)elapsed / (float)SystemCoreClock;
+}
+
+// 当前时间（微秒，约71分钟回绕）
+// 由周期计数增量累加，两次调用间隔须小于周期计数器回绕时间；非可重入，只在控制中断中调用
+uint32_t Timebase_GetMicros(void) {
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+    uint32_t now = DWT->CYCCNT;
+    uint32_t elapsed = now - micros_last_cycles + micros_remainder;
+
+    micros_last_cycles = now;
+    micros_count += elapsed / cycles_per_us;
+    micros_remainder = elapsed % cycles_per_us;
+    return micros_count;
+}
@@ -0,0 +1,18 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "stm32f1xx_hal.h"
+
+// 高分辨率时基：DWT周期计数器（72MHz，约59.6秒回绕一次）
+
+// 函数声明
+void Timebase_Init(void);
+float Timebase_Delta(uint32_t *last_cycles);
+uint32_t Timebase_GetMicros(void);
+
+// 读取当前周期计数
+static inline uint32_t Timebase_GetCycles(void) {
+    return DWT->CYCCNT;
+}
+
+#endif